@@ -713,6 +713,9 @@ gdk_export int VALisnil(const ValRecord *v);
  *           Hash   *thash;           // linear chained hash table on tail
  *           Imprints *timprints;     // column imprints index on tail
  *           orderidx torderidx;      // order oid index on tail
+ *           Heap   *tzonemap;        // per block min/max of tail
+ *           Heap   *tpacked;         // bit-packed copy of tail
+ *           Heap   *trle;            // runs of equal values in tail
  *  } BAT;
  * @end verbatim
  *
@@ -777,6 +780,9 @@ typedef struct {
 	Hash *hash;		/* hash table */
 	Imprints *imprints;	/* column imprints index */
 	Heap *orderidx;		/* order oid index */
+	Heap *zonemap;		/* per block minimum and maximum */
+	Heap *packed;		/* frame of reference bit-packed copy */
+	Heap *rle;		/* run index: runs of equal values */
 
 	PROPrec *props;		/* list of dynamic properties stored in the bat descriptor */
 } COLrec;
@@ -831,6 +837,9 @@ typedef struct BATiter {
 #define trevsorted	T.revsorted
 #define tident		T.id
 #define torderidx	T.orderidx
+#define tzonemap	T.zonemap
+#define tpacked		T.packed
+#define trle		T.rle
 #define twidth		T.width
 #define tshift		T.shift
 #define tnonil		T.nonil
@@ -886,6 +895,7 @@ gdk_export gdk_return HEAPextend(Heap *h, size_t size, bool mayshare)
 	__attribute__((__warn_unused_result__));
 gdk_export size_t HEAPvmsize(Heap *h);
 gdk_export size_t HEAPmemsize(Heap *h);
+gdk_export void HEAPpoolstatistics(size_t *size, lng *hits, lng *misses);
 
 /*
  * @- Internal HEAP Chunk Management
@@ -1300,6 +1310,7 @@ gdk_export void BAThseqbase(BAT *b, oid o);
 gdk_export void BATtseqbase(BAT *b, oid o);
 gdk_export gdk_return BATsetaccess(BAT *b, int mode);
 gdk_export int BATgetaccess(BAT *b);
+gdk_export void BATsetnode(BAT *b, int node);
 
 
 #define BATdirty(b)	(!(b)->batCopiedtodisk ||			\
@@ -1838,6 +1849,24 @@ gdk_export lng IMPSimprintsize(BAT *b);
 gdk_export gdk_return BATorderidx(BAT *b, bool stable);
 gdk_export gdk_return GDKmergeidx(BAT *b, BAT**a, int n_ar);
 
+/* The zone map structure */
+
+gdk_export gdk_return BATzonemap(BAT *b);
+gdk_export BAT *BATzonemapcands(BAT *b, BAT *s, const char *v, bool prefix, bool caseignore);
+
+/* Predicates on double eliminated string columns */
+
+gdk_export bool BATdictusable(BAT *b, BUN n);
+gdk_export BAT *BATdictselect(BAT *b, BAT *s, bool (*pred)(const char *v, void *arg), void *arg);
+
+/* The packed copy of integer columns */
+
+gdk_export gdk_return BATpack(BAT *b);
+
+/* The run index of integer columns */
+
+gdk_export gdk_return BATrle(BAT *b);
+
 /*
  * @- Multilevel Storage Modes
  *
@@ -1887,6 +1916,8 @@ gdk_export int	GDK_vm_trim;		/* allow trimming */
 
 gdk_export size_t GDKmem_cursize(void);	/* RAM/swapmem that MonetDB has claimed from OS */
 gdk_export size_t GDKvm_cursize(void);	/* current MonetDB VM address space usage */
+gdk_export size_t GDKnuma_local(void);	/* heaps placed on the node of the allocating thread */
+gdk_export size_t GDKnuma_remote(void);	/* heaps placed on another node */
 
 gdk_export void *GDKmalloc(size_t size)
 	__attribute__((__malloc__))
@@ -1905,6 +1936,23 @@ gdk_export str GDKstrdup(const char *s)
 gdk_export str GDKstrndup(const char *s, size_t n)
 	__attribute__((__warn_unused_result__));
 
+/* Short-lived allocations can be taken from the arena of the calling
+ * thread (see GDKarenaset), which is released as a whole.  Memory
+ * from an arena can be passed to GDKfree and GDKrealloc. */
+typedef struct GDKarena GDKarena;
+
+gdk_export GDKarena *GDKarenacreate(void);
+gdk_export void GDKarenareset(GDKarena *a);
+gdk_export void GDKarenadestroy(GDKarena *a);
+gdk_export GDKarena *GDKarenaset(GDKarena *a);
+gdk_export void *GDKarenamalloc(size_t size)
+	__attribute__((__malloc__))
+	__attribute__((__alloc_size__(1)))
+	__attribute__((__warn_unused_result__));
+gdk_export str GDKarenastrndup(const char *s, size_t n)
+	__attribute__((__warn_unused_result__));
+gdk_export void GDKarenastatistics(lng *allocs, lng *mallocs);
+
 #if !defined(NDEBUG) && !defined(STATIC_CODE_ANALYSIS)
 /* In debugging mode, replace GDKmalloc and other functions with a
  * version that optionally prints calling information.
@@ -2729,6 +2777,8 @@ gdk_export gdk_return BATsemijoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl,
 	__attribute__((__warn_unused_result__));
 gdk_export BAT *BATintersect(BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, BUN estimate);
 gdk_export BAT *BATdiff(BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, BUN estimate);
+gdk_export BAT *BATbloom(BAT *b, BAT *s);
+gdk_export BAT *BATbloomprobe(BAT *b, BAT *f);
 gdk_export gdk_return BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, BUN estimate)
 	__attribute__((__warn_unused_result__));
 gdk_export gdk_return BATbandjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, const void *c1, const void *c2, bool li, bool hi, BUN estimate)
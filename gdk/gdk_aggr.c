@@ -935,6 +935,41 @@ BATsum(void *res, int tp, BAT *b, BAT *s, int skip_nils, int abort_on_error, int
 	}
 	if (BATcount(b) == 0)
 		return GDK_SUCCEED;
+	if (cand == NULL &&
+	    (tp == TYPE_lng
+#ifdef HAVE_HGE
+	     || tp == TYPE_hge
+#endif
+		    )) {
+		/* if there is a run index, sum value times run
+		 * length, else if there is a packed copy, sum the
+		 * (smaller) codes */
+		lng sum;
+		BUN nonils;
+
+		if (RLEsum(b, start, end, &sum, &nils, &nonils) ||
+		    PACKsum(b, start, end, &sum, &nils, &nonils)) {
+			ALGODEBUG fprintf(stderr, "#BATsum(b=" ALGOBATFMT "): "
+					  "using run index or packed copy\n",
+					  ALGOBATPAR(b));
+			if (nils > 0 && !skip_nils) {
+#ifdef HAVE_HGE
+				if (tp == TYPE_hge)
+					* (hge *) res = hge_nil;
+				else
+#endif
+					* (lng *) res = lng_nil;
+			} else if (nonils > 0) {
+#ifdef HAVE_HGE
+				if (tp == TYPE_hge)
+					* (hge *) res = sum;
+				else
+#endif
+					* (lng *) res = sum;
+			}
+			return GDK_SUCCEED;
+		}
+	}
 	nils = dosum(Tloc(b, 0), b->tnonil, b->hseqbase, start, end,
 		     res, true, b->ttype, tp, cand, candend, &min, min, max,
 		     skip_nils, abort_on_error, nil_if_empty, "BATsum");
@@ -2683,135 +2718,892 @@ BATmax(BAT *b, void *aggr)
 
 
 /* ---------------------------------------------------------------------- */
-/* quantiles/median */
+/* approximate count distinct */
+
+/* The number of distinct values is estimated using HyperLogLog
+ * (Flajolet et al., 2007).  Each value is hashed to 64 bits, the
+ * first p bits of which select one of 2^p registers; a register
+ * keeps the largest position of the first 1 bit in the remaining bits
+ * of the hashes that selected it.  The relative standard error of the
+ * estimate is 1.04/sqrt(2^p), and the memory needed is one byte per
+ * register, independent of the number of values.  Sketches of parts
+ * of a column can be merged into the sketch of the whole column by
+ * taking the maximum of each register.
+ *
+ * Values are hashed by value, not by representation: all integer
+ * types hash the same for the same value, as do flt and dbl, so that
+ * sketches of columns of different types can be merged. */
 
-BAT *
-BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
-	       int skip_nils, int abort_on_error)
+/* number of leading zero bits of a non-zero value */
+#ifdef __GNUC__
+#define clz64(x)	__builtin_clzll(x)
+#else
+static inline int
+clz64(uint64_t x)
 {
-	return BATgroupquantile(b,g,e,s,tp,0.5,skip_nils,abort_on_error);
+	int n = 0;
+
+	while ((x & ((uint64_t) 1 << 63)) == 0) {
+		x <<= 1;
+		n++;
+	}
+	return n;
 }
+#endif
 
-#if SIZEOF_OID == SIZEOF_INT
-#define binsearch_oid(indir, offset, vals, lo, hi, v, ordering, last) binsearch_int(indir, offset, (const int *) vals, lo, hi, (int) (v), ordering, last)
+/* the finalizer of splitmix64: every bit of x affects every bit of
+ * the result */
+static inline uint64_t
+hll_mix(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= UINT64_C(0xbf58476d1ce4e5b9);
+	x ^= x >> 27;
+	x *= UINT64_C(0x94d049bb133111eb);
+	x ^= x >> 31;
+	return x;
+}
+
+/* FNV-1a of len bytes, mixed */
+static inline uint64_t
+hll_bytes(const void *v, size_t len)
+{
+	const unsigned char *s = v;
+	uint64_t h = UINT64_C(0xcbf29ce484222325);
+
+	while (len-- > 0) {
+		h ^= *s++;
+		h *= UINT64_C(0x100000001b3);
+	}
+	return hll_mix(h);
+}
+
+static inline uint64_t
+hll_dbl(dbl v)
+{
+	uint64_t h;
+
+	if (v == 0)
+		v = 0;		/* -0 == 0 */
+	memcpy(&h, &v, sizeof(h));
+	return hll_mix(h);
+}
+
+#ifdef HAVE_HGE
+static inline uint64_t
+hll_hge(hge v)
+{
+	if (v >= GDK_lng_min && v <= GDK_lng_max)
+		return hll_mix((uint64_t) (lng) v);
+	return hll_mix((uint64_t) v ^ hll_mix((uint64_t) (v >> 64)));
+}
 #endif
-#if SIZEOF_OID == SIZEOF_LNG
-#define binsearch_oid(indir, offset, vals, lo, hi, v, ordering, last) binsearch_lng(indir, offset, (const lng *) vals, lo, hi, (lng) (v), ordering, last)
+
+#define hll_int(v)	hll_mix((uint64_t) (lng) (v))
+
+static inline void
+hll_add(uint8_t *restrict regs, int p, uint64_t h)
+{
+	/* the extra bit bounds the rank to 64 - p + 1 */
+	uint8_t k = (uint8_t) (clz64((h << p) | ((uint64_t) 1 << (p - 1))) + 1);
+	uint8_t *r = &regs[h >> (64 - p)];
+
+	if (*r < k)
+		*r = k;
+}
+
+#define HLL_UPDATE(TYPE, HASH)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		for (;;) {						\
+			if (cand) {					\
+				if (cand == candend)			\
+					break;				\
+				i = *cand++ - b->hseqbase;		\
+			} else {					\
+				if (start == end)			\
+					break;				\
+				i = start++;				\
+			}						\
+			gid = gids ? gids[i] : g ? gbase + i : min;	\
+			if (gid < min || gid > max ||			\
+			    is_##TYPE##_nil(vals[i]))			\
+				continue;				\
+			hll_add(regs + ((gid - min) << p), p,		\
+				HASH(vals[i]));				\
+		}							\
+	} while (0)
+
+/* add the values of b (at the positions given by start/end/cand) to
+ * the sketches with 2^p registers of their groups in g (or to a
+ * single sketch if g is NULL); nils are skipped */
+static void
+hll_update(uint8_t *restrict regs, int p, BAT *b, BAT *g, oid min,
+	   oid max, BUN start, BUN end, const oid *cand,
+	   const oid *candend)
+{
+	const oid *gids = NULL;
+	oid gbase = 0, gid;
+	BUN i;
+
+	if (g != NULL) {
+		if (BATtdense(g))
+			gbase = g->tseqbase;
+		else
+			gids = (const oid *) Tloc(g, 0);
+	}
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_void:
+		/* dense oids are all distinct */
+		if (is_oid_nil(b->tseqbase))
+			break;
+		for (;;) {
+			if (cand) {
+				if (cand == candend)
+					break;
+				i = *cand++ - b->hseqbase;
+			} else {
+				if (start == end)
+					break;
+				i = start++;
+			}
+			gid = gids ? gids[i] : g ? gbase + i : min;
+			if (gid < min || gid > max)
+				continue;
+			hll_add(regs + ((gid - min) << p), p,
+				hll_int(b->tseqbase + i));
+		}
+		break;
+	case TYPE_bte:
+		HLL_UPDATE(bte, hll_int);
+		break;
+	case TYPE_sht:
+		HLL_UPDATE(sht, hll_int);
+		break;
+	case TYPE_int:
+		HLL_UPDATE(int, hll_int);
+		break;
+	case TYPE_lng:
+		HLL_UPDATE(lng, hll_int);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		HLL_UPDATE(hge, hll_hge);
+		break;
 #endif
+	case TYPE_flt:
+		HLL_UPDATE(flt, hll_dbl);
+		break;
+	case TYPE_dbl:
+		HLL_UPDATE(dbl, hll_dbl);
+		break;
+	default: {
+		BATiter bi = bat_iterator(b);
+		int tp = b->ttype;
+		const void *nil = ATOMnilptr(tp);
+		int (*atomcmp)(const void *, const void *) = ATOMcompare(tp);
+		bool isstr = ATOMstorage(tp) == TYPE_str;
+		const void *v;
+
+		for (;;) {
+			if (cand) {
+				if (cand == candend)
+					break;
+				i = *cand++ - b->hseqbase;
+			} else {
+				if (start == end)
+					break;
+				i = start++;
+			}
+			gid = gids ? gids[i] : g ? gbase + i : min;
+			if (gid < min || gid > max)
+				continue;
+			v = BUNtail(bi, i);
+			if ((*atomcmp)(v, nil) == 0)
+				continue;
+			hll_add(regs + ((gid - min) << p), p,
+				hll_bytes(v, isstr ? strlen(v) :
+					  ATOMvarsized(tp) ? ATOMlen(tp, v) :
+					  (size_t) ATOMsize(tp)));
+		}
+		break;
+	}
+	}
+}
 
-BAT *
-BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile,
-		 int skip_nils, int abort_on_error)
+/* Estimate the number of distinct values from a sketch with 2^p
+ * registers. */
+lng
+HLLcount(const uint8_t *regs, int p)
+{
+	BUN m = (BUN) 1 << p, j, zeros = 0;
+	double sum = 0, alpha, est;
+
+	for (j = 0; j < m; j++) {
+		sum += ldexp(1.0, -(int) regs[j]);
+		zeros += regs[j] == 0;
+	}
+	switch (m) {
+	case 16:
+		alpha = 0.673;
+		break;
+	case 32:
+		alpha = 0.697;
+		break;
+	case 64:
+		alpha = 0.709;
+		break;
+	default:
+		alpha = 0.7213 / (1 + 1.079 / m);
+		break;
+	}
+	est = alpha * m * m / sum;
+	/* with a 64 bit hash, only small cardinalities need to be
+	 * corrected, for which linear counting is more accurate */
+	if (est <= 2.5 * m && zeros > 0)
+		est = m * log((double) m / zeros);
+	return (lng) (est + 0.5);
+}
+
+/* Compute the HyperLogLog sketches (with HLL_REGISTERS registers) of
+ * the groups of b; return an array of *ngrpp sketches of which the
+ * first belongs to group *minp, or NULL on failure. */
+uint8_t *
+BATgrouphll(BAT *b, BAT *g, BAT *e, BAT *s, BUN *ngrpp, oid *minp)
 {
-	bool freeb = false, freeg = false;
 	oid min, max;
-	BUN ngrp;
-	BUN nils = 0;
-	BAT *bn = NULL;
-	BUN start, end;
+	BUN ngrp, start, end;
 	const oid *cand = NULL, *candend = NULL;
-	BAT *t1, *t2;
-	BATiter bi;
-	const void *v;
-	const void *nil = ATOMnilptr(tp);
-	int (*atomcmp)(const void *, const void *) = ATOMcompare(tp);
 	const char *err;
-	(void) abort_on_error;
+	uint8_t *regs;
 
 	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
 				    &cand, &candend)) != NULL) {
-		GDKerror("BATgroupquantile: %s\n", err);
+		GDKerror("BATgrouphll: %s\n", err);
 		return NULL;
 	}
-	assert(tp == b->ttype);
-	if (!ATOMlinear(tp)) {
-		GDKerror("BATgroupquantile: cannot determine quantile on "
-			 "non-linear type %s\n", ATOMname(tp));
+	/* always allocate at least one sketch */
+	regs = GDKzalloc((ngrp ? ngrp : 1) * HLL_REGISTERS);
+	if (regs == NULL)
 		return NULL;
-	}
-	if (quantile < 0 || quantile > 1) {
-		GDKerror("BATgroupquantile: cannot determine quantile for "
-			 "p=%f (p has to be in [0,1])\n", quantile);
+	if (BATcount(b) > 0 && ngrp > 0)
+		hll_update(regs, HLL_PRECISION, b, g, min, max, start, end,
+			   cand, candend);
+	*ngrpp = ngrp;
+	*minp = min;
+	return regs;
+}
+
+BAT *
+BATgroupapprox_count_distinct(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+			      int skip_nils, int abort_on_error)
+{
+	oid min, max;
+	BUN ngrp, start, end, cnt, i;
+	const oid *cand = NULL, *candend = NULL;
+	const char *err;
+	uint8_t *regs;
+	lng *restrict cnts;
+	int p;
+	BAT *bn;
+	lng t0 = 0;
+
+	assert(tp == TYPE_lng);
+	(void) tp;		/* compatibility (with other BATgroup* */
+	(void) skip_nils;	/* functions) arguments; nils are never */
+	(void) abort_on_error;	/* counted */
+
+	ALGODEBUG t0 = GDKusec();
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		GDKerror("BATgroupapprox_count_distinct: %s\n", err);
 		return NULL;
 	}
 
 	if (BATcount(b) == 0 || ngrp == 0) {
-		/* trivial: no values, thus also no quantiles,
-		 * so return bat aligned with e with nil in the tail */
-		return BATconstant(ngrp == 0 ? 0 : min, tp, nil, ngrp, TRANSIENT);
+		/* trivial: no values, so return bat aligned with g
+		 * with zero in the tail */
+		lng zero = 0;
+		return BATconstant(ngrp == 0 ? 0 : min, TYPE_lng, &zero, ngrp, TRANSIENT);
 	}
 
-	if (s) {
-		/* there is a candidate list, replace b (and g, if
-		 * given) with just the values we're interested in */
-		b = BATproject(s, b);
-		if (b == NULL)
-			return NULL;
-		freeb = true;
-		if (g) {
-			g = BATproject(s, g);
-			if (g == NULL)
-				goto bunins_failed;
-			freeg = true;
-		}
+	/* with many groups, use fewer registers per group, but not
+	 * so few that the registers together are fewer than those of
+	 * a single full sketch or than sixteen per value */
+	cnt = cand ? (BUN) (candend - cand) : end - start;
+	for (p = HLL_PRECISION;
+	     p > 4 && ngrp > HLL_REGISTERS >> p && ngrp > (16 * cnt) >> p;
+	     p--)
+		;
+
+	bn = COLnew(min, TYPE_lng, ngrp, TRANSIENT);
+	regs = GDKzalloc(ngrp << p);
+	if (bn == NULL || regs == NULL) {
+		BBPreclaim(bn);
+		GDKfree(regs);
+		return NULL;
 	}
+	hll_update(regs, p, b, g, min, max, start, end, cand, candend);
+	cnts = (lng *) Tloc(bn, 0);
+	for (i = 0; i < ngrp; i++)
+		cnts[i] = HLLcount(regs + (i << p), p);
+	GDKfree(regs);
 
-	/* we want to sort b so that we can figure out the quantile, but
-	 * if g is given, sort g and subsort b so that we can get the
-	 * quantile for each group */
-	if (g) {
-		const oid *restrict grps;
-		oid prev;
-		BUN p, q, r;
+	BATsetcount(bn, ngrp);
+	bn->tkey = ngrp <= 1;
+	bn->tsorted = ngrp <= 1;
+	bn->trevsorted = ngrp <= 1;
+	bn->tnil = false;
+	bn->tnonil = true;
+	ALGODEBUG fprintf(stderr, "#BATgroupapprox_count_distinct(b=" ALGOBATFMT
+			  ",g=" ALGOOPTBATFMT ",s=" ALGOOPTBATFMT
+			  ") -> " ALGOBATFMT " (%d registers/group, " LLFMT "usec)\n",
+			  ALGOBATPAR(b), ALGOOPTBATPAR(g), ALGOOPTBATPAR(s),
+			  ALGOBATPAR(bn), 1 << p, GDKusec() - t0);
+	return bn;
+}
 
-		if (BATtdense(g)) {
-			/* singleton groups, so calculating quantile is
-			 * easy */
-			bn = COLcopy(b, tp, false, TRANSIENT);
-			BAThseqbase(bn, g->tseqbase); /* deals with NULL */
-			if (freeb)
-				BBPunfix(b->batCacheid);
-			if (freeg)
-				BBPunfix(g->batCacheid);
-			return bn;
-		}
-		if (BATsort(&t1, &t2, NULL, g, NULL, NULL, false, false) != GDK_SUCCEED)
-			goto bunins_failed;
-		if (freeg)
-			BBPunfix(g->batCacheid);
-		g = t1;
-		freeg = true;
+/* ---------------------------------------------------------------------- */
+/* quantiles/median */
 
-		if (BATsort(&t1, NULL, NULL, b, t2, g, false, false) != GDK_SUCCEED) {
-			BBPunfix(t2->batCacheid);
-			goto bunins_failed;
-		}
-		if (freeb)
-			BBPunfix(b->batCacheid);
-		b = t1;
-		freeb = true;
-		BBPunfix(t2->batCacheid);
+BAT *
+BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+	       int skip_nils, int abort_on_error)
+{
+	return BATgroupquantile(b,g,e,s,tp,0.5,skip_nils,abort_on_error);
+}
 
-		bn = COLnew(min, tp, ngrp, TRANSIENT);
-		if (bn == NULL)
-			goto bunins_failed;
+/* Instead of sorting, quantiles of the fixed-size numeric types are
+ * determined by selection.  The non-nil values are copied into a
+ * scratch array (for grouped quantiles, partitioned by group) in
+ * which the value of the wanted rank is put into place using
+ * introselect: quickselect with a median-of-three pivot, which sorts
+ * the remaining part if the partitioning doesn't converge.  For
+ * several ranks in the same array, the array is first partitioned
+ * around the middle one, so that the others are selected in smaller
+ * and smaller parts of the array. */
+
+/* Put the value of rank k (counting from 0) of the values v[lo..hi)
+ * in position k, with no larger values before it and no smaller
+ * values after it. */
+#define select_loop(TYPE)						\
+static void								\
+select_##TYPE(TYPE *restrict v, BUN lo, BUN hi, BUN k)			\
+{									\
+	BUN i, j, mid;							\
+	TYPE p, t;							\
+	int depth = 0;							\
+									\
+	assert(lo <= k && k < hi);					\
+	for (i = hi - lo; i > 0; i >>= 1)				\
+		depth += 2;						\
+	while (hi - lo > 16) {						\
+		if (--depth < 0) {					\
+			GDKqsort(v + lo, NULL, NULL, hi - lo,		\
+				 sizeof(TYPE), 0, TYPE_##TYPE);		\
+			return;						\
+		}							\
+		mid = lo + (hi - lo) / 2;				\
+		if (v[mid] < v[lo]) {					\
+			t = v[mid]; v[mid] = v[lo]; v[lo] = t;		\
+		}							\
+		if (v[hi - 1] < v[lo]) {				\
+			t = v[hi - 1]; v[hi - 1] = v[lo]; v[lo] = t;	\
+		}							\
+		if (v[hi - 1] < v[mid]) {				\
+			t = v[hi - 1]; v[hi - 1] = v[mid]; v[mid] = t;	\
+		}							\
+		p = v[mid];						\
+		/* Hoare partition: afterwards, v[lo..j] <= p	*/	\
+		/* and v[j+1..hi) >= p */				\
+		i = lo - 1;						\
+		j = hi;							\
+		for (;;) {						\
+			do						\
+				i++;					\
+			while (v[i] < p);				\
+			do						\
+				j--;					\
+			while (p < v[j]);				\
+			if (i >= j)					\
+				break;					\
+			t = v[i]; v[i] = v[j]; v[j] = t;		\
+		}							\
+		if (k <= j)						\
+			hi = j + 1;					\
+		else							\
+			lo = j + 1;					\
+	}								\
+	/* insertion sort of the small remainder */			\
+	for (i = lo + 1; i < hi; i++) {					\
+		t = v[i];						\
+		for (j = i; j > lo && t < v[j - 1]; j--)		\
+			v[j] = v[j - 1];				\
+		v[j] = t;						\
+	}								\
+}
 
-		bi = bat_iterator(b);
+select_loop(bte)
+select_loop(sht)
+select_loop(int)
+select_loop(lng)
+#ifdef HAVE_HGE
+select_loop(hge)
+#endif
+select_loop(flt)
+select_loop(dbl)
 
-		grps = (const oid *) Tloc(g, 0);
-		 /* for each group (r and p are the beginning and end
-		  * of the current group, respectively) */
-		for (r = 0, q = BATcount(g); r < q; r = p) {
-			BUN qindex;
-			prev = grps[r];
-			/* search for end of current group (grps is
-			 * sorted so we can use binary search) */
-			p = binsearch_oid(NULL, 0, grps, r, q - 1, prev, 1, 1);
-			if (skip_nils && !b->tnonil) {
-				/* within group, locate start of non-nils */
-				r = binsearch(NULL, 0, tp, Tloc(b, 0),
-					      b->tvheap ? b->tvheap->base : NULL,
-					      b->twidth, r, p, nil,
+/* Put the values of the (sorted) ranks ks[0..nk) of the values
+ * v[lo..hi) of type tp in place. */
+static void
+quantile_select(void *v, int tp, BUN lo, BUN hi, const BUN *ks, BUN nk)
+{
+	BUN m, l, r;
+
+	while (nk > 0) {
+		/* select the middle rank, then the ones before it
+		 * in the part before it, and the ones after it in
+		 * the part after it */
+		m = nk / 2;
+		switch (ATOMbasetype(tp)) {
+		case TYPE_bte:
+			select_bte(v, lo, hi, ks[m]);
+			break;
+		case TYPE_sht:
+			select_sht(v, lo, hi, ks[m]);
+			break;
+		case TYPE_int:
+			select_int(v, lo, hi, ks[m]);
+			break;
+		case TYPE_lng:
+			select_lng(v, lo, hi, ks[m]);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			select_hge(v, lo, hi, ks[m]);
+			break;
+#endif
+		case TYPE_flt:
+			select_flt(v, lo, hi, ks[m]);
+			break;
+		case TYPE_dbl:
+			select_dbl(v, lo, hi, ks[m]);
+			break;
+		default:
+			assert(0);
+		}
+		for (l = m; l > 0 && ks[l - 1] == ks[m]; l--)
+			;
+		for (r = m + 1; r < nk && ks[r] == ks[m]; r++)
+			;
+		quantile_select(v, tp, lo, ks[m], ks, l);
+		lo = ks[m] + 1;
+		ks += r;
+		nk -= r;
+	}
+}
+
+/* whether the quantiles of type tp can be determined by selection */
+static bool
+quantile_selectable(int tp)
+{
+	switch (ATOMbasetype(tp)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		return ATOMcompare(tp) == ATOMcompare(ATOMbasetype(tp)) &&
+			ATOMnilptr(tp) == ATOMnilptr(ATOMbasetype(tp));
+	default:
+		return false;
+	}
+}
+
+/* The rank of quantile q among cnt values of which the first nils are
+ * nil, or BUN_NONE if it is a nil.  The rounding is the same as when
+ * the quantile is looked up in the sorted values: round (cnt-1)*q
+ * *down* to the nearest integer (i.e., 1.49 and 1.5 are rounded to 1,
+ * 1.51 is rounded to 2). */
+static BUN
+quantile_rank(BUN cnt, BUN nils, double q)
+{
+	BUN k;
+
+	if (cnt == nils)
+		return BUN_NONE;
+	k = cnt - (BUN) (cnt + 0.5 - (cnt - 1) * q);
+	return k < nils ? BUN_NONE : k - nils;
+}
+
+/* copy the non-nil values of b (at the positions given by
+ * start/end/cand) to vals, or if grps is set, scatter them into the
+ * partitions of their groups (pos[grp] is the next position of group
+ * grp, counted from min); the number of nils (of each group) is
+ * counted in nils */
+#define quantile_copy_loop(TYPE)						\
+	do {								\
+		const TYPE *restrict src = (const TYPE *) Tloc(b, 0);	\
+		TYPE *restrict dst = (TYPE *) vals;			\
+		for (;;) {						\
+			if (cand) {					\
+				if (cand == candend)			\
+					break;				\
+				i = *cand++ - b->hseqbase;		\
+			} else {					\
+				if (start == end)			\
+					break;				\
+				i = start++;				\
+			}						\
+			if (grps) {					\
+				gid = grps[i] - min;			\
+				if (gid >= ngrp)			\
+					continue;			\
+			}						\
+			if (is_##TYPE##_nil(src[i]))			\
+				nils[gid]++;				\
+			else						\
+				dst[pos[gid]++] = src[i];		\
+		}							\
+	} while (0)
+
+static void
+quantile_copy(BAT *b, void *vals, BUN start, BUN end, const oid *cand,
+	      const oid *candend, const oid *grps, oid min, BUN ngrp,
+	      BUN *pos, BUN *nils)
+{
+	BUN i, gid = 0;
+
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		quantile_copy_loop(bte);
+		break;
+	case TYPE_sht:
+		quantile_copy_loop(sht);
+		break;
+	case TYPE_int:
+		quantile_copy_loop(int);
+		break;
+	case TYPE_lng:
+		quantile_copy_loop(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		quantile_copy_loop(hge);
+		break;
+#endif
+	case TYPE_flt:
+		quantile_copy_loop(flt);
+		break;
+	case TYPE_dbl:
+		quantile_copy_loop(dbl);
+		break;
+	default:
+		assert(0);
+	}
+}
+
+/* Determine the quantiles qs[0..nq) of the values of b (at the
+ * positions given by start/end/cand) by selection and append them to
+ * bn; return the number of nils appended, or BUN_NONE on failure. */
+static BUN
+quantile_values(BAT *b, BAT *bn, BUN start, BUN end, const oid *cand,
+		const oid *candend, const double *qs, BUN nq, bool skip_nils)
+{
+	BUN cnt = cand ? (BUN) (candend - cand) : end - start;
+	BUN pos = 0, nils = 0, i, j, l, *ks, *sorted, nnils = 0;
+	int tp = b->ttype;
+	size_t w = ATOMsize(tp);
+	char *vals;
+
+	vals = GDKmalloc((cnt ? cnt : 1) * w);
+	ks = GDKmalloc(nq * sizeof(BUN));
+	sorted = GDKmalloc(nq * sizeof(BUN));
+	if (vals == NULL || ks == NULL || sorted == NULL) {
+		GDKfree(vals);
+		GDKfree(ks);
+		GDKfree(sorted);
+		return BUN_NONE;
+	}
+	quantile_copy(b, vals, start, end, cand, candend, NULL, 0, 1,
+		      &pos, &nils);
+	/* the ranks to select must be in ascending order; there are
+	 * few of them, so insertion sort will do */
+	for (i = j = 0; i < nq; i++) {
+		ks[i] = skip_nils ? quantile_rank(pos, 0, qs[i]) : quantile_rank(cnt, nils, qs[i]);
+		if (ks[i] == BUN_NONE)
+			continue;
+		for (l = j++; l > 0 && sorted[l - 1] > ks[i]; l--)
+			sorted[l] = sorted[l - 1];
+		sorted[l] = ks[i];
+	}
+	quantile_select(vals, tp, 0, pos, sorted, j);
+	for (i = 0; i < nq; i++) {
+		const void *v;
+
+		if (ks[i] == BUN_NONE) {
+			v = ATOMnilptr(tp);
+			nnils++;
+		} else {
+			v = vals + ks[i] * w;
+		}
+		if (BUNappend(bn, v, false) != GDK_SUCCEED) {
+			nnils = BUN_NONE;
+			break;
+		}
+	}
+	GDKfree(vals);
+	GDKfree(ks);
+	GDKfree(sorted);
+	return nnils;
+}
+
+/* Determine the quantile of each group of the values of b (at the
+ * positions given by start/end/cand) by selection; the groups are
+ * given by g (aligned with b) and are in the range [min,min+ngrp).
+ * The number of nils in the result is returned in *nilsp. */
+static BAT *
+quantile_groups(BAT *b, BAT *g, oid min, BUN ngrp, BUN start, BUN end,
+		const oid *cand, const oid *candend, double quantile,
+		bool skip_nils, BUN *nilsp)
+{
+	BUN cnt = cand ? (BUN) (candend - cand) : end - start;
+	BUN *pos, *nils, grp, i, lo, hi, k, nnils = 0;
+	int tp = b->ttype;
+	size_t w = ATOMsize(tp);
+	const oid *grps = (const oid *) Tloc(g, 0);
+	const oid *c;
+	char *vals;
+	BAT *bn;
+
+	bn = COLnew(min, tp, ngrp, TRANSIENT);
+	vals = GDKmalloc((cnt ? cnt : 1) * w);
+	pos = GDKzalloc(ngrp * sizeof(BUN));
+	nils = GDKzalloc(ngrp * sizeof(BUN));
+	if (bn == NULL || vals == NULL || pos == NULL || nils == NULL) {
+		BBPreclaim(bn);
+		GDKfree(vals);
+		GDKfree(pos);
+		GDKfree(nils);
+		return NULL;
+	}
+	/* count the values of each group and turn the counts into
+	 * the start positions of the partitions of the groups */
+	for (c = cand, i = start; c ? c < candend : i < end; i++) {
+		grp = grps[c ? *c++ - b->hseqbase : i] - min;
+		if (grp < ngrp)
+			pos[grp]++;
+	}
+	for (grp = 0, lo = 0; grp < ngrp; grp++) {
+		hi = lo + pos[grp];
+		pos[grp] = lo;
+		lo = hi;
+	}
+	quantile_copy(b, vals, start, end, cand, candend, grps, min, ngrp,
+		      pos, nils);
+	/* the non-nil values of group grp are now in [lo,pos[grp]),
+	 * where lo is the end of the previous partition, which also
+	 * had room for the nils of the previous group */
+	for (grp = 0, lo = 0; grp < ngrp; grp++) {
+		hi = pos[grp];
+		if (skip_nils)
+			k = quantile_rank(hi - lo, 0, quantile);
+		else
+			k = quantile_rank(hi - lo + nils[grp], nils[grp], quantile);
+		if (k == BUN_NONE) {
+			memcpy(Tloc(bn, grp), ATOMnilptr(tp), w);
+			nnils++;
+		} else {
+			k += lo;
+			quantile_select(vals, tp, lo, hi, &k, 1);
+			memcpy(Tloc(bn, grp), vals + k * w, w);
+		}
+		lo = hi + nils[grp];
+	}
+	BATsetcount(bn, ngrp);
+	bn->theap.dirty = true;
+	GDKfree(vals);
+	GDKfree(pos);
+	GDKfree(nils);
+	*nilsp = nnils;
+	return bn;
+}
+
+/* return the order index of b, or of its parent if b is a view that
+ * covers all of its parent, or NULL if there is none */
+static const oid *
+quantile_orderidx(BAT *b)
+{
+	BAT *pb;
+
+	if (BATcheckorderidx(b))
+		return (const oid *) b->torderidx->base + ORDERIDXOFF;
+	if (VIEWtparent(b) &&
+	    (pb = BBPdescriptor(VIEWtparent(b))) != NULL &&
+	    pb->theap.base == b->theap.base &&
+	    BATcount(pb) == BATcount(b) &&
+	    pb->hseqbase == b->hseqbase &&
+	    BATcheckorderidx(pb))
+		return (const oid *) pb->torderidx->base + ORDERIDXOFF;
+	return NULL;
+}
+
+#if SIZEOF_OID == SIZEOF_INT
+#define binsearch_oid(indir, offset, vals, lo, hi, v, ordering, last) binsearch_int(indir, offset, (const int *) vals, lo, hi, (int) (v), ordering, last)
+#endif
+#if SIZEOF_OID == SIZEOF_LNG
+#define binsearch_oid(indir, offset, vals, lo, hi, v, ordering, last) binsearch_lng(indir, offset, (const lng *) vals, lo, hi, (lng) (v), ordering, last)
+#endif
+
+BAT *
+BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile,
+		 int skip_nils, int abort_on_error)
+{
+	bool freeb = false, freeg = false;
+	oid min, max;
+	BUN ngrp;
+	BUN nils = 0;
+	BAT *bn = NULL;
+	BUN start, end;
+	const oid *cand = NULL, *candend = NULL;
+	BAT *t1, *t2;
+	BATiter bi;
+	const void *v;
+	const void *nil = ATOMnilptr(tp);
+	int (*atomcmp)(const void *, const void *) = ATOMcompare(tp);
+	const char *err;
+	(void) abort_on_error;
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		GDKerror("BATgroupquantile: %s\n", err);
+		return NULL;
+	}
+	assert(tp == b->ttype);
+	if (!ATOMlinear(tp)) {
+		GDKerror("BATgroupquantile: cannot determine quantile on "
+			 "non-linear type %s\n", ATOMname(tp));
+		return NULL;
+	}
+	if (quantile < 0 || quantile > 1) {
+		GDKerror("BATgroupquantile: cannot determine quantile for "
+			 "p=%f (p has to be in [0,1])\n", quantile);
+		return NULL;
+	}
+
+	if (BATcount(b) == 0 || ngrp == 0) {
+		/* trivial: no values, thus also no quantiles,
+		 * so return bat aligned with e with nil in the tail */
+		return BATconstant(ngrp == 0 ? 0 : min, tp, nil, ngrp, TRANSIENT);
+	}
+
+	if (quantile_selectable(tp) &&
+	    (g ? g->ttype == TYPE_oid && !BATtdense(g)
+	     : s != NULL || quantile_orderidx(b) == NULL)) {
+		/* select the quantiles instead of sorting, this
+		 * doesn't need the candidates to be projected
+		 * first */
+		ALGODEBUG fprintf(stderr, "#BATgroupquantile(b=" ALGOBATFMT
+				  ",g=" ALGOOPTBATFMT ",s=" ALGOOPTBATFMT
+				  "): select\n",
+				  ALGOBATPAR(b), ALGOOPTBATPAR(g),
+				  ALGOOPTBATPAR(s));
+		if (g) {
+			bn = quantile_groups(b, g, min, ngrp, start, end,
+					     cand, candend, quantile,
+					     skip_nils, &nils);
+			if (bn == NULL)
+				return NULL;
+		} else {
+			bn = COLnew(0, tp, 1, TRANSIENT);
+			if (bn == NULL)
+				return NULL;
+			nils = quantile_values(b, bn, start, end, cand, candend,
+					       &quantile, 1, skip_nils);
+			if (nils == BUN_NONE) {
+				BBPreclaim(bn);
+				return NULL;
+			}
+		}
+		goto doneselect;
+	}
+
+	if (s) {
+		/* there is a candidate list, replace b (and g, if
+		 * given) with just the values we're interested in */
+		b = BATproject(s, b);
+		if (b == NULL)
+			return NULL;
+		freeb = true;
+		if (g) {
+			g = BATproject(s, g);
+			if (g == NULL)
+				goto bunins_failed;
+			freeg = true;
+		}
+	}
+
+	/* we want to sort b so that we can figure out the quantile, but
+	 * if g is given, sort g and subsort b so that we can get the
+	 * quantile for each group */
+	if (g) {
+		const oid *restrict grps;
+		oid prev;
+		BUN p, q, r;
+
+		if (BATtdense(g)) {
+			/* singleton groups, so calculating quantile is
+			 * easy */
+			bn = COLcopy(b, tp, false, TRANSIENT);
+			BAThseqbase(bn, g->tseqbase); /* deals with NULL */
+			if (freeb)
+				BBPunfix(b->batCacheid);
+			if (freeg)
+				BBPunfix(g->batCacheid);
+			return bn;
+		}
+		if (BATsort(&t1, &t2, NULL, g, NULL, NULL, false, false) != GDK_SUCCEED)
+			goto bunins_failed;
+		if (freeg)
+			BBPunfix(g->batCacheid);
+		g = t1;
+		freeg = true;
+
+		if (BATsort(&t1, NULL, NULL, b, t2, g, false, false) != GDK_SUCCEED) {
+			BBPunfix(t2->batCacheid);
+			goto bunins_failed;
+		}
+		if (freeb)
+			BBPunfix(b->batCacheid);
+		b = t1;
+		freeb = true;
+		BBPunfix(t2->batCacheid);
+
+		bn = COLnew(min, tp, ngrp, TRANSIENT);
+		if (bn == NULL)
+			goto bunins_failed;
+
+		bi = bat_iterator(b);
+
+		grps = (const oid *) Tloc(g, 0);
+		 /* for each group (r and p are the beginning and end
+		  * of the current group, respectively) */
+		for (r = 0, q = BATcount(g); r < q; r = p) {
+			BUN qindex;
+			prev = grps[r];
+			/* search for end of current group (grps is
+			 * sorted so we can use binary search) */
+			p = binsearch_oid(NULL, 0, grps, r, q - 1, prev, 1, 1);
+			if (skip_nils && !b->tnonil) {
+				/* within group, locate start of non-nils */
+				r = binsearch(NULL, 0, tp, Tloc(b, 0),
+					      b->tvheap ? b->tvheap->base : NULL,
+					      b->twidth, r, p, nil,
 					      1, 1);
 			}
 			if (r == p) {
@@ -2838,7 +3630,6 @@ BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile,
 		BBPunfix(g->batCacheid);
 	} else {
 		BUN index, r, p = BATcount(b);
-		BAT *pb = NULL;
 		const oid *ords;
 
 		bn = COLnew(0, tp, 1, TRANSIENT);
@@ -2847,15 +3638,7 @@ BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile,
 
 		t1 = NULL;
 
-		if (BATcheckorderidx(b) ||
-		    (VIEWtparent(b) &&
-		     (pb = BBPdescriptor(VIEWtparent(b))) != NULL &&
-		     pb->theap.base == b->theap.base &&
-		     BATcount(pb) == BATcount(b) &&
-		     pb->hseqbase == b->hseqbase &&
-		     BATcheckorderidx(pb))) {
-			ords = (const oid *) (pb ? pb->torderidx->base : b->torderidx->base) + ORDERIDXOFF;
-		} else {
+		if ((ords = quantile_orderidx(b)) == NULL) {
 			if (BATsort(NULL, &t1, NULL, b, NULL, g, false, false) != GDK_SUCCEED)
 				goto bunins_failed;
 			if (BATtdense(t1))
@@ -2900,6 +3683,7 @@ BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile,
 	if (freeb)
 		BBPunfix(b->batCacheid);
 
+  doneselect:
 	bn->tkey = BATcount(bn) <= 1;
 	bn->tsorted = BATcount(bn) <= 1;
 	bn->trevsorted = BATcount(bn) <= 1;
@@ -2917,6 +3701,651 @@ BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile,
 	return NULL;
 }
 
+/* Determine several quantiles of the values of b (restricted to the
+ * candidates s) at once; q is a BAT of dbl with the quantiles, the
+ * result is aligned with q.  The fixed-size numeric types are
+ * partitioned once for all quantiles, other types are sorted once. */
+BAT *
+BATquantiles(BAT *b, BAT *s, BAT *q, int skip_nils)
+{
+	BUN start, end, cnt, nq, i, k, nils = 0, nnils;
+	const oid *cand = NULL, *candend = NULL;
+	const double *qs;
+	int tp;
+	BAT *bn, *t1;
+	BATiter bi;
+	const void *nil;
+
+	BATcheck(b, "BATquantiles", NULL);
+	BATcheck(q, "BATquantiles", NULL);
+	tp = b->ttype;
+	if (!ATOMlinear(tp)) {
+		GDKerror("BATquantiles: cannot determine quantile on "
+			 "non-linear type %s\n", ATOMname(tp));
+		return NULL;
+	}
+	if (q->ttype != TYPE_dbl) {
+		GDKerror("BATquantiles: quantiles must be of type dbl\n");
+		return NULL;
+	}
+	nq = BATcount(q);
+	qs = (const double *) Tloc(q, 0);
+	for (i = 0; i < nq; i++) {
+		if (is_dbl_nil(qs[i]) || qs[i] < 0 || qs[i] > 1) {
+			GDKerror("BATquantiles: cannot determine quantile for "
+				 "p=%f (p has to be in [0,1])\n", qs[i]);
+			return NULL;
+		}
+	}
+	CANDINIT(b, s, start, end, cnt, cand, candend);
+	nil = ATOMnilptr(tp);
+
+	bn = COLnew(q->hseqbase, tp, nq, TRANSIENT);
+	if (bn == NULL)
+		return NULL;
+	if (nq == 0)
+		return bn;
+
+	if (quantile_selectable(tp)) {
+		ALGODEBUG fprintf(stderr, "#BATquantiles(b=" ALGOBATFMT
+				  ",s=" ALGOOPTBATFMT ",q=" ALGOBATFMT
+				  "): select\n",
+				  ALGOBATPAR(b), ALGOOPTBATPAR(s),
+				  ALGOBATPAR(q));
+		nnils = quantile_values(b, bn, start, end, cand, candend,
+					qs, nq, skip_nils);
+		if (nnils == BUN_NONE) {
+			BBPreclaim(bn);
+			return NULL;
+		}
+	} else {
+		ALGODEBUG fprintf(stderr, "#BATquantiles(b=" ALGOBATFMT
+				  ",s=" ALGOOPTBATFMT ",q=" ALGOBATFMT
+				  "): sort\n",
+				  ALGOBATPAR(b), ALGOOPTBATPAR(s),
+				  ALGOBATPAR(q));
+		if (s) {
+			if ((b = BATproject(s, b)) == NULL) {
+				BBPreclaim(bn);
+				return NULL;
+			}
+		} else {
+			BBPfix(b->batCacheid);
+		}
+		if (BATsort(&t1, NULL, NULL, b, NULL, NULL, false, false) != GDK_SUCCEED) {
+			BBPunfix(b->batCacheid);
+			BBPreclaim(bn);
+			return NULL;
+		}
+		BBPunfix(b->batCacheid);
+		cnt = BATcount(t1);
+		/* nils sort first */
+		if (!t1->tnonil)
+			nils = binsearch(NULL, 0, tp, Tloc(t1, 0),
+					 t1->tvheap ? t1->tvheap->base : NULL,
+					 t1->twidth, 0, cnt, nil, 1, 1);
+		bi = bat_iterator(t1);
+		nnils = 0;
+		for (i = 0; i < nq; i++) {
+			const void *v;
+
+			if (skip_nils)
+				k = quantile_rank(cnt - nils, 0, qs[i]);
+			else
+				k = quantile_rank(cnt, nils, qs[i]);
+			if (k == BUN_NONE) {
+				v = nil;
+				nnils++;
+			} else {
+				v = BUNtail(bi, nils + k);
+			}
+			if (BUNappend(bn, v, false) != GDK_SUCCEED) {
+				BBPunfix(t1->batCacheid);
+				BBPreclaim(bn);
+				return NULL;
+			}
+		}
+		BBPunfix(t1->batCacheid);
+	}
+	bn->tkey = BATcount(bn) <= 1;
+	bn->tsorted = BATcount(bn) <= 1;
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->tnil = nnils != 0;
+	bn->tnonil = nnils == 0;
+	return bn;
+}
+
+/* ---------------------------------------------------------------------- */
+/* approximate quantiles */
+
+/* Approximate quantiles are determined from t-digests (Dunning and
+ * Ertl, 2019).  A t-digest summarizes a distribution by clusters of
+ * adjacent values (centroids) of which only the mean and the number of
+ * values (weight) are kept.  A centroid may cover at most one unit of
+ * the scale function
+ *	k(q) = C/(2 pi) asin(2q - 1)
+ * (where q is the fraction of the values below it and C the
+ * compression), so that centroids are small near the tails of the
+ * distribution and large in the middle, and that there are at most
+ * C+1 of them.  Since centroids can be merged, the digests of parts of
+ * a column can be combined into the digest of the whole column.
+ *
+ * A digest is built by collecting values in a buffer that, when full,
+ * is sorted and compressed into centroids.  Groups with few values are
+ * never compressed, so their quantiles are exact.  All values are
+ * converted to dbl. */
+
+#ifndef M_PI
+#define M_PI	((dbl) 3.14159265358979323846)
+#endif
+
+/* room for the centroids and values of a digest under construction */
+#define TD_ROOM		(10 * TDIGEST_COMPRESSION)
+
+/* return the fraction of values below the end of the unit of the
+ * scale function starting at fraction q */
+static inline dbl
+td_qlimit(dbl q)
+{
+	dbl k;
+
+	if (q >= 1)
+		return 1;
+	k = TDIGEST_COMPRESSION / (2 * M_PI) * asin(2 * q - 1) + 1;
+	if (k >= TDIGEST_COMPRESSION / 4.0)
+		return 1;
+	return (sin(k * 2 * M_PI / TDIGEST_COMPRESSION) + 1) / 2;
+}
+
+/* Merge the sorted centroids amean/aweight[0..na) and bmean/bweight[0..nb)
+ * (if bweight is NULL, the b's are single values) into at most
+ * TDIGEST_CENTROIDS centroids in mean/weight: adjacent centroids are
+ * merged for as long as they stay within one unit of the scale
+ * function.  Return the new number of centroids. */
+static BUN
+td_merge(dbl *restrict mean, dbl *restrict weight,
+	 const dbl *amean, const dbl *aweight, BUN na,
+	 const dbl *bmean, const dbl *bweight, BUN nb)
+{
+	dbl total = 0, wsofar = 0, wlimit = 0, m, w;
+	BUN i, ia = 0, ib = 0, n = 0;
+
+	for (i = 0; i < na; i++)
+		total += aweight[i];
+	if (bweight) {
+		for (i = 0; i < nb; i++)
+			total += bweight[i];
+	} else {
+		total += nb;
+	}
+	while (ia < na || ib < nb) {
+		if (ib == nb || (ia < na && amean[ia] <= bmean[ib])) {
+			m = amean[ia];
+			w = aweight[ia++];
+		} else {
+			m = bmean[ib];
+			w = bweight ? bweight[ib] : 1;
+			ib++;
+		}
+		/* there cannot be more than TDIGEST_COMPRESSION + 1
+		 * centroids, but be robust against rounding */
+		if (n > 0 &&
+		    (wsofar + weight[n - 1] + w <= wlimit ||
+		     n == TDIGEST_CENTROIDS)) {
+			weight[n - 1] += w;
+			mean[n - 1] += (m - mean[n - 1]) * w / weight[n - 1];
+		} else {
+			if (n > 0)
+				wsofar += weight[n - 1];
+			wlimit = total * td_qlimit(wsofar / total);
+			mean[n] = m;
+			weight[n] = w;
+			n++;
+		}
+	}
+	return n;
+}
+
+/* Interpolate quantile q from the n (> 0) sorted centroids of a digest
+ * with smallest and largest value min and max.  As for the exact
+ * quantile, the wanted rank is (total - 1) * q; centroid i is taken to
+ * be centered on the rank (weight before it) + (weight[i] - 1) / 2.
+ * Between two single values the rank is rounded down like for the
+ * exact quantile, so if there are only single values, the result is
+ * exact. */
+static dbl
+td_quantile(const dbl *mean, const dbl *weight, BUN n, dbl min, dbl max,
+	    double q)
+{
+	dbl total = 0, rank, lo, hi;
+	BUN i;
+
+	assert(n > 0);
+	for (i = 0; i < n; i++)
+		total += weight[i];
+	rank = (total - 1) * q;
+	lo = (weight[0] - 1) / 2;
+	if (rank <= lo)
+		return lo == 0 ? mean[0] : min + (mean[0] - min) * rank / lo;
+	for (i = 0; i < n - 1; i++) {
+		hi = lo + (weight[i] + weight[i + 1]) / 2;
+		if (rank < hi) {
+			if (weight[i] == 1 && weight[i + 1] == 1)
+				return rank - lo <= 0.5 ? mean[i] : mean[i + 1];
+			return mean[i] + (mean[i + 1] - mean[i]) * (rank - lo) / (hi - lo);
+		}
+		lo = hi;
+	}
+	hi = total - 1;
+	if (rank >= hi || hi == lo)
+		return max;
+	return mean[n - 1] + (max - mean[n - 1]) * (rank - lo) / (hi - lo);
+}
+
+/* The digests of the groups under construction: group i has room in
+ * mean/weight[off[i]..off[i+1]) for its sorted centroids (the first
+ * nc[i]) followed by the values that have not been merged into them
+ * yet (up to n[i]). */
+struct tdbuild {
+	BUN *off, *n, *nc;
+	dbl *mean, *weight;
+	dbl *min, *max;
+};
+
+static void
+td_free(struct tdbuild *td)
+{
+	GDKfree(td->off);
+	GDKfree(td->n);
+	GDKfree(td->nc);
+	GDKfree(td->mean);
+	GDKfree(td->weight);
+	GDKfree(td->min);
+	GDKfree(td->max);
+}
+
+/* merge the values of group grp into its centroids */
+static void
+td_flush(struct tdbuild *td, BUN grp)
+{
+	dbl mean[TDIGEST_CENTROIDS], weight[TDIGEST_CENTROIDS];
+	BUN o = td->off[grp], nc = td->nc[grp], n = td->n[grp];
+
+	GDKqsort(td->mean + o + nc, NULL, NULL, n - nc, (int) sizeof(dbl), 0,
+		 TYPE_dbl);
+	nc = td_merge(mean, weight, td->mean + o, td->weight + o, nc,
+		      td->mean + o + nc, NULL, n - nc);
+	memcpy(td->mean + o, mean, nc * sizeof(dbl));
+	memcpy(td->weight + o, weight, nc * sizeof(dbl));
+	td->nc[grp] = td->n[grp] = nc;
+}
+
+static inline void
+td_add(struct tdbuild *restrict td, BUN grp, dbl v)
+{
+	BUN n = td->n[grp];
+
+	if (n == 0) {
+		td->min[grp] = td->max[grp] = v;
+	} else {
+		if (v < td->min[grp])
+			td->min[grp] = v;
+		if (v > td->max[grp])
+			td->max[grp] = v;
+		if (n == td->off[grp + 1] - td->off[grp]) {
+			td_flush(td, grp);
+			n = td->n[grp];
+		}
+	}
+	td->mean[td->off[grp] + n] = v;
+	td->n[grp] = n + 1;
+}
+
+#define TD_ADD_LOOP(TYPE)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		for (;;) {						\
+			if (cand) {					\
+				if (cand == candend)			\
+					break;				\
+				i = *cand++ - b->hseqbase;		\
+			} else {					\
+				if (start == end)			\
+					break;				\
+				i = start++;				\
+			}						\
+			gid = gids ? gids[i] : g ? gbase + i : min;	\
+			if (gid < min || gid > max ||			\
+			    is_##TYPE##_nil(vals[i]))			\
+				continue;				\
+			td_add(td, gid - min, (dbl) vals[i]);		\
+		}							\
+	} while (0)
+
+static bool
+td_supported(int tp)
+{
+	switch (ATOMbasetype(tp)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Build the digests of the groups [min,max] of the non-nil values of b
+ * (at the positions given by start/end/cand). */
+static gdk_return
+td_build(struct tdbuild *td, BAT *b, BAT *g, oid min, oid max, BUN ngrp,
+	 BUN start, BUN end, const oid *cand, const oid *candend)
+{
+	const oid *gids = NULL;
+	oid gbase = 0, gid;
+	const oid *c;
+	BUN i, grp, room, cnt;
+
+	*td = (struct tdbuild) {0};
+	if (g != NULL) {
+		if (BATtdense(g))
+			gbase = g->tseqbase;
+		else
+			gids = (const oid *) Tloc(g, 0);
+	}
+	td->off = GDKzalloc((ngrp + 1) * sizeof(BUN));
+	td->n = GDKzalloc(ngrp * sizeof(BUN));
+	td->nc = GDKzalloc(ngrp * sizeof(BUN));
+	td->min = GDKmalloc(ngrp * sizeof(dbl));
+	td->max = GDKmalloc(ngrp * sizeof(dbl));
+	if (td->off == NULL || td->n == NULL || td->nc == NULL ||
+	    td->min == NULL || td->max == NULL) {
+		td_free(td);
+		return GDK_FAIL;
+	}
+	/* count the values of each group to give each group room for
+	 * all of its values, but no more than TD_ROOM */
+	if (g == NULL) {
+		td->off[0] = cand ? (BUN) (candend - cand) : end - start;
+	} else {
+		for (c = cand, i = start; c ? c < candend : i < end; i++) {
+			BUN p = c ? *c++ - b->hseqbase : i;
+
+			gid = gids ? gids[p] : gbase + p;
+			if (gid >= min && gid <= max)
+				td->off[gid - min]++;
+		}
+	}
+	for (grp = 0, room = 0; grp < ngrp; grp++) {
+		cnt = td->off[grp];
+		td->off[grp] = room;
+		room += cnt < TD_ROOM ? cnt : TD_ROOM;
+	}
+	td->off[ngrp] = room;
+	td->mean = GDKmalloc((room ? room : 1) * sizeof(dbl));
+	td->weight = GDKmalloc((room ? room : 1) * sizeof(dbl));
+	if (td->mean == NULL || td->weight == NULL) {
+		td_free(td);
+		return GDK_FAIL;
+	}
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		TD_ADD_LOOP(bte);
+		break;
+	case TYPE_sht:
+		TD_ADD_LOOP(sht);
+		break;
+	case TYPE_int:
+		TD_ADD_LOOP(int);
+		break;
+	case TYPE_lng:
+		TD_ADD_LOOP(lng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		TD_ADD_LOOP(hge);
+		break;
+#endif
+	case TYPE_flt:
+		TD_ADD_LOOP(flt);
+		break;
+	case TYPE_dbl:
+		TD_ADD_LOOP(dbl);
+		break;
+	default:
+		assert(0);
+	}
+	return GDK_SUCCEED;
+}
+
+/* Finish the digest of group grp for determining a quantile and return
+ * its number of centroids.  If the values were never merged into
+ * centroids, they only need to be sorted.  Otherwise, the remaining
+ * values must be merged: a value near the mean of a large centroid
+ * would pin half of the centroid to itself in the interpolation. */
+static BUN
+td_finish(struct tdbuild *td, BUN grp)
+{
+	BUN o = td->off[grp], n = td->n[grp], i;
+
+	if (td->nc[grp] == 0) {
+		GDKqsort(td->mean + o, NULL, NULL, n, (int) sizeof(dbl), 0,
+			 TYPE_dbl);
+		for (i = 0; i < n; i++)
+			td->weight[o + i] = 1;
+		return n;
+	}
+	td_flush(td, grp);
+	return td->n[grp];
+}
+
+#define TD_RESULT(TYPE, ROUND)						\
+	do {								\
+		TYPE *restrict dst = (TYPE *) Tloc(bn, 0);		\
+		for (grp = 0; grp < ngrp; grp++) {			\
+			if (td.n[grp] == 0) {				\
+				dst[grp] = TYPE##_nil;			\
+				nils++;					\
+				continue;				\
+			}						\
+			o = td.off[grp];				\
+			v = td_quantile(td.mean + o, td.weight + o,	\
+					td_finish(&td, grp),		\
+					td.min[grp], td.max[grp],	\
+					quantile);			\
+			dst[grp] = (TYPE) ROUND(v);			\
+		}							\
+	} while (0)
+
+BAT *
+BATgroupapprox_quantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp,
+			double quantile, int skip_nils, int abort_on_error)
+{
+	oid min, max;
+	BUN ngrp, start, end, grp, o, nils = 0;
+	const oid *cand = NULL, *candend = NULL;
+	const char *err;
+	struct tdbuild td;
+	BAT *bn;
+	dbl v;
+	lng t0 = 0;
+
+	(void) skip_nils;	/* nils are always skipped */
+	(void) abort_on_error;
+
+	ALGODEBUG t0 = GDKusec();
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		GDKerror("BATgroupapprox_quantile: %s\n", err);
+		return NULL;
+	}
+	assert(tp == b->ttype);
+	if (!td_supported(tp)) {
+		GDKerror("BATgroupapprox_quantile: cannot determine "
+			 "approximate quantile on type %s\n", ATOMname(tp));
+		return NULL;
+	}
+	if (is_dbl_nil(quantile) || quantile < 0 || quantile > 1) {
+		GDKerror("BATgroupapprox_quantile: cannot determine quantile "
+			 "for p=%f (p has to be in [0,1])\n", quantile);
+		return NULL;
+	}
+
+	if (BATcount(b) == 0 || ngrp == 0) {
+		/* trivial: no values, thus also no quantiles, so
+		 * return bat aligned with e with nil in the tail */
+		return BATconstant(ngrp == 0 ? 0 : min, tp, ATOMnilptr(tp),
+				   ngrp, TRANSIENT);
+	}
+
+	bn = COLnew(min, tp, ngrp, TRANSIENT);
+	if (bn == NULL)
+		return NULL;
+	if (td_build(&td, b, g, min, max, ngrp, start, end,
+		     cand, candend) != GDK_SUCCEED) {
+		BBPreclaim(bn);
+		return NULL;
+	}
+	switch (ATOMbasetype(tp)) {
+	case TYPE_bte:
+		TD_RESULT(bte, round);
+		break;
+	case TYPE_sht:
+		TD_RESULT(sht, round);
+		break;
+	case TYPE_int:
+		TD_RESULT(int, round);
+		break;
+	case TYPE_lng:
+		TD_RESULT(lng, round);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		TD_RESULT(hge, round);
+		break;
+#endif
+	case TYPE_flt:
+		TD_RESULT(flt, );
+		break;
+	case TYPE_dbl:
+		TD_RESULT(dbl, );
+		break;
+	default:
+		assert(0);
+	}
+	td_free(&td);
+
+	BATsetcount(bn, ngrp);
+	bn->tkey = ngrp <= 1;
+	bn->tsorted = ngrp <= 1;
+	bn->trevsorted = ngrp <= 1;
+	bn->tnil = nils != 0;
+	bn->tnonil = nils == 0;
+	ALGODEBUG fprintf(stderr, "#BATgroupapprox_quantile(b=" ALGOBATFMT
+			  ",g=" ALGOOPTBATFMT ",s=" ALGOOPTBATFMT
+			  ",q=%g) -> " ALGOBATFMT " (" LLFMT "usec)\n",
+			  ALGOBATPAR(b), ALGOOPTBATPAR(g), ALGOOPTBATPAR(s),
+			  quantile, ALGOBATPAR(bn), GDKusec() - t0);
+	return bn;
+}
+
+/* Compute the t-digests of the groups of b; return an array of *ngrpp
+ * digests of which the first belongs to group *minp, or NULL on
+ * failure. */
+tdigest *
+BATgrouptdigest(BAT *b, BAT *g, BAT *e, BAT *s, BUN *ngrpp, oid *minp)
+{
+	oid min, max;
+	BUN ngrp, start, end, grp, o, n;
+	const oid *cand = NULL, *candend = NULL;
+	const char *err;
+	struct tdbuild td;
+	tdigest *tds;
+
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		GDKerror("BATgrouptdigest: %s\n", err);
+		return NULL;
+	}
+	if (!td_supported(b->ttype)) {
+		GDKerror("BATgrouptdigest: cannot build t-digest on type %s\n",
+			 ATOMname(b->ttype));
+		return NULL;
+	}
+	if (BATcount(b) == 0)
+		ngrp = 0;
+	/* always allocate at least one digest */
+	tds = GDKmalloc((ngrp ? ngrp : 1) * sizeof(tdigest));
+	if (tds == NULL)
+		return NULL;
+	if (ngrp == 0) {
+		tds[0] = (tdigest) {.min = dbl_nil, .max = dbl_nil, .n = 0};
+	} else {
+		if (td_build(&td, b, g, min, max, ngrp, start, end,
+			     cand, candend) != GDK_SUCCEED) {
+			GDKfree(tds);
+			return NULL;
+		}
+		for (grp = 0; grp < ngrp; grp++) {
+			if (td.n[grp] > 0)
+				td_flush(&td, grp);
+			o = td.off[grp];
+			n = td.n[grp];
+			tds[grp].n = n;
+			tds[grp].min = n == 0 ? dbl_nil : td.min[grp];
+			tds[grp].max = n == 0 ? dbl_nil : td.max[grp];
+			memcpy(tds[grp].mean, td.mean + o, n * sizeof(dbl));
+			memcpy(tds[grp].weight, td.weight + o, n * sizeof(dbl));
+		}
+		td_free(&td);
+	}
+	*ngrpp = ngrp;
+	*minp = min;
+	return tds;
+}
+
+/* merge the digest src into dst */
+void
+TDIGESTmerge(tdigest *restrict dst, const tdigest *restrict src)
+{
+	dbl mean[TDIGEST_CENTROIDS], weight[TDIGEST_CENTROIDS];
+	BUN n;
+
+	if (src->n == 0)
+		return;
+	if (dst->n == 0) {
+		*dst = *src;
+		return;
+	}
+	n = td_merge(mean, weight, dst->mean, dst->weight, dst->n,
+		     src->mean, src->weight, src->n);
+	memcpy(dst->mean, mean, n * sizeof(dbl));
+	memcpy(dst->weight, weight, n * sizeof(dbl));
+	dst->n = n;
+	if (src->min < dst->min)
+		dst->min = src->min;
+	if (src->max > dst->max)
+		dst->max = src->max;
+}
+
+/* the approximate quantile of the values summarized by a digest, or
+ * nil if there are none */
+dbl
+TDIGESTquantile(const tdigest *td, double quantile)
+{
+	if (td->n == 0)
+		return dbl_nil;
+	return td_quantile(td->mean, td->weight, td->n, td->min, td->max,
+			   quantile);
+}
+
 /* ---------------------------------------------------------------------- */
 /* standard deviation (both biased and non-biased) */
 
@@ -131,6 +131,10 @@ VIEWcreate(oid seq, BAT *b)
 	bn->timprints = NULL;
 	/* Order OID index */
 	bn->torderidx = NULL;
+	/* zone maps are shared, but the check is dynamic */
+	bn->tzonemap = NULL;
+	bn->tpacked = NULL;
+	bn->trle = NULL;
 	if (BBPcacheit(bn, 1) != GDK_SUCCEED) {	/* enter in BBP */
 		if (tp)
 			BBPunshare(tp);
@@ -178,6 +182,9 @@ BATmaterialize(BAT *b)
 	HASHdestroy(b);
 	IMPSdestroy(b);
 	OIDXdestroy(b);
+	ZMdestroy(b);
+	PACKdestroy(b);
+	RLEdestroy(b);
 
 	snprintf(b->theap.filename, sizeof(b->theap.filename), "%s.tail", BBP_physical(b->batCacheid));
 	if (HEAPalloc(&b->theap, cnt, sizeof(oid)) != GDK_SUCCEED) {
@@ -422,6 +429,9 @@ VIEWdestroy(BAT *b)
 	HASHdestroy(b);
 	IMPSdestroy(b);
 	OIDXdestroy(b);
+	ZMdestroy(b);
+	PACKdestroy(b);
+	RLEdestroy(b);
 	VIEWunlink(b);
 
 	if (b->ttype && !b->theap.parentid) {
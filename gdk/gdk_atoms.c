@@ -1235,6 +1235,36 @@ strLocate(Heap *h, const char *v)
 	return 0;
 }
 
+/* Return the positions of all strings in the fully double eliminated
+ * string heap h in a newly allocated array, and their number in *np.
+ * Since every string occurs only once in such a heap, the position
+ * of a string serves as a code for the string. */
+var_t *
+strDictionary(const Heap *h, BUN *np)
+{
+	const size_t extralen = h->hashash ? EXTRALEN : 0;
+	size_t pad, pos;
+	var_t *codes;
+	BUN n = 0;
+
+	assert(GDK_ELIMDOUBLES(h));
+	/* each string takes more than GDK_VARALIGN bytes */
+	codes = GDKmalloc((h->free / GDK_VARALIGN + 1) * sizeof(var_t));
+	if (codes == NULL)
+		return NULL;
+	pos = GDK_STRHASHSIZE;
+	while (pos < h->free) {
+		pad = GDK_VARALIGN - (pos & (GDK_VARALIGN - 1));
+		if (pad < sizeof(stridx_t))
+			pad += GDK_VARALIGN;
+		pos += pad + extralen;
+		codes[n++] = (var_t) pos;
+		pos += GDK_STRLEN(h->base + pos);
+	}
+	*np = n;
+	return codes;
+}
+
 static var_t
 strPut(Heap *h, var_t *dst, const char *v)
 {
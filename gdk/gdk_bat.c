@@ -109,6 +109,9 @@ BATcreatedesc(oid hseq, int tt, int heapnames, int role)
  	* Default zero for order oid index
  	*/
 	bn->torderidx = NULL;
+	bn->tzonemap = NULL;
+	bn->tpacked = NULL;
+	bn->trle = NULL;
 	/*
 	 * fill in heap names, so HEAPallocs can resort to disk for
 	 * very large writes.
@@ -499,6 +502,9 @@ BATclear(BAT *b, bool force)
 	HASHdestroy(b);
 	IMPSdestroy(b);
 	OIDXdestroy(b);
+	ZMdestroy(b);
+	PACKdestroy(b);
+	RLEdestroy(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
 
@@ -569,6 +575,9 @@ BATfree(BAT *b)
 	HASHfree(b);
 	IMPSfree(b);
 	OIDXfree(b);
+	ZMfree(b);
+	PACKfree(b);
+	RLEfree(b);
 	if (b->ttype)
 		HEAPfree(&b->theap, false);
 	else
@@ -1053,6 +1062,9 @@ BUNappend(BAT *b, const void *t, bool force)
 
 	IMPSdestroy(b); /* no support for inserts in imprints yet */
 	OIDXdestroy(b);
+	ZMappend(b);
+	PACKappend(b);
+	RLEappend(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
 	if (b->thash == (Hash *) 1 ||
@@ -1120,6 +1132,9 @@ BUNdelete(BAT *b, oid o)
 	}
 	IMPSdestroy(b);
 	OIDXdestroy(b);
+	ZMdestroy(b);
+	PACKdestroy(b);
+	RLEdestroy(b);
 	HASHdestroy(b);
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
@@ -1169,6 +1184,9 @@ BUNinplace(BAT *b, BUN p, const void *t, bool force)
 	b->tprops = NULL;
 	OIDXdestroy(b);
 	IMPSdestroy(b);
+	ZMdestroy(b);
+	PACKdestroy(b);
+	RLEdestroy(b);
 	if (b->tvarsized && b->ttype) {
 		var_t _d;
 		ptr _ptr;
@@ -1456,6 +1474,9 @@ BATsetcount(BAT *b, BUN cnt)
 	assert(!is_oid_nil(b->hseqbase));
 	assert(cnt <= BUN_MAX);
 
+	ZMtruncate(b, cnt);
+	PACKtruncate(b, cnt);
+	RLEtruncate(b, cnt);
 	b->batCount = cnt;
 	b->batDirtydesc = true;
 	b->theap.free = tailsize(b, cnt);
@@ -1905,6 +1926,25 @@ BATgetaccess(BAT *b)
 	return b->batRestricted;
 }
 
+/*
+ * @- NUMA placement
+ * Move the memory of the tail column of b to the given NUMA node.
+ * For a view, only the part of the parent's heap that the view covers
+ * is moved, so that the slices of a column that are handed out to
+ * parallel workers can be spread over the nodes.  This is a hint: if
+ * the memory cannot be moved, nothing happens.
+ */
+void
+BATsetnode(BAT *b, int node)
+{
+	if (b == NULL || MT_nr_nodes() <= 1 || b->ttype == TYPE_void ||
+	    b->theap.base == NULL || BATcount(b) == 0)
+		return;
+	if (MT_place_node(Tloc(b, 0), (size_t) BATcount(b) << b->tshift, node, 1) == 0)
+		ALGODEBUG fprintf(stderr, "#BATsetnode(b=" ALGOBATFMT ",node=%d)\n",
+				  ALGOBATPAR(b), node);
+}
+
 /*
  * @- change BAT persistency (persistent,session,transient)
  * In the past, we prevented BATS with certain types from being saved at all:
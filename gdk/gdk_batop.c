@@ -760,6 +760,9 @@ BATappend(BAT *b, BAT *n, BAT *s, bool force)
 		}
 		b->theap.dirty = true;
 	}
+	ZMappend(b);
+	PACKappend(b);
+	RLEappend(b);
 	if (b->tunique)
 		BBPunfix(s->batCacheid);
 	return GDK_SUCCEED;
@@ -879,6 +882,9 @@ BATdel(BAT *b, BAT *d)
 	b->tnokey[0] = b->tnokey[1] = 0;
 	PROPdestroy(b->tprops);
 	b->tprops = NULL;
+	ZMdestroy(b);
+	PACKdestroy(b);
+	RLEdestroy(b);
 
 	return GDK_SUCCEED;
 }
@@ -1283,15 +1289,29 @@ BATordered_rev(BAT *b)
 	return b->trevsorted;
 }
 
+/* minimum number of values for which we use radix sort */
+#define RSORT_THRESHOLD	4096
+
 /* figure out which sort function is to be called
  * stable sort can produce an error (not enough memory available),
- * "quick" sort does not produce errors */
+ * "quick" sort does not produce errors
+ * large arrays of fixed-width numeric types are sorted using the
+ * (stable and multi-threaded) radix sort, which can also produce an
+ * error; if we didn't need a stable sort, we then fall back to
+ * "quick" sort */
 static gdk_return
 do_sort(void *restrict h, void *restrict t, const void *restrict base,
 	size_t n, int hs, int ts, int tpe, bool reverse, bool stable)
 {
 	if (n <= 1)		/* trivially sorted */
 		return GDK_SUCCEED;
+	if (n >= RSORT_THRESHOLD && GDKrsortable(tpe)) {
+		if (GDKrsort(h, t, n, hs, ts, tpe, reverse) == GDK_SUCCEED)
+			return GDK_SUCCEED;
+		if (stable)
+			return GDK_FAIL;
+		GDKclrerr();
+	}
 	if (reverse) {
 		if (stable) {
 			return GDKssort_rev(h, t, base, n, hs, ts, tpe);
@@ -1997,6 +2017,122 @@ BATcount_no_nil(BAT *b)
 	return cnt;
 }
 
+/* Bitmap candidate lists.
+ *
+ * Internally, a candidate list can also be represented as a bitmap
+ * with one bit per oid in a range (see Candmask in gdk_private.h).
+ * When candidate lists with many values in a limited range have to be
+ * combined, it is cheaper to convert them to bitmaps and combine
+ * those with bitwise AND or OR than to merge the oid lists, since the
+ * merge has a hard to predict branch for every value.  The result is
+ * converted back to a normal candidate list. */
+
+/* number of trailing zero bits of a non-zero value */
+#ifdef __GNUC__
+#define ctz(x)		__builtin_ctz(x)
+#else
+static inline int
+ctz(uint32_t x)
+{
+	int n = 0;
+
+	while ((x & 1) == 0) {
+		x >>= 1;
+		n++;
+	}
+	return n;
+}
+#endif
+
+/* initialize an empty bitmap covering the oids first up to (but not
+ * including) last */
+gdk_return
+CANDmaskinit(Candmask *m, oid first, oid last)
+{
+	m->first = first;
+	m->nbits = last > first ? (BUN) (last - first) : 0;
+	/* allocate at least one word */
+	m->mask = GDKzalloc((m->nbits / 32 + 1) * sizeof(uint32_t));
+	return m->mask ? GDK_SUCCEED : GDK_FAIL;
+}
+
+void
+CANDmaskfree(Candmask *m)
+{
+	GDKfree(m->mask);
+	m->mask = NULL;
+}
+
+/* set the bits for the candidates in s that fall in the range of m */
+void
+CANDmaskadd(Candmask *m, BAT *s)
+{
+	oid lo = m->first, hi = m->first + m->nbits;
+	BUN p, q;
+
+	assert(ATOMtype(s->ttype) == TYPE_oid);
+	p = SORTfndfirst(s, &lo);
+	q = SORTfndfirst(s, &hi);
+	if (BATtdense(s)) {
+		oid o;
+
+		for (o = s->tseqbase + p; o < s->tseqbase + q; o++)
+			CANDmaskset(m, o);
+	} else {
+		const oid *restrict o = (const oid *) Tloc(s, 0);
+
+		for (; p < q; p++)
+			CANDmaskset(m, o[p]);
+	}
+}
+
+void
+CANDmaskand(Candmask *m, const Candmask *n)
+{
+	BUN i, nw = (m->nbits + 31) / 32;
+
+	assert(m->first == n->first && m->nbits == n->nbits);
+	for (i = 0; i < nw; i++)
+		m->mask[i] &= n->mask[i];
+}
+
+/* convert a bitmap to a candidate list; cnt is an upper bound for the
+ * number of bits set */
+BAT *
+CANDmasktocand(const Candmask *m, BUN cnt)
+{
+	BAT *bn;
+	oid *restrict p;
+	BUN i, nw = (m->nbits + 31) / 32;
+
+	bn = COLnew(0, TYPE_oid, cnt, TRANSIENT);
+	if (bn == NULL)
+		return NULL;
+	p = (oid *) Tloc(bn, 0);
+	for (i = 0; i < nw; i++) {
+		uint32_t w = m->mask[i];
+		oid o = m->first + i * 32;
+
+		while (w != 0) {
+			*p++ = o + ctz(w);
+			w &= w - 1;
+		}
+	}
+	BATsetcount(bn, (BUN) (p - (oid *) Tloc(bn, 0)));
+	assert(BATcount(bn) <= cnt);
+	bn->trevsorted = BATcount(bn) <= 1;
+	bn->tsorted = true;
+	bn->tkey = true;
+	bn->tnil = false;
+	bn->tnonil = true;
+	return virtualize(bn);
+}
+
+/* whether to combine candidate lists with a total of cnt values that
+ * span the range [first, last) using bitmaps: the bitmap must not be
+ * much larger than the lists themselves */
+#define CANDMASK_DENSE(first, last, cnt)	((last) - (first) <= 16 * (cnt))
+
 /* create a new, dense candidate list with values from `first' up to,
  * but not including, `last' */
 static BAT *
@@ -2068,6 +2204,20 @@ BATmergecand(BAT *a, BAT *b)
 	if (bd && bf <= af && bl >= al) {
 		return newdensecand(bf, bl + 1);
 	}
+	if (a->ttype == TYPE_oid && b->ttype == TYPE_oid &&
+	    CANDMASK_DENSE(MIN(af, bf), MAX(al, bl) + 1,
+			   BATcount(a) + BATcount(b))) {
+		/* union of the bitmaps */
+		Candmask m;
+
+		if (CANDmaskinit(&m, MIN(af, bf), MAX(al, bl) + 1) != GDK_SUCCEED)
+			return NULL;
+		CANDmaskadd(&m, a);
+		CANDmaskadd(&m, b);
+		bn = CANDmasktocand(&m, BATcount(a) + BATcount(b));
+		CANDmaskfree(&m);
+		return bn;
+	}
 
 	bn = COLnew(0, TYPE_oid, BATcount(a) + BATcount(b), TRANSIENT);
 	if (bn == NULL)
@@ -2178,6 +2328,27 @@ BATintersectcand(BAT *a, BAT *b)
 		/* both lists are VOID */
 		return newdensecand(MAX(af, bf), MIN(al, bl) + 1);
 	}
+	if (a->ttype == TYPE_oid && b->ttype == TYPE_oid &&
+	    CANDMASK_DENSE(MAX(af, bf), MIN(al, bl) + 1,
+			   BATcount(a) + BATcount(b))) {
+		/* intersection of the bitmaps over the overlapping
+		 * range */
+		Candmask ma, mb;
+
+		if (CANDmaskinit(&ma, MAX(af, bf), MIN(al, bl) + 1) != GDK_SUCCEED)
+			return NULL;
+		if (CANDmaskinit(&mb, MAX(af, bf), MIN(al, bl) + 1) != GDK_SUCCEED) {
+			CANDmaskfree(&ma);
+			return NULL;
+		}
+		CANDmaskadd(&ma, a);
+		CANDmaskadd(&mb, b);
+		CANDmaskand(&ma, &mb);
+		CANDmaskfree(&mb);
+		bn = CANDmasktocand(&ma, MIN(BATcount(a), BATcount(b)));
+		CANDmaskfree(&ma);
+		return bn;
+	}
 
 	bn = COLnew(0, TYPE_oid, MIN(BATcount(a), BATcount(b)), TRANSIENT);
 	if (bn == NULL)
@@ -129,6 +129,26 @@ gdk_export BAT *BATgroupmin(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nil
 gdk_export BAT *BATgroupmax(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
 gdk_export BAT *BATgroupmedian(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
 gdk_export BAT *BATgroupquantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile, int skip_nils, int abort_on_error);
+gdk_export BAT *BATquantiles(BAT *b, BAT *s, BAT *q, int skip_nils);
+
+#define HLL_PRECISION	12	/* log2 of the number of registers of a sketch */
+#define HLL_REGISTERS	(1 << HLL_PRECISION)
+gdk_export BAT *BATgroupapprox_count_distinct(BAT *b, BAT *g, BAT *e, BAT *s, int tp, int skip_nils, int abort_on_error);
+gdk_export uint8_t *BATgrouphll(BAT *b, BAT *g, BAT *e, BAT *s, BUN *ngrpp, oid *minp);
+gdk_export lng HLLcount(const uint8_t *regs, int p);
+
+#define TDIGEST_COMPRESSION	100	/* accuracy parameter of t-digests */
+#define TDIGEST_CENTROIDS	(TDIGEST_COMPRESSION + 2)
+typedef struct {
+	dbl min, max;		/* smallest and largest value (or nil) */
+	BUN n;			/* number of centroids */
+	dbl mean[TDIGEST_CENTROIDS]; /* mean of each centroid, ascending */
+	dbl weight[TDIGEST_CENTROIDS]; /* number of values of each centroid */
+} tdigest;
+gdk_export BAT *BATgroupapprox_quantile(BAT *b, BAT *g, BAT *e, BAT *s, int tp, double quantile, int skip_nils, int abort_on_error);
+gdk_export tdigest *BATgrouptdigest(BAT *b, BAT *g, BAT *e, BAT *s, BUN *ngrpp, oid *minp);
+gdk_export void TDIGESTmerge(tdigest *restrict dst, const tdigest *restrict src);
+gdk_export dbl TDIGESTquantile(const tdigest *td, double quantile);
 
 /* helper function for grouped aggregates */
 gdk_export const char *BATgroupaggrinit(
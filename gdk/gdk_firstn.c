@@ -10,6 +10,7 @@
 #include "gdk.h"
 #include "gdk_private.h"
 #include "gdk_calc_private.h"
+#include "gdk_zonemap.h"
 
 /* BATfirstn select the smallest n elements from the input bat b (if
  * asc(ending) is set, else the largest n elements).  Conceptually, b
@@ -128,6 +129,215 @@
 		}							\
 	} while (0)
 
+/* For large inputs without candidate list (or with a dense one), the
+ * input is cut into slices of at least FIRSTN_SLICE values which are
+ * processed by separate threads, each keeping a heap of its own N
+ * smallest/largest values.  The N * nthreads values of these heaps
+ * are then treated as a candidate list for a final pass.  If the
+ * input (or its parent) has a zone map, blocks whose smallest value
+ * (largest value when descending) cannot enter the heap are
+ * skipped. */
+#define FIRSTN_SLICE	((BUN) 1 << 20)
+
+struct firstn_task {
+	BAT *b;
+	oid *oids;		/* the heap of this task (n values) */
+	BUN n;
+	BUN start, end;		/* the slice of b handled by this task */
+	const Heap *zm;		/* zone map of b (or its parent) */
+	BUN zoff;		/* position of b in the zone map */
+	bool asc;
+	BUN skipped;		/* number of blocks skipped */
+};
+
+/* whether no value of the block with zone map record rec can enter
+ * the heap; nils are smaller than any other value, so they can only
+ * enter when ascending */
+#define firstn_zmskip(TYPE, OP, ASC)					\
+	(ASC ?								\
+	 ZMnils(rs, rec) == 0 &&					\
+	 !OP(ZMmin(TYPE, rec), vals[oids[0] - b->hseqbase]) :		\
+	 ZMnils(rs, rec) == blkcnt ||					\
+	 !OP(ZMmax(TYPE, rec), vals[oids[0] - b->hseqbase]))
+
+#define firstn_slice(TYPE, OP, ASC)					\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		heapify(OP##fix, SWAP1);				\
+		for (p = start; p < end; p = q) {			\
+			q = end;					\
+			if (zm && p + zoff < covered) {			\
+				blk = (p + zoff) / ZONEMAP_BLOCK;	\
+				blkcnt = MIN((blk + 1) * ZONEMAP_BLOCK, covered) - blk * ZONEMAP_BLOCK; \
+				q = MIN(blk * ZONEMAP_BLOCK + blkcnt - zoff, end); \
+				rec = ZMrec(zm, rs, blk);		\
+				if (firstn_zmskip(TYPE, OP, ASC)) {	\
+					t->skipped++;			\
+					continue;			\
+				}					\
+			}						\
+			for (; p < q; p++) {				\
+				if (OP(vals[p], vals[oids[0] - b->hseqbase])) { \
+					oids[0] = p + b->hseqbase;	\
+					siftup(OP##fix, 0, SWAP1);	\
+				}					\
+			}						\
+		}							\
+	} while (0)
+
+static void
+firstn_worker(void *arg)
+{
+	struct firstn_task *t = arg;
+	BAT *b = t->b;
+	oid *restrict oids = t->oids;
+	BUN n = t->n, start = t->start, end = t->end;
+	const Heap *zm = t->zm;
+	BUN zoff = t->zoff, covered = zm ? (BUN) ((const oid *) zm->base)[1] : 0;
+	size_t rs = zm ? ZMrecsize(b) : 0;
+	const char *rec;
+	BUN i, p, q, blk, blkcnt;
+	/* variables used in heapify/siftup macros */
+	oid item;
+	BUN pos, childpos;
+
+	/* start with the first (last if descending) n values, see
+	 * BATfirstn_unique */
+	if (t->asc) {
+		for (i = 0; i < n; i++)
+			oids[i] = start++ + b->hseqbase;
+	} else {
+		for (i = 0; i < n; i++)
+			oids[i] = --end + b->hseqbase;
+	}
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		if (t->asc)
+			firstn_slice(bte, LT, true);
+		else
+			firstn_slice(bte, GT, false);
+		break;
+	case TYPE_sht:
+		if (t->asc)
+			firstn_slice(sht, LT, true);
+		else
+			firstn_slice(sht, GT, false);
+		break;
+	case TYPE_int:
+		if (t->asc)
+			firstn_slice(int, LT, true);
+		else
+			firstn_slice(int, GT, false);
+		break;
+	case TYPE_lng:
+		if (t->asc)
+			firstn_slice(lng, LT, true);
+		else
+			firstn_slice(lng, GT, false);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		if (t->asc)
+			firstn_slice(hge, LT, true);
+		else
+			firstn_slice(hge, GT, false);
+		break;
+#endif
+	case TYPE_flt:
+		if (t->asc)
+			firstn_slice(flt, LTflt, true);
+		else
+			firstn_slice(flt, GTflt, false);
+		break;
+	case TYPE_dbl:
+		if (t->asc)
+			firstn_slice(dbl, LTdbl, true);
+		else
+			firstn_slice(dbl, GTdbl, false);
+		break;
+	default:
+		assert(0);
+	}
+}
+
+/* Determine the N smallest/largest values of b[start..end) using
+ * per-slice heaps and/or the zone map of b.  Return the heaps of the
+ * slices in a newly allocated array of *np oids, or NULL if this
+ * doesn't apply. */
+static oid *
+firstn_slices(BAT *b, BUN start, BUN end, BUN n, bool asc, BUN *np)
+{
+	struct firstn_task *tasks;
+	BAT *pb;
+	const Heap *zm = NULL;
+	BUN zoff = 0, cnt = end - start, slice, skipped = 0;
+	int nthreads = GDKnr_threads, i;
+	oid *oids;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		break;
+	default:
+		return NULL;
+	}
+	if ((BUN) nthreads > cnt / MAX(FIRSTN_SLICE, 8 * n))
+		nthreads = (int) (cnt / MAX(FIRSTN_SLICE, 8 * n));
+	if (nthreads < 1)
+		nthreads = 1;
+	pb = VIEWtparent(b) ? BBPdescriptor(VIEWtparent(b)) : b;
+	if (n < ZONEMAP_BLOCK && cnt >= 2 * ZONEMAP_BLOCK &&
+	    BATcheckzonemap(pb)) {
+		zm = pb->tzonemap;
+		zoff = (BUN) ((const char *) Tloc(b, 0) - (const char *) Tloc(pb, 0)) >> b->tshift;
+	}
+	if (nthreads == 1 && zm == NULL)
+		return NULL;
+
+	tasks = GDKmalloc(nthreads * sizeof(*tasks));
+	oids = GDKmalloc(nthreads * n * sizeof(oid));
+	if (tasks == NULL || oids == NULL) {
+		/* fall back to doing it the old fashioned way */
+		GDKfree(tasks);
+		GDKfree(oids);
+		GDKclrerr();
+		return NULL;
+	}
+	slice = cnt / nthreads;
+	for (i = 0; i < nthreads; i++) {
+		tasks[i] = (struct firstn_task) {
+			.b = b,
+			.oids = oids + i * n,
+			.n = n,
+			.start = start + i * slice,
+			.end = i == nthreads - 1 ? end : start + (i + 1) * slice,
+			.zm = zm,
+			.zoff = zoff,
+			.asc = asc,
+		};
+	}
+	GDKparallel(firstn_worker, tasks, sizeof(*tasks), nthreads);
+	for (i = 0; i < nthreads; i++)
+		skipped += tasks[i].skipped;
+	GDKfree(tasks);
+	ALGODEBUG fprintf(stderr, "#BATfirstn(b=" ALGOBATFMT ",n=" BUNFMT "): "
+			  "%d slices, %s zone map, " BUNFMT " blocks skipped, "
+			  LLFMT " usec\n",
+			  ALGOBATPAR(b), n, nthreads, zm ? "using" : "no",
+			  skipped, GDKusec() - t0);
+	*np = nthreads * n;
+	return oids;
+}
+
 /* This version of BATfirstn returns a list of N oids (where N is the
  * smallest among BATcount(b), BATcount(s), and n).  The oids returned
  * refer to the N smallest/largest (depending on asc) tail values of b
@@ -143,8 +353,8 @@ BATfirstn_unique(BAT *b, BAT *s, BUN n, bool asc, oid *lastp)
 {
 	BAT *bn;
 	BATiter bi = bat_iterator(b);
-	oid *restrict oids;
-	BUN i, cnt, start, end;
+	oid *restrict oids, *slices = NULL;
+	BUN i, cnt, start, end, nslices = 0;
 	const oid *restrict cand, *candend;
 	int tpe = b->ttype;
 	int (*cmp)(const void *, const void *);
@@ -225,7 +435,14 @@ BATfirstn_unique(BAT *b, BAT *s, BUN n, bool asc, oid *lastp)
 	 * and to start off with the last n elements when doing a
 	 * firstn-descending so that most values that we look at after
 	 * this will be skipped. */
-	if (cand) {
+	if (cand == NULL &&
+	    (slices = firstn_slices(b, start, end, n, asc, &nslices)) != NULL) {
+		/* the heaps of the slices contain the first n, so
+		 * continue with them as candidate list */
+		memcpy(oids, slices, n * sizeof(oid));
+		cand = slices + n;
+		candend = slices + nslices;
+	} else if (cand) {
 		if (asc) {
 			for (i = 0; i < n; i++)
 				oids[i] = *cand++;
@@ -317,6 +534,7 @@ BATfirstn_unique(BAT *b, BAT *s, BUN n, bool asc, oid *lastp)
 			break;
 		}
 	}
+	GDKfree(slices);
 	if (lastp)
 		*lastp = oids[0]; /* store id of largest value */
 	/* output must be sorted since it's a candidate list */
@@ -10,6 +10,7 @@
 #include "gdk.h"
 #include "gdk_private.h"
 #include "gdk_cand.h"
+#include "gdk_rle.h"
 
 /* how much to extend the extent and histo bats when we run out of space */
 #define GROUPBATINCR	8192
@@ -40,7 +41,7 @@
  * is always created.  In other words, the groups argument may not be
  * NULL, but the extents and histo arguments may be NULL.
  *
- * There are six different implementations of the grouping code.
+ * There are eight different implementations of the grouping code.
  *
  * If it can be trivially determined that all groups are singletons,
  * we can produce the outputs trivially.
@@ -52,12 +53,18 @@
  * specified and b is sorted, or if the subsorted flag is set (only
  * used by BATsort), we only need to compare consecutive values.
  *
+ * If g is not specified and b (or its parent) has a run index (see
+ * gdk_rle.c), we group the runs instead of the values (see rlegroup).
+ *
  * If the input bat b is sorted, but g is not, we can compare
  * consecutive values in b and need to scan sections of g for equal
  * groups.
  *
  * If a hash table already exists on b, we can make use of it.
  *
+ * If b is large and of a 4 or 8 byte type, and g is not specified, we
+ * group in parallel using multiple threads (see pargroup).
+ *
  * Otherwise we build a partial hash table on the fly.
  *
  * A decision should be made on the order in which grouping occurs.
@@ -488,6 +495,578 @@ pop(oid x)
 	/* COMP   */	cmp(v, BUNtail(bi, hb)) == 0		\
 	)
 
+/* Parallel grouping.
+ *
+ * For large inputs of 4 or 8 byte values without pre-existing
+ * grouping, the input is divided into consecutive slices, one per
+ * thread, and each thread groups its own slice using a thread-local
+ * hash table that only contains the distinct values of the slice
+ * (the local groups).  The local groups of all slices are then
+ * merged: they are divided into partitions on the lower bits of the
+ * hash value, and each partition is processed by a thread, finding
+ * for each local group the first local group (in slice order) with
+ * the same value.  The groups are numbered in order of these first
+ * local groups, which is exactly the order in which the sequential
+ * code creates new groups, so that the outputs (groups, extents, and
+ * histo) are identical to the outputs of the sequential code. */
+
+#define GROUP_NIL	(~0U)	/* end of chain in heads/links */
+#define PARGROUP_SLICE	((BUN) 1 << 16) /* minimum rows per thread */
+
+struct pargroup {
+	const void *vals;	/* values of b (index 0 of heap) */
+	const oid *cand;	/* candidate list or NULL */
+	BUN start;		/* first position in b (no candidate list) */
+	oid seq;		/* hseqbase of b */
+	int width;		/* width of values (4 or 8) */
+	int bits;		/* number of radix bits for merge */
+	BUN nparts;		/* number of partitions (1 << bits) */
+	int nthreads;
+	/* local groups, indexed by the row number of the start of
+	 * the slice plus local group number */
+	void *lvals;		/* value of the local group */
+	oid *lfirst;		/* first row of local group, later group id */
+	BUN *lcnts;		/* size of local group */
+	oid *reps;		/* first local group with the same value */
+	unsigned int *links;	/* hash chains */
+	unsigned int *heads;	/* hash buckets */
+	/* merging */
+	BUN *counts;		/* per thread histogram/scatter offsets */
+	BUN *pstart;		/* start of each partition */
+	BUN *hstart;		/* start of hash buckets of each partition */
+	void *mvals;		/* partitioned values of local groups */
+	BUN *mrefs;		/* partitioned local groups */
+	/* output */
+	oid *ngrps;		/* groups (first holds local group) */
+	oid *exts;		/* extents or NULL */
+	lng *cnts;		/* histo or NULL */
+};
+
+enum pargroup_phase {
+	PARGROUP_LOCAL,
+	PARGROUP_HISTOGRAM,
+	PARGROUP_SCATTER,
+	PARGROUP_MERGE,
+	PARGROUP_COUNT,
+	PARGROUP_ASSIGN,
+	PARGROUP_FILL,
+};
+
+struct pargroup_task {
+	struct pargroup *pg;
+	enum pargroup_phase phase;
+	int id;
+	BUN start, end;		/* slice of rows */
+	BUN hoff, hsize;	/* slice of heads for local hash table */
+	BUN nloc;		/* number of local groups */
+	BUN ngrp;		/* number of groups that start in slice */
+	oid grp;		/* first group id in slice */
+	bool sorted;		/* group ids in slice are ascending */
+};
+
+#define PARGROUPLOCAL(TYPE, UTYPE)					\
+	do {								\
+		const TYPE *restrict vals = pg->vals;			\
+		TYPE *restrict lvals = (TYPE *) pg->lvals + t->start;	\
+		BUN mask = MIN(t->hsize, 256) - 1;			\
+		BUN nloc = 0, h, k;					\
+		unsigned int e;						\
+									\
+		memset(heads, 0xFF, (mask + 1) * sizeof(unsigned int));	\
+		for (r = t->start; r < t->end; r++) {			\
+			TYPE v = vals[pg->cand ? pg->cand[r] - pg->seq : pg->start + r]; \
+			h = (BUN) mix_##TYPE((UTYPE) v) & mask;		\
+			for (e = heads[h]; e != GROUP_NIL; e = links[e]) \
+				if (lvals[e] == v)			\
+					break;				\
+			if (e == GROUP_NIL) {				\
+				/* new local group */			\
+				if (nloc > mask && mask + 1 < t->hsize) { \
+					/* grow the hash table */	\
+					mask = 2 * mask + 1;		\
+					memset(heads, 0xFF, (mask + 1) * sizeof(unsigned int)); \
+					for (k = 0; k < nloc; k++) {	\
+						h = (BUN) mix_##TYPE((UTYPE) lvals[k]) & mask; \
+						links[k] = heads[h];	\
+						heads[h] = (unsigned int) k; \
+					}				\
+					h = (BUN) mix_##TYPE((UTYPE) v) & mask; \
+				}					\
+				e = (unsigned int) nloc++;		\
+				lvals[e] = v;				\
+				lfirst[e] = r;				\
+				lcnts[e] = 0;				\
+				links[e] = heads[h];			\
+				heads[h] = e;				\
+			}						\
+			lcnts[e]++;					\
+			ngrps[r] = e;					\
+		}							\
+		t->nloc = nloc;						\
+	} while (false)
+
+#define PARGROUPHISTOGRAM(TYPE, UTYPE)					\
+	do {								\
+		const TYPE *restrict lvals = (const TYPE *) pg->lvals + t->start; \
+		for (k = 0; k < t->nloc; k++)				\
+			cnt[(BUN) mix_##TYPE((UTYPE) lvals[k]) & pmask]++; \
+	} while (false)
+
+#define PARGROUPSCATTER(TYPE, UTYPE)					\
+	do {								\
+		const TYPE *restrict lvals = (const TYPE *) pg->lvals + t->start; \
+		TYPE *restrict mvals = pg->mvals;			\
+		for (k = 0; k < t->nloc; k++) {				\
+			TYPE v = lvals[k];				\
+			d = cnt[(BUN) mix_##TYPE((UTYPE) v) & pmask]++;	\
+			mvals[d] = v;					\
+			pg->mrefs[d] = t->start + k;			\
+		}							\
+	} while (false)
+
+#define PARGROUPMERGE(TYPE, UTYPE)					\
+	do {								\
+		const TYPE *restrict mvals = (const TYPE *) pg->mvals + pg->pstart[p]; \
+		const BUN *restrict mrefs = pg->mrefs + pg->pstart[p];	\
+		for (k = 0; k < n; k++) {				\
+			TYPE v = mvals[k];				\
+			h = ((BUN) mix_##TYPE((UTYPE) v) >> pg->bits) & mask; \
+			for (e = heads[h]; e != GROUP_NIL; e = links[e]) \
+				if (mvals[e] == v)			\
+					break;				\
+			if (e == GROUP_NIL) {				\
+				/* first occurrence of value */		\
+				reps[mrefs[k]] = mrefs[k];		\
+				links[k] = heads[h];			\
+				heads[h] = (unsigned int) k;		\
+			} else {					\
+				reps[mrefs[k]] = mrefs[e];		\
+				lcnts[mrefs[e]] += lcnts[mrefs[k]];	\
+			}						\
+		}							\
+	} while (false)
+
+static void
+pargroup_worker(void *arg)
+{
+	struct pargroup_task *t = arg;
+	struct pargroup *pg = t->pg;
+	BUN pmask = pg->nparts - 1;
+	BUN *cnt = pg->counts + t->id * pg->nparts;
+	oid *restrict lfirst = pg->lfirst + t->start;
+	BUN *restrict lcnts = pg->lcnts + t->start;
+	oid *restrict reps = pg->reps;
+	oid *restrict ngrps = pg->ngrps;
+	BUN r, k, d, p;
+
+	switch (t->phase) {
+	case PARGROUP_LOCAL: {
+		unsigned int *restrict heads = pg->heads + t->hoff;
+		unsigned int *restrict links = pg->links + t->start;
+
+		if (pg->width == 4)
+			PARGROUPLOCAL(int, unsigned int);
+		else
+			PARGROUPLOCAL(lng, ulng);
+		break;
+	}
+	case PARGROUP_HISTOGRAM:
+		if (pg->width == 4)
+			PARGROUPHISTOGRAM(int, unsigned int);
+		else
+			PARGROUPHISTOGRAM(lng, ulng);
+		break;
+	case PARGROUP_SCATTER:
+		if (pg->width == 4)
+			PARGROUPSCATTER(int, unsigned int);
+		else
+			PARGROUPSCATTER(lng, ulng);
+		break;
+	case PARGROUP_MERGE:
+		/* partitions are divided round robin over the
+		 * threads; within a partition, the local groups are
+		 * in slice order */
+		lcnts = pg->lcnts;
+		for (p = (BUN) t->id; p < pg->nparts; p += pg->nthreads) {
+			BUN n = pg->pstart[p + 1] - pg->pstart[p];
+			BUN mask = pg->hstart[p + 1] - pg->hstart[p] - 1;
+			unsigned int *restrict heads = pg->heads + pg->hstart[p];
+			unsigned int *restrict links = pg->links + pg->pstart[p];
+			unsigned int e;
+			BUN h;
+
+			memset(heads, 0xFF, (mask + 1) * sizeof(unsigned int));
+			if (pg->width == 4)
+				PARGROUPMERGE(int, unsigned int);
+			else
+				PARGROUPMERGE(lng, ulng);
+		}
+		break;
+	case PARGROUP_COUNT:
+		t->ngrp = 0;
+		for (k = 0; k < t->nloc; k++)
+			t->ngrp += reps[t->start + k] == t->start + k;
+		break;
+	case PARGROUP_ASSIGN: {
+		/* number the groups in order of their first local
+		 * group; the merged group size was collected in the
+		 * first local group */
+		oid grp = t->grp;
+
+		for (k = 0; k < t->nloc; k++) {
+			if (reps[t->start + k] != t->start + k)
+				continue;
+			if (pg->cnts)
+				pg->cnts[grp] = (lng) lcnts[k];
+			if (pg->exts)
+				pg->exts[grp] = pg->cand ? pg->cand[lfirst[k]] : pg->seq + pg->start + lfirst[k];
+			lfirst[k] = grp++;
+		}
+		break;
+	}
+	case PARGROUP_FILL:
+		/* the first local groups were numbered in the
+		 * previous phase; here we only read those */
+		for (k = 0; k < t->nloc; k++) {
+			if (reps[t->start + k] != t->start + k)
+				lfirst[k] = pg->lfirst[reps[t->start + k]];
+		}
+		t->sorted = true;
+		for (r = t->start; r < t->end; r++) {
+			ngrps[r] = lfirst[ngrps[r]];
+			if (r > t->start && ngrps[r] < ngrps[r - 1])
+				t->sorted = false;
+		}
+		break;
+	}
+}
+
+#define RLEGRPVALS(TYPE)						\
+	do {								\
+		TYPE *restrict vals = (TYPE *) Tloc(rv, 0);		\
+		for (i = 0; i < k; i++)					\
+			vals[i] = (TYPE) RLEvalue(runs, f + i);		\
+	} while (0)
+
+/* Group the values [start, end) of b using its run index rh (of
+ * which b starts at position roff) into the (allocated) groups BAT
+ * gn, and optionally the extents and histo BATs en and hn; the number
+ * of groups is returned in *ngrpp.  If b is sorted, each run is a
+ * group of its own, otherwise we group the values of the runs. */
+static gdk_return
+rlegroup(BAT *b, const Heap *rh, BUN roff, BUN start, BUN end,
+	 BAT *gn, BAT *en, BAT *hn, oid *ngrpp)
+{
+	const lng *runs = RLEruns(rh);
+	oid *restrict ngrps = (oid *) Tloc(gn, 0), *restrict exts;
+	lng *restrict cnts;
+	BUN f, l, k, i, p, e;
+	BAT *rv = NULL, *rg = NULL, *re = NULL;
+	const oid *rgrps = NULL, *rexts = NULL;
+	oid grp, ngrp;
+
+	assert(start < end);
+	/* the runs f up to and including l overlap [start, end) */
+	f = RLEfind(rh, start + roff);
+	l = RLEfind(rh, end + roff - 1);
+	k = l - f + 1;
+	if (b->tsorted || b->trevsorted) {
+		ngrp = (oid) k;
+	} else {
+		rv = COLnew(0, ATOMbasetype(b->ttype), k, TRANSIENT);
+		if (rv == NULL)
+			return GDK_FAIL;
+		switch (ATOMbasetype(b->ttype)) {
+		case TYPE_bte:
+			RLEGRPVALS(bte);
+			break;
+		case TYPE_sht:
+			RLEGRPVALS(sht);
+			break;
+		case TYPE_int:
+			RLEGRPVALS(int);
+			break;
+		case TYPE_lng:
+			RLEGRPVALS(lng);
+			break;
+		default:
+			assert(0);
+		}
+		BATsetcount(rv, k);
+		rv->tsorted = rv->trevsorted = false;
+		rv->tkey = false;
+		rv->tnil = false;
+		rv->tnonil = false;
+		if (BATgroup(&rg, &re, NULL, rv, NULL, NULL, NULL, NULL) != GDK_SUCCEED) {
+			BBPunfix(rv->batCacheid);
+			return GDK_FAIL;
+		}
+		BBPunfix(rv->batCacheid);
+		ngrp = (oid) BATcount(re);
+		if (!BATtdense(rg))
+			rgrps = (const oid *) Tloc(rg, 0);
+		if (!BATtdense(re))
+			rexts = (const oid *) Tloc(re, 0);
+	}
+	if ((en && BATcapacity(en) < ngrp && BATextend(en, ngrp) != GDK_SUCCEED) ||
+	    (hn && BATcapacity(hn) < ngrp && BATextend(hn, ngrp) != GDK_SUCCEED)) {
+		if (rg)
+			BBPunfix(rg->batCacheid);
+		if (re)
+			BBPunfix(re->batCacheid);
+		return GDK_FAIL;
+	}
+	exts = en ? (oid *) Tloc(en, 0) : NULL;
+	cnts = hn ? (lng *) Tloc(hn, 0) : NULL;
+	if (cnts && rg)
+		memset(cnts, 0, ngrp * sizeof(lng));
+	for (i = 0; i < k; i++) {
+		p = MAX(RLEstart(runs, f + i), start + roff) - roff;
+		e = MIN(RLEend(rh, runs, f + i), end + roff) - roff;
+		if (rg == NULL) {
+			grp = (oid) i;
+			if (exts)
+				exts[grp] = b->hseqbase + p;
+			if (cnts)
+				cnts[grp] = (lng) (e - p);
+		} else {
+			grp = rgrps ? rgrps[i] : rg->tseqbase + i;
+			if (cnts)
+				cnts[grp] += (lng) (e - p);
+		}
+		for (; p < e; p++)
+			ngrps[p - start] = grp;
+	}
+	if (rg) {
+		if (exts) {
+			/* the extent of a group is the first value of
+			 * the first run of the group */
+			for (grp = 0; grp < ngrp; grp++) {
+				i = rexts ? rexts[grp] : re->tseqbase + grp;
+				exts[grp] = b->hseqbase + MAX(RLEstart(runs, f + i), start + roff) - roff;
+			}
+		}
+		gn->tsorted = BATordered(rg);
+		BBPunfix(rg->batCacheid);
+		BBPunfix(re->batCacheid);
+	} else {
+		gn->tsorted = true;
+	}
+	*ngrpp = ngrp;
+	return GDK_SUCCEED;
+}
+
+/* Return the number of threads to use for grouping the cnt values of
+ * b (with basetype t) in parallel, or 0 if we shouldn't. */
+static int
+pargroup_usable(BAT *b, int t, BUN cnt)
+{
+	int nthreads = GDKnr_threads;
+
+	if (t != TYPE_int && t != TYPE_lng)
+		return 0;
+	assert(b->twidth == 4 || b->twidth == 8);
+	if ((BUN) nthreads > cnt / PARGROUP_SLICE)
+		nthreads = (int) (cnt / PARGROUP_SLICE);
+	if (nthreads <= 1 || cnt / nthreads >= (BUN) GROUP_NIL)
+		return 0;
+	return nthreads;
+}
+
+/* Group the cnt values of b indicated by start/cand using nthreads
+ * threads into the (allocated) groups BAT gn, and optionally the
+ * extents and histo BATs en and hn; the number of groups is returned
+ * in *ngrpp. */
+static gdk_return
+pargroup(BAT *b, BAT *gn, BAT *en, BAT *hn, BUN start, const oid *cand,
+	 BUN cnt, int nthreads, oid *ngrpp)
+{
+	struct pargroup pg = {0};
+	struct pargroup_task *tasks;
+	BUN n, i, p, off, nheads, maxpart, c, slice;
+	oid ngrp;
+	int j;
+
+	pg.vals = Tloc(b, 0);
+	pg.cand = cand;
+	pg.start = start;
+	pg.seq = b->hseqbase;
+	pg.width = b->twidth;
+	pg.ngrps = (oid *) Tloc(gn, 0);
+	pg.nthreads = nthreads;
+
+	tasks = GDKzalloc(nthreads * sizeof(*tasks));
+	if (tasks == NULL)
+		return GDK_FAIL;
+	slice = cnt / nthreads;
+	nheads = 0;
+	for (j = 0; j < nthreads; j++) {
+		tasks[j].pg = &pg;
+		tasks[j].id = j;
+		tasks[j].phase = PARGROUP_LOCAL;
+		tasks[j].start = j * slice;
+		tasks[j].end = j == nthreads - 1 ? cnt : (j + 1) * slice;
+		/* the local hash table grows up to a power of two
+		 * not smaller than the size of the slice */
+		for (n = 1; n < tasks[j].end - tasks[j].start; n <<= 1)
+			;
+		tasks[j].hoff = nheads;
+		tasks[j].hsize = n;
+		nheads += n;
+	}
+
+	/* phase 1: group each slice into local groups */
+	pg.lvals = GDKmalloc(cnt * pg.width);
+	pg.lfirst = GDKmalloc(cnt * sizeof(oid));
+	pg.lcnts = GDKmalloc(cnt * sizeof(BUN));
+	pg.links = GDKmalloc(cnt * sizeof(unsigned int));
+	pg.heads = GDKmalloc(nheads * sizeof(unsigned int));
+	if (pg.lvals == NULL || pg.lfirst == NULL || pg.lcnts == NULL ||
+	    pg.links == NULL || pg.heads == NULL)
+		goto bailout;
+	GDKparallel(pargroup_worker, tasks, sizeof(*tasks), nthreads);
+	GDKfree(pg.heads);
+	pg.heads = NULL;
+
+	/* choose the number of partitions for merging the local
+	 * groups such that a partition (values, references, chains,
+	 * and buckets) fits in half the L2 cache */
+	n = 0;
+	for (j = 0; j < nthreads; j++)
+		n += tasks[j].nloc;
+	c = MT_l2cachesize() / 2 / (pg.width + sizeof(BUN) + 3 * sizeof(unsigned int));
+	for (pg.bits = 1; pg.bits < 12 && (n >> pg.bits) > c; pg.bits++)
+		;
+	pg.nparts = (BUN) 1 << pg.bits;
+	pg.counts = GDKzalloc(nthreads * pg.nparts * sizeof(BUN));
+	pg.pstart = GDKmalloc((pg.nparts + 1) * sizeof(BUN));
+	pg.hstart = GDKmalloc((pg.nparts + 1) * sizeof(BUN));
+	pg.mvals = GDKmalloc(n * pg.width);
+	pg.mrefs = GDKmalloc(n * sizeof(BUN));
+	pg.reps = GDKmalloc(cnt * sizeof(oid));
+	if (pg.counts == NULL || pg.pstart == NULL || pg.hstart == NULL ||
+	    pg.mvals == NULL || pg.mrefs == NULL || pg.reps == NULL)
+		goto bailout;
+
+	/* phase 2: histogram of the local groups */
+	for (j = 0; j < nthreads; j++)
+		tasks[j].phase = PARGROUP_HISTOGRAM;
+	GDKparallel(pargroup_worker, tasks, sizeof(*tasks), nthreads);
+
+	/* turn the histograms into scatter offsets; within a
+	 * partition, the local groups of slice j come before those
+	 * of slice j + 1 */
+	off = 0;
+	maxpart = 0;
+	pg.hstart[0] = 0;
+	for (p = 0; p < pg.nparts; p++) {
+		pg.pstart[p] = off;
+		for (j = 0; j < nthreads; j++) {
+			c = pg.counts[j * pg.nparts + p];
+			pg.counts[j * pg.nparts + p] = off;
+			off += c;
+		}
+		c = off - pg.pstart[p];
+		if (c > maxpart)
+			maxpart = c;
+		/* number of buckets: power of two not smaller than
+		 * the number of values in the partition */
+		for (i = 1; i < c; i <<= 1)
+			;
+		pg.hstart[p + 1] = pg.hstart[p] + i;
+	}
+	pg.pstart[pg.nparts] = off;
+	assert(off == n);
+	if (maxpart >= (BUN) GROUP_NIL) {
+		GDKerror("BATgroup: too many groups in partition\n");
+		goto bailout;
+	}
+	pg.heads = GDKmalloc(pg.hstart[pg.nparts] * sizeof(unsigned int));
+	if (pg.heads == NULL)
+		goto bailout;
+
+	/* phase 3: scatter the local groups into the partitions */
+	for (j = 0; j < nthreads; j++)
+		tasks[j].phase = PARGROUP_SCATTER;
+	GDKparallel(pargroup_worker, tasks, sizeof(*tasks), nthreads);
+	GDKfree(pg.lvals);
+	pg.lvals = NULL;
+
+	/* phase 4: find the first local group with the same value
+	 * for each local group */
+	for (j = 0; j < nthreads; j++)
+		tasks[j].phase = PARGROUP_MERGE;
+	GDKparallel(pargroup_worker, tasks, sizeof(*tasks), nthreads);
+	GDKfree(pg.mvals);
+	GDKfree(pg.mrefs);
+	GDKfree(pg.links);
+	GDKfree(pg.heads);
+	pg.mvals = NULL;
+	pg.mrefs = NULL;
+	pg.links = pg.heads = NULL;
+
+	/* phase 5: count the groups that start in each slice */
+	for (j = 0; j < nthreads; j++)
+		tasks[j].phase = PARGROUP_COUNT;
+	GDKparallel(pargroup_worker, tasks, sizeof(*tasks), nthreads);
+	ngrp = 0;
+	for (j = 0; j < nthreads; j++) {
+		tasks[j].grp = ngrp;
+		ngrp += tasks[j].ngrp;
+	}
+
+	/* phase 6: number the groups and fill in extents and histo */
+	if (en) {
+		if (BATcapacity(en) < ngrp && BATextend(en, ngrp) != GDK_SUCCEED)
+			goto bailout;
+		pg.exts = (oid *) Tloc(en, 0);
+	}
+	if (hn) {
+		if (BATcapacity(hn) < ngrp && BATextend(hn, ngrp) != GDK_SUCCEED)
+			goto bailout;
+		pg.cnts = (lng *) Tloc(hn, 0);
+	}
+	for (j = 0; j < nthreads; j++)
+		tasks[j].phase = PARGROUP_ASSIGN;
+	GDKparallel(pargroup_worker, tasks, sizeof(*tasks), nthreads);
+
+	/* phase 7: give all rows their group id */
+	for (j = 0; j < nthreads; j++)
+		tasks[j].phase = PARGROUP_FILL;
+	GDKparallel(pargroup_worker, tasks, sizeof(*tasks), nthreads);
+	gn->tsorted = true;
+	for (j = 0; j < nthreads; j++) {
+		if (!tasks[j].sorted ||
+		    (j > 0 && pg.ngrps[tasks[j].start] < pg.ngrps[tasks[j].start - 1]))
+			gn->tsorted = false;
+	}
+
+	GDKfree(pg.lfirst);
+	GDKfree(pg.lcnts);
+	GDKfree(pg.reps);
+	GDKfree(pg.counts);
+	GDKfree(pg.pstart);
+	GDKfree(pg.hstart);
+	GDKfree(tasks);
+	*ngrpp = ngrp;
+	return GDK_SUCCEED;
+
+  bailout:
+	GDKfree(pg.lvals);
+	GDKfree(pg.lfirst);
+	GDKfree(pg.lcnts);
+	GDKfree(pg.reps);
+	GDKfree(pg.links);
+	GDKfree(pg.heads);
+	GDKfree(pg.counts);
+	GDKfree(pg.pstart);
+	GDKfree(pg.hstart);
+	GDKfree(pg.mvals);
+	GDKfree(pg.mrefs);
+	GDKfree(tasks);
+	return GDK_FAIL;
+}
+
 
 gdk_return
 BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
@@ -512,6 +1091,9 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 	const oid *restrict cand, *candend;
 	oid maxgrp = oid_nil;	/* maximum value of g BAT (if subgrouping) */
 	PROPrec *prop;
+	int nthreads;
+	const Heap *rh;
+	BUN roff;
 
 	if (b == NULL) {
 		GDKerror("BATgroup: b must exist\n");
@@ -759,7 +1341,26 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 		}
 	}
 
-	if (subsorted ||
+	if (g == NULL && cand == NULL && !subsorted &&
+	    (rh = RLEget(b, &roff)) != NULL) {
+		/* b (or its parent) has a run index: group the runs,
+		 * see rlegroup */
+		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT "[%s],"
+				  "s=%s#" BUNFMT ","
+				  "g=%s#" BUNFMT ","
+				  "e=%s#" BUNFMT ","
+				  "h=%s#" BUNFMT ",subsorted=%d): "
+				  "run index\n",
+				  BATgetId(b), BATcount(b), ATOMname(b->ttype),
+				  s ? BATgetId(s) : "NULL", s ? BATcount(s) : 0,
+				  g ? BATgetId(g) : "NULL", g ? BATcount(g) : 0,
+				  e ? BATgetId(e) : "NULL", e ? BATcount(e) : 0,
+				  h ? BATgetId(h) : "NULL", h ? BATcount(h) : 0,
+				  subsorted);
+		if (rlegroup(b, rh, roff, start, end, gn, en, hn,
+			     &ngrp) != GDK_SUCCEED)
+			goto error;
+	} else if (subsorted ||
 	    ((BATordered(b) || BATordered_rev(b)) &&
 	     (g == NULL || BATordered(g) || BATordered_rev(g)))) {
 		/* we only need to compare each entry with the previous */
@@ -1030,6 +1631,24 @@ BATgroup_internal(BAT **groups, BAT **extents, BAT **histo,
 			GRP_use_existing_hash_table_any();
 			break;
 		}
+	} else if (g == NULL && (nthreads = pargroup_usable(b, t, cnt)) > 1) {
+		/* large input without pre-existing grouping: group
+		 * in parallel, see pargroup */
+		ALGODEBUG fprintf(stderr, "#BATgroup(b=%s#" BUNFMT "[%s],"
+				  "s=%s#" BUNFMT ","
+				  "g=%s#" BUNFMT ","
+				  "e=%s#" BUNFMT ","
+				  "h=%s#" BUNFMT ",subsorted=%d): "
+				  "parallel grouping (%d threads)\n",
+				  BATgetId(b), BATcount(b), ATOMname(b->ttype),
+				  s ? BATgetId(s) : "NULL", s ? BATcount(s) : 0,
+				  g ? BATgetId(g) : "NULL", g ? BATcount(g) : 0,
+				  e ? BATgetId(e) : "NULL", e ? BATcount(e) : 0,
+				  h ? BATgetId(h) : "NULL", h ? BATcount(h) : 0,
+				  subsorted, nthreads);
+		if (pargroup(b, gn, en, hn, start, cand, cnt, nthreads,
+			     &ngrp) != GDK_SUCCEED)
+			goto error;
 	} else {
 		bool gc = g != NULL && (BATordered(g) || BATordered_rev(g));
 		const char *nme;
@@ -85,6 +85,178 @@ decompose_filename(str nme)
 	return ext;
 }
 
+/*
+ * @- Heap pool
+ * Result heaps of MAL instructions are usually freed shortly after
+ * they were created.  For large heaps, every malloc/free pair is an
+ * mmap/munmap pair in the C library, and the memory has to be faulted
+ * in (and cleared by the kernel) again and again.  Therefore we keep
+ * a pool of recently freed allocated heaps of at least
+ * HEAP_POOL_MINSIZE bytes, in power-of-two size classes, up to a
+ * total of GDK_heappool_maxsize bytes (option gdk_heappool_maxsize).
+ * When the pool is full, the least recently freed memory is given
+ * back.  Pooled memory still counts as being in use (GDKmem_cursize),
+ * so we empty the pool when memory gets tight.
+ *
+ * Smaller heaps are not pooled: the C library (glibc, at least) raises
+ * its mmap threshold up to 32MB as blocks get freed, and then recycles
+ * them itself.  Heaps are not taken from the pool when they are
+ * extended, since realloc can often grow them in place.
+ *
+ * The administration of a pooled block lives at its start.
+ */
+#define HEAP_POOL_MINSIZE	((size_t) 1 << 25)
+#define HEAP_POOL_CLASSES	(8 * SIZEOF_SIZE_T)
+
+typedef struct poolblk {
+	struct poolblk *next, *prev;   /* all blocks, most recent first */
+	struct poolblk *cnext, *cprev; /* the blocks of one size class */
+	size_t size;		       /* usable size of the block */
+} poolblk;
+
+static MT_Lock heappoollock MT_LOCK_INITIALIZER("heappoollock");
+static poolblk *poolfirst, *poollast;
+static poolblk *poolclass[HEAP_POOL_CLASSES];
+static size_t poolsize;		/* bytes in the pool */
+static lng poolhits, poolmisses;
+
+/* size class: blocks of size [2**c, 2**(c+1)) are in class c */
+static int
+HEAPpoolclass(size_t size)
+{
+	int c = 0;
+
+	while ((size >>= 1) != 0)
+		c++;
+	return c;
+}
+
+/* call with heappoollock held */
+static void
+HEAPpoolunlink(poolblk *p)
+{
+	if (p->prev)
+		p->prev->next = p->next;
+	else
+		poolfirst = p->next;
+	if (p->next)
+		p->next->prev = p->prev;
+	else
+		poollast = p->prev;
+	if (p->cprev)
+		p->cprev->cnext = p->cnext;
+	else
+		poolclass[HEAPpoolclass(p->size)] = p->cnext;
+	if (p->cnext)
+		p->cnext->cprev = p->cprev;
+	poolsize -= p->size;
+}
+
+/* find a pooled block of at least size bytes, but not more than twice
+ * that, and take it out of the pool */
+static void *
+HEAPpoolget(size_t size)
+{
+	poolblk *p, *best = NULL;
+	int c;
+
+	if (size < HEAP_POOL_MINSIZE || poolfirst == NULL)
+		return NULL;
+	c = HEAPpoolclass(size);
+	MT_lock_set(&heappoollock);
+	for (p = poolclass[c]; p; p = p->cnext)
+		if (p->size >= size && (best == NULL || p->size < best->size))
+			best = p;
+	if (best == NULL && c + 1 < HEAP_POOL_CLASSES) {
+		for (p = poolclass[c + 1]; p; p = p->cnext)
+			if (p->size / 2 <= size &&
+			    (best == NULL || p->size < best->size))
+				best = p;
+	}
+	if (best) {
+		HEAPpoolunlink(best);
+		poolhits++;
+	} else {
+		poolmisses++;
+	}
+	MT_lock_unset(&heappoollock);
+	HEAPDEBUG if (best) fprintf(stderr, "#HEAPpoolget %zu %zu %p\n", size, best->size, (void *) best);
+	return best;
+}
+
+/* put memory that was allocated with GDKmalloc into the pool, or free
+ * it if it doesn't qualify */
+static void
+HEAPpoolput(void *base)
+{
+	size_t size = GDKmallocated(base);
+	poolblk *p = base, *victims = NULL;
+
+	if (size < HEAP_POOL_MINSIZE || size > GDK_heappool_maxsize / 2) {
+		GDKfree(base);
+		return;
+	}
+	MT_lock_set(&heappoollock);
+	/* make room by evicting the least recently freed blocks */
+	while (poollast && poolsize + size > GDK_heappool_maxsize) {
+		poolblk *v = poollast;
+		HEAPpoolunlink(v);
+		v->next = victims;
+		victims = v;
+	}
+	p->size = size;
+	p->prev = NULL;
+	p->next = poolfirst;
+	if (poolfirst)
+		poolfirst->prev = p;
+	else
+		poollast = p;
+	poolfirst = p;
+	p->cprev = NULL;
+	p->cnext = poolclass[HEAPpoolclass(size)];
+	if (p->cnext)
+		p->cnext->cprev = p;
+	poolclass[HEAPpoolclass(size)] = p;
+	poolsize += size;
+	MT_lock_unset(&heappoollock);
+	while (victims) {
+		p = victims;
+		victims = p->next;
+		GDKfree(p);
+	}
+}
+
+/* give all pooled memory back */
+void
+HEAPpoolflush(void)
+{
+	poolblk *p, *victims;
+
+	if (poolfirst == NULL)
+		return;
+	MT_lock_set(&heappoollock);
+	victims = poolfirst;
+	poolfirst = poollast = NULL;
+	memset(poolclass, 0, sizeof(poolclass));
+	poolsize = 0;
+	MT_lock_unset(&heappoollock);
+	while (victims) {
+		p = victims;
+		victims = p->next;
+		GDKfree(p);
+	}
+}
+
+void
+HEAPpoolstatistics(size_t *size, lng *hits, lng *misses)
+{
+	MT_lock_set(&heappoollock);
+	*size = poolsize;
+	*hits = poolhits;
+	*misses = poolmisses;
+	MT_lock_unset(&heappoollock);
+}
+
 /*
  * @- HEAPalloc
  *
@@ -92,7 +264,28 @@ decompose_filename(str nme)
  * though, come from memory mapped files that we create with a large
  * seek. This is fast, and leads to files-with-holes on Unixes (on
  * Windows, it actually always performs I/O which is not nice).
+ *
+ * On NUMA machines, heaps of at least HEAP_NUMA_MINSIZE bytes are
+ * placed on the node of the allocating thread.
+ *
+ * If gdk_hugepages is set, allocated heaps of at least
+ * HEAP_HUGEPAGE_MINSIZE bytes are backed by transparent huge pages
+ * (where available) to reduce TLB misses in e.g. hash probes.  Memory
+ * mapped heaps are backed by files, so this doesn't apply to them.
  */
+#define HEAP_NUMA_MINSIZE	((size_t) 1 << 20)
+#define HEAP_HUGEPAGE_MINSIZE	((size_t) 1 << 22)
+
+static void
+HEAPhugepages(Heap *h)
+{
+	if (GDK_hugepages && h->storage == STORE_MEM &&
+	    h->size >= HEAP_HUGEPAGE_MINSIZE &&
+	    MT_hugepage_advise(h->base, h->size) == 0)
+		HEAPDEBUG fprintf(stderr, "#HEAPhugepages %s %zu %p\n",
+				  h->filename, h->size, h->base);
+}
+
 gdk_return
 HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 {
@@ -109,11 +302,15 @@ HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 		GDKerror("HEAPalloc: allocating more than heap can accomodate\n");
 		return GDK_FAIL;
 	}
+	/* when memory is tight, first give back pooled memory */
+	if (GDKmem_cursize() + h->size >= GDK_mem_maxsize)
+		HEAPpoolflush();
 	if (h->size < 4 * GDK_mmap_pagesize ||
 	    (GDKmem_cursize() + h->size < GDK_mem_maxsize &&
 	     h->size < (h->farmid == 0 ? GDK_mmap_minsize_persistent : GDK_mmap_minsize_transient))) {
 		h->storage = STORE_MEM;
-		h->base = (char *) GDKmalloc(h->size);
+		if ((h->base = HEAPpoolget(h->size)) == NULL)
+			h->base = (char *) GDKmalloc(h->size);
 		HEAPDEBUG fprintf(stderr, "#HEAPalloc %zu %p\n", h->size, h->base);
 	}
 	if (h->base == NULL) {
@@ -155,6 +352,16 @@ HEAPalloc(Heap *h, size_t nitems, size_t itemsize)
 		return GDK_FAIL;
 	}
 	h->newstorage = h->storage;
+	HEAPhugepages(h);
+	if (h->size >= HEAP_NUMA_MINSIZE && MT_nr_nodes() > 1) {
+		/* keep large heaps on the NUMA node of the thread
+		 * that creates (and likely fills) them */
+		int node = MT_thread_getnode();
+
+		if (node >= 0)
+			(void) MT_place_node(h->base, h->size, node, 0);
+		GDKnuma_count(h->base);
+	}
 	return GDK_SUCCEED;
 }
 
@@ -234,8 +441,10 @@ HEAPextend(Heap *h, size_t size, bool mayshare)
 			h->base = GDKrealloc(h->base, size);
 			HEAPDEBUG fprintf(stderr, "#HEAPextend: extending malloced heap %zu %zu %p %p\n", size, h->size, bak.base, h->base);
 			h->size = size;
-			if (h->base)
+			if (h->base) {
+				HEAPhugepages(h);
 				return GDK_SUCCEED; /* success */
+			}
 			/* bak.base is still valid and may get restored */
 			failure = "h->storage == STORE_MEM && !must_map && !h->base";
 		}
@@ -572,7 +781,7 @@ HEAPfree(Heap *h, bool rmheap)
 			HEAPDEBUG fprintf(stderr, "#HEAPfree %zu"
 					  " %p\n",
 					  h->size, h->base);
-			GDKfree(h->base);
+			HEAPpoolput(h->base);
 		} else if (h->storage == STORE_CMEM) {
 			//heap is stored in regular C memory rather than GDK memory,so we call free()
 			free(h->base);
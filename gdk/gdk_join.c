@@ -68,6 +68,16 @@
  * BATdiff
  *	difference: return a candidate list with OIDs of tuples in the
  *	left input whose value does not occur in the right input
+ *
+ * And there are two functions that can be used to reduce the input
+ * of a join before the join is done:
+ * BATbloom
+ *	create a Bloom filter from the values of the (small) build side
+ *	of a join
+ * BATbloomprobe
+ *	return a candidate list with OIDs of tuples in the input whose
+ *	value may occur in the input of BATbloom (i.e. a superset of
+ *	BATintersect)
  */
 
 /* Perform a bunch of sanity checks on the inputs to a join. */
@@ -2966,6 +2976,472 @@ hashjoin(BAT *r1, BAT *r2, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches,
 	return GDK_FAIL;
 }
 
+/* Radix-partitioned parallel hash join.
+ *
+ * When the right (inner) input is large, the bucket-chained hash
+ * table that hashjoin uses does not fit in the CPU caches, and just
+ * about every probe costs several cache misses.  Here we split the
+ * right input on the lower bits of the hash value into partitions
+ * that are small enough to fit in the L2 cache and build a small
+ * hash table per partition.  Partitioning, building, and probing are
+ * all done in parallel.  The left input is not partitioned, but it is
+ * probed in consecutive slices (one per thread) whose results are
+ * concatenated afterwards.  Because the partitioning is stable, the
+ * result is exactly what hashjoin would produce: r1 in the order of
+ * the left input and for each left value the matching right values
+ * in descending order of position.
+ *
+ * This is only used for types where equality is equality of the bit
+ * pattern (int and lng based types), and only for the plain equi-join
+ * (no semi join, outer join, or difference). */
+
+#define RADIX_NIL	(~0U)	/* end of chain in heads/links */
+
+struct radixjoin {
+	const void *lvals;	/* left values (index 0 of heap) */
+	const oid *lcand;	/* left candidate list or NULL */
+	oid lseq;		/* hseqbase of left */
+	const void *rvals;	/* right values (index 0 of heap) */
+	oid rseq;		/* hseqbase of right */
+	int width;		/* width of values (4 or 8) */
+	bool nil_matches;
+	int bits;		/* number of radix bits */
+	BUN nparts;		/* number of partitions (1 << bits) */
+	int nthreads;
+	BUN *counts;		/* per thread histogram/scatter offsets */
+	BUN *pstart;		/* start of each partition */
+	BUN *hstart;		/* start of hash buckets of each partition */
+	void *pvals;		/* partitioned right values */
+	oid *poids;		/* OIDs of partitioned right values */
+	unsigned int *heads;	/* bucket heads, per partition */
+	unsigned int *links;	/* bucket chains, per partition */
+};
+
+enum radixjoin_phase {
+	RADIX_HISTOGRAM,
+	RADIX_SCATTER,
+	RADIX_BUILD,
+	RADIX_PROBE,
+};
+
+struct radixjoin_task {
+	struct radixjoin *rj;
+	enum radixjoin_phase phase;
+	int id;
+	BUN start, end;		/* slice of right or left input */
+	/* results of the probe phase */
+	oid *r1, *r2;
+	BUN cnt, cap;
+	bool nonkey;		/* some left value has multiple matches */
+	bool failed;
+};
+
+#define RADIXHISTOGRAM(TYPE, UTYPE)					\
+	do {								\
+		const TYPE *restrict vals = rj->rvals;			\
+		for (i = t->start; i < t->end; i++) {			\
+			if (!rj->nil_matches && is_##TYPE##_nil(vals[i])) \
+				continue;				\
+			cnt[(BUN) mix_##TYPE((UTYPE) vals[i]) & pmask]++; \
+		}							\
+	} while (false)
+
+#define RADIXSCATTER(TYPE, UTYPE)					\
+	do {								\
+		const TYPE *restrict vals = rj->rvals;			\
+		TYPE *restrict pvals = rj->pvals;			\
+		oid *restrict poids = rj->poids;			\
+		for (i = t->start; i < t->end; i++) {			\
+			if (!rj->nil_matches && is_##TYPE##_nil(vals[i])) \
+				continue;				\
+			d = cnt[(BUN) mix_##TYPE((UTYPE) vals[i]) & pmask]++; \
+			pvals[d] = vals[i];				\
+			poids[d] = rj->rseq + i;			\
+		}							\
+	} while (false)
+
+#define RADIXBUILD(TYPE, UTYPE)						\
+	do {								\
+		const TYPE *restrict pvals = (const TYPE *) rj->pvals + rj->pstart[p]; \
+		for (i = 0; i < n; i++) {				\
+			b = ((BUN) mix_##TYPE((UTYPE) pvals[i]) >> rj->bits) & mask; \
+			links[i] = heads[b];				\
+			heads[b] = (unsigned int) i;			\
+		}							\
+	} while (false)
+
+#define RADIXPROBE(TYPE, UTYPE)						\
+	do {								\
+		const TYPE *restrict vals = rj->lvals;			\
+		const TYPE *restrict pvals = rj->pvals;			\
+		for (k = t->start; k < t->end; k++) {			\
+			TYPE v;						\
+			lo = rj->lcand ? rj->lcand[k] : rj->lseq + k;	\
+			v = vals[lo - rj->lseq];			\
+			if (!rj->nil_matches && is_##TYPE##_nil(v))	\
+				continue;				\
+			h = (BUN) mix_##TYPE((UTYPE) v);		\
+			p = h & pmask;					\
+			h = (h >> rj->bits) & (rj->hstart[p + 1] - rj->hstart[p] - 1); \
+			nr = 0;						\
+			for (e = rj->heads[rj->hstart[p] + h];		\
+			     e != RADIX_NIL;				\
+			     e = rj->links[rj->pstart[p] + e]) {	\
+				if (pvals[rj->pstart[p] + e] != v)	\
+					continue;			\
+				if (t->cnt == t->cap &&			\
+				    radixjoin_grow(t) != GDK_SUCCEED)	\
+					return;				\
+				t->r1[t->cnt] = lo;			\
+				t->r2[t->cnt] = rj->poids[rj->pstart[p] + e]; \
+				t->cnt++;				\
+				nr++;					\
+			}						\
+			if (nr > 1)					\
+				t->nonkey = true;			\
+		}							\
+	} while (false)
+
+static gdk_return
+radixjoin_grow(struct radixjoin_task *t)
+{
+	BUN cap = t->cap < 1024 ? 1024 : t->cap + (t->cap >> 1);
+	oid *r1, *r2;
+
+	if ((r1 = GDKrealloc(t->r1, cap * sizeof(oid))) == NULL) {
+		t->failed = true;
+		return GDK_FAIL;
+	}
+	t->r1 = r1;
+	if ((r2 = GDKrealloc(t->r2, cap * sizeof(oid))) == NULL) {
+		t->failed = true;
+		return GDK_FAIL;
+	}
+	t->r2 = r2;
+	t->cap = cap;
+	return GDK_SUCCEED;
+}
+
+static void
+radixjoin_worker(void *arg)
+{
+	struct radixjoin_task *t = arg;
+	struct radixjoin *rj = t->rj;
+	BUN pmask = rj->nparts - 1;
+	BUN *cnt = rj->counts + t->id * rj->nparts;
+	BUN i, d, p;
+
+	switch (t->phase) {
+	case RADIX_HISTOGRAM:
+		if (rj->width == 4)
+			RADIXHISTOGRAM(int, unsigned int);
+		else
+			RADIXHISTOGRAM(lng, ulng);
+		break;
+	case RADIX_SCATTER:
+		if (rj->width == 4)
+			RADIXSCATTER(int, unsigned int);
+		else
+			RADIXSCATTER(lng, ulng);
+		break;
+	case RADIX_BUILD:
+		/* partitions are divided round robin over the threads */
+		for (p = (BUN) t->id; p < rj->nparts; p += rj->nthreads) {
+			BUN n = rj->pstart[p + 1] - rj->pstart[p];
+			BUN mask = rj->hstart[p + 1] - rj->hstart[p] - 1;
+			unsigned int *restrict heads = rj->heads + rj->hstart[p];
+			unsigned int *restrict links = rj->links + rj->pstart[p];
+			BUN b;
+
+			memset(heads, 0xFF, (mask + 1) * sizeof(unsigned int));
+			if (rj->width == 4)
+				RADIXBUILD(int, unsigned int);
+			else
+				RADIXBUILD(lng, ulng);
+		}
+		break;
+	case RADIX_PROBE: {
+		BUN k, h, nr;
+		unsigned int e;
+		oid lo;
+
+		if (rj->width == 4)
+			RADIXPROBE(int, unsigned int);
+		else
+			RADIXPROBE(lng, ulng);
+		break;
+	}
+	}
+}
+
+/* Check whether radixjoin can and should be used for joining l with
+ * r, where r is the side on which we would otherwise build a hash
+ * table. */
+static bool
+radixjoin_usable(BAT *l, BAT *r, BAT *sr, BUN rcount)
+{
+	int t = ATOMbasetype(r->ttype);
+
+	if (GDKnr_threads <= 1 ||
+	    BATtvoid(l) || BATtvoid(r) ||
+	    (sr != NULL && !BATtdense(sr)))
+		return false;
+	if (t != TYPE_int && t != TYPE_lng && ATOMtype(r->ttype) != TYPE_oid)
+		return false;
+	/* only if the hash table (values, OIDs, and chains) does not
+	 * fit in the last level cache */
+	return rcount * (r->twidth + sizeof(oid) + 3 * sizeof(unsigned int)) > MT_l3cachesize();
+}
+
+static gdk_return
+radixjoin(BAT *r1, BAT *r2, BAT *l, BAT *r, BAT *sl, BAT *sr,
+	  bool nil_matches, BUN maxsize, lng t0, bool swapped,
+	  const char *reason)
+{
+	BUN lstart, lend, lcnt;
+	const oid *lcand, *lcandend;
+	BUN rstart, rend, rcnt;
+	const oid *rcand, *rcandend;
+	struct radixjoin rj = {0};
+	struct radixjoin_task *tasks = NULL;
+	BUN n, i, p, off, maxpart, cnt, slice;
+	int nthreads, j;
+	bool failed = false;
+
+	ALGODEBUG fprintf(stderr, "#radixjoin(l=" ALGOBATFMT ","
+			  "r=" ALGOBATFMT ",sl=" ALGOOPTBATFMT ","
+			  "sr=" ALGOOPTBATFMT ",nil_matches=%d)%s%s%s\n",
+			  ALGOBATPAR(l), ALGOBATPAR(r),
+			  ALGOOPTBATPAR(sl), ALGOOPTBATPAR(sr),
+			  nil_matches,
+			  swapped ? " swapped" : "",
+			  *reason ? " " : "", reason);
+
+	assert(ATOMtype(l->ttype) == ATOMtype(r->ttype));
+	assert(r->twidth == 4 || r->twidth == 8);
+	assert(sr == NULL || BATtdense(sr));
+
+	CANDINIT(l, sl, lstart, lend, lcnt, lcand, lcandend);
+	CANDINIT(r, sr, rstart, rend, rcnt, rcand, rcandend);
+	assert(rcand == NULL);
+	(void) rcandend;
+	lcnt = lcand ? (BUN) (lcandend - lcand) : lend - lstart;
+	rcnt = rend - rstart;
+
+	if (lcnt == 0 || rcnt == 0)
+		return nomatch(r1, r2, l, r, lstart, lend, lcand, lcandend,
+			       false, false, "radixjoin", t0);
+
+	rj.lvals = Tloc(l, 0);
+	rj.lcand = lcand;
+	rj.lseq = l->hseqbase;
+	rj.rvals = Tloc(r, 0);
+	rj.rseq = r->hseqbase;
+	rj.width = r->twidth;
+	rj.nil_matches = nil_matches;
+
+	/* choose the number of partitions such that a partition
+	 * (values, OIDs, chains, and buckets) fits in half the L2
+	 * cache, leaving room for the probing side */
+	n = MT_l2cachesize() / 2 / (rj.width + sizeof(oid) + 3 * sizeof(unsigned int));
+	for (rj.bits = 1; rj.bits < 12 && (rcnt >> rj.bits) > n; rj.bits++)
+		;
+	rj.nparts = (BUN) 1 << rj.bits;
+	nthreads = GDKnr_threads;
+	if ((BUN) nthreads > rcnt / 1024)
+		nthreads = (int) (rcnt / 1024);
+	if (nthreads < 1)
+		nthreads = 1;
+	rj.nthreads = nthreads;
+
+	tasks = GDKzalloc(nthreads * sizeof(*tasks));
+	rj.counts = GDKzalloc(nthreads * rj.nparts * sizeof(BUN));
+	rj.pstart = GDKmalloc((rj.nparts + 1) * sizeof(BUN));
+	rj.hstart = GDKmalloc((rj.nparts + 1) * sizeof(BUN));
+	if (tasks == NULL || rj.counts == NULL ||
+	    rj.pstart == NULL || rj.hstart == NULL)
+		goto bailout;
+
+	/* phase 1: histogram of the right input, per slice */
+	slice = rcnt / nthreads;
+	for (j = 0; j < nthreads; j++) {
+		tasks[j].rj = &rj;
+		tasks[j].id = j;
+		tasks[j].phase = RADIX_HISTOGRAM;
+		tasks[j].start = rstart + j * slice;
+		tasks[j].end = j == nthreads - 1 ? rend : rstart + (j + 1) * slice;
+	}
+	GDKparallel(radixjoin_worker, tasks, sizeof(*tasks), nthreads);
+
+	/* turn the histograms into scatter offsets; within a
+	 * partition, the values of slice j come before those of slice
+	 * j + 1, so the partitioning is stable */
+	off = 0;
+	maxpart = 0;
+	rj.hstart[0] = 0;
+	for (p = 0; p < rj.nparts; p++) {
+		rj.pstart[p] = off;
+		for (j = 0; j < nthreads; j++) {
+			cnt = rj.counts[j * rj.nparts + p];
+			rj.counts[j * rj.nparts + p] = off;
+			off += cnt;
+		}
+		cnt = off - rj.pstart[p];
+		if (cnt > maxpart)
+			maxpart = cnt;
+		/* number of buckets: power of two not smaller than
+		 * the number of values in the partition */
+		for (i = 1; i < cnt; i <<= 1)
+			;
+		rj.hstart[p + 1] = rj.hstart[p] + i;
+	}
+	rj.pstart[rj.nparts] = off;
+	if (maxpart >= (BUN) RADIX_NIL) {
+		/* too skewed for 32 bit chains: use a normal hash join */
+		ALGODEBUG fprintf(stderr, "#radixjoin(%s): partition too large, "
+				  "fall back to hashjoin\n", BATgetId(r));
+		GDKfree(tasks);
+		GDKfree(rj.counts);
+		GDKfree(rj.pstart);
+		GDKfree(rj.hstart);
+		return hashjoin(r1, r2, l, r, sl, sr, nil_matches, false, false,
+				false, maxsize, t0, swapped, false, reason);
+	}
+
+	/* phase 2: scatter the right input into the partitions */
+	rj.pvals = GDKmalloc((off ? off : 1) * rj.width);
+	rj.poids = GDKmalloc((off ? off : 1) * sizeof(oid));
+	rj.links = GDKmalloc((off ? off : 1) * sizeof(unsigned int));
+	rj.heads = GDKmalloc(rj.hstart[rj.nparts] * sizeof(unsigned int));
+	if (rj.pvals == NULL || rj.poids == NULL ||
+	    rj.links == NULL || rj.heads == NULL)
+		goto bailout;
+	for (j = 0; j < nthreads; j++)
+		tasks[j].phase = RADIX_SCATTER;
+	GDKparallel(radixjoin_worker, tasks, sizeof(*tasks), nthreads);
+
+	/* phase 3: build a hash table per partition */
+	for (j = 0; j < nthreads; j++)
+		tasks[j].phase = RADIX_BUILD;
+	GDKparallel(radixjoin_worker, tasks, sizeof(*tasks), nthreads);
+	GDKfree(rj.counts);
+	rj.counts = NULL;
+
+	/* phase 4: probe consecutive slices of the left input */
+	slice = lcnt / nthreads;
+	for (j = 0; j < nthreads; j++) {
+		tasks[j].phase = RADIX_PROBE;
+		tasks[j].start = j * slice;
+		tasks[j].end = j == nthreads - 1 ? lcnt : (j + 1) * slice;
+		if (lcand == NULL) {
+			tasks[j].start += lstart;
+			tasks[j].end += lstart;
+		}
+		/* start out assuming (at most) one match per value */
+		tasks[j].cap = tasks[j].end - tasks[j].start;
+		if (tasks[j].cap == 0)
+			continue;
+		tasks[j].r1 = GDKmalloc(tasks[j].cap * sizeof(oid));
+		tasks[j].r2 = GDKmalloc(tasks[j].cap * sizeof(oid));
+		if (tasks[j].r1 == NULL || tasks[j].r2 == NULL)
+			goto bailout;
+	}
+	GDKparallel(radixjoin_worker, tasks, sizeof(*tasks), nthreads);
+
+	GDKfree(rj.pvals);
+	GDKfree(rj.poids);
+	GDKfree(rj.links);
+	GDKfree(rj.heads);
+	GDKfree(rj.pstart);
+	GDKfree(rj.hstart);
+	rj.pvals = rj.poids = NULL;
+	rj.links = rj.heads = NULL;
+	rj.pstart = rj.hstart = NULL;
+
+	/* concatenate the results of the slices */
+	cnt = 0;
+	for (j = 0; j < nthreads; j++) {
+		failed |= tasks[j].failed;
+		cnt += tasks[j].cnt;
+	}
+	if (failed) {
+		GDKerror("radixjoin: cannot allocate memory for result\n");
+		goto bailout;
+	}
+	assert(cnt <= maxsize);
+	if (cnt > BATcapacity(r1) &&
+	    (BATextend(r1, cnt) != GDK_SUCCEED ||
+	     BATextend(r2, cnt) != GDK_SUCCEED))
+		goto bailout;
+	r1->tkey = true;
+	for (j = 0; j < nthreads; j++) {
+		if (tasks[j].cnt > 0) {
+			memcpy(Tloc(r1, BATcount(r1)), tasks[j].r1,
+			       tasks[j].cnt * sizeof(oid));
+			memcpy(Tloc(r2, BATcount(r2)), tasks[j].r2,
+			       tasks[j].cnt * sizeof(oid));
+			BATsetcount(r1, BATcount(r1) + tasks[j].cnt);
+			BATsetcount(r2, BATcount(r2) + tasks[j].cnt);
+		}
+		if (tasks[j].nonkey)
+			r1->tkey = false;
+		GDKfree(tasks[j].r1);
+		GDKfree(tasks[j].r2);
+	}
+	GDKfree(tasks);
+
+	/* r1 is sorted since we went through the left input in
+	 * order; the other properties are as in hashjoin */
+	r1->tsorted = true;
+	r1->trevsorted = cnt <= 1 ||
+		((const oid *) Tloc(r1, 0))[0] == ((const oid *) Tloc(r1, 0))[cnt - 1];
+	if (cnt > 0 && r1->tkey &&
+	    ((const oid *) Tloc(r1, 0))[cnt - 1] - ((const oid *) Tloc(r1, 0))[0] == cnt - 1)
+		r1->tseqbase = ((const oid *) Tloc(r1, 0))[0];
+	else
+		r1->tseqbase = oid_nil;
+	r2->tkey = l->tkey;
+	r2->tsorted = false;
+	r2->trevsorted = false;
+	r2->tseqbase = oid_nil;
+	if (cnt <= 1) {
+		r1->tsorted = true;
+		r1->trevsorted = true;
+		r1->tkey = true;
+		r2->tsorted = true;
+		r2->trevsorted = true;
+		r2->tkey = true;
+		r1->tseqbase = cnt == 0 ? 0 : ((const oid *) Tloc(r1, 0))[0];
+		r2->tseqbase = cnt == 0 ? 0 : ((const oid *) Tloc(r2, 0))[0];
+	}
+	ALGODEBUG fprintf(stderr, "#radixjoin(l=%s,r=%s)=(" ALGOBATFMT ","
+			  ALGOOPTBATFMT ") " LLFMT "us (%d threads, "
+			  BUNFMT " partitions)\n",
+			  BATgetId(l), BATgetId(r),
+			  ALGOBATPAR(r1), ALGOOPTBATPAR(r2),
+			  GDKusec() - t0, nthreads, rj.nparts);
+	return GDK_SUCCEED;
+
+  bailout:
+	if (tasks) {
+		for (j = 0; j < nthreads; j++) {
+			GDKfree(tasks[j].r1);
+			GDKfree(tasks[j].r2);
+		}
+		GDKfree(tasks);
+	}
+	GDKfree(rj.counts);
+	GDKfree(rj.pstart);
+	GDKfree(rj.hstart);
+	GDKfree(rj.pvals);
+	GDKfree(rj.poids);
+	GDKfree(rj.links);
+	GDKfree(rj.heads);
+	BBPreclaim(r1);
+	BBPreclaim(r2);
+	return GDK_FAIL;
+}
+
 #define MASK_EQ		1
 #define MASK_LT		2
 #define MASK_GT		4
@@ -3763,6 +4239,351 @@ BATdiff(BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, BUN estimate)
 	return NULL;
 }
 
+/* A Bloom filter is a BAT of type lng.  The first BLOOMOFF values are
+ * a header: the storage type of the values that were added (TYPE_void
+ * if the type is not supported, in which case all values pass the
+ * filter), the mask that is applied to a hash value to get to the
+ * index of a bit word, and the number of values that were added.  The
+ * header is followed by mask+1 words of bits.  The filter is blocked:
+ * all bits for a single value are set in the same word, so that a
+ * probe only costs a single cache miss.  With BLOOM_BITS bits per
+ * value the false positive rate is about one percent. */
+#define BLOOMOFF	3
+#define BLOOM_BITS	16
+#define BLOOM_SAMPLE	((BUN) 1 << 16)
+
+static inline ulng
+bloomhash(ulng v)
+{
+	/* finalizer of MurmurHash3 */
+	v ^= v >> 33;
+	v *= UINT64_C(0xff51afd7ed558ccd);
+	v ^= v >> 33;
+	v *= UINT64_C(0xc4ceb9fe1a85ec53);
+	v ^= v >> 33;
+	return v;
+}
+
+#define BLOOMWORD(h, mask)	(((h) >> 18) & (mask))
+#define BLOOMBITS(h)					\
+	(((ulng) 1 << ((h) & 63)) |			\
+	 ((ulng) 1 << (((h) >> 6) & 63)) |		\
+	 ((ulng) 1 << (((h) >> 12) & 63)))
+
+/* the value that is hashed, equal values (as far as joins are
+ * concerned) must result in equal keys */
+#define BLOOMKEY_int(v)	((ulng) (lng) (v))
+#define BLOOMKEY_flt(v)	((v) == 0 ? 0 : (ulng) ((union { flt f; unsigned int i; }) {.f = (v)}).i)
+#define BLOOMKEY_dbl(v)	((v) == 0 ? 0 : ((union { dbl f; ulng i; }) {.f = (v)}).i)
+#ifdef HAVE_HGE
+#define BLOOMKEY_hge(v)	((ulng) (v) ^ ((ulng) ((v) >> 64) * UINT64_C(0x9e3779b97f4a7c15)))
+#endif
+
+static int
+bloomtype(int tpe)
+{
+	switch (ATOMstorage(tpe)) {
+	case TYPE_void:
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+	case TYPE_str:
+		return ATOMstorage(tpe);
+	case TYPE_oid:
+#if SIZEOF_OID == SIZEOF_INT
+		return TYPE_int;
+#else
+		return TYPE_lng;
+#endif
+	default:
+		return TYPE_void;
+	}
+}
+
+#define BLOOMADD(TYPE, KEY)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		TYPE v;							\
+		if (cand) {						\
+			for (; cand < candend; cand++) {		\
+				v = vals[*cand - b->hseqbase];		\
+				if (is_##TYPE##_nil(v))			\
+					continue;			\
+				h = bloomhash(KEY(v));			\
+				bits[BLOOMWORD(h, mask)] |= BLOOMBITS(h); \
+				nvals++;				\
+			}						\
+		} else {						\
+			for (; start < end; start++) {			\
+				v = vals[start];			\
+				if (is_##TYPE##_nil(v))			\
+					continue;			\
+				h = bloomhash(KEY(v));			\
+				bits[BLOOMWORD(h, mask)] |= BLOOMBITS(h); \
+				nvals++;				\
+			}						\
+		}							\
+	} while (0)
+
+/* Create a Bloom filter with all values of b that are in the
+ * candidate list s.  Nil values are not added since they never match
+ * in a join. */
+BAT *
+BATbloom(BAT *b, BAT *s)
+{
+	BAT *bn;
+	BUN start, end, cnt;
+	const oid *restrict cand, *candend;
+	BUN nwords, mask, nvals = 0;
+	ulng *restrict bits, h;
+	int tpe;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+
+	BATcheck(b, "BATbloom", NULL);
+	tpe = bloomtype(b->ttype);
+	CANDINIT(b, s, start, end, cnt, cand, candend);
+	if (b->ttype == TYPE_void && is_oid_nil(b->tseqbase)) {
+		/* all nil: nothing is added, but the filter is for
+		 * oids */
+		tpe = bloomtype(TYPE_oid);
+	}
+	if (tpe == TYPE_void || cnt == 0) {
+		nwords = 1;
+	} else {
+		for (nwords = 1; nwords * 64 < cnt * BLOOM_BITS; nwords <<= 1)
+			;
+	}
+	mask = nwords - 1;
+	bn = COLnew(0, TYPE_lng, BLOOMOFF + nwords, TRANSIENT);
+	if (bn == NULL)
+		return NULL;
+	bits = (ulng *) Tloc(bn, 0) + BLOOMOFF;
+	memset(bits, 0, nwords * sizeof(ulng));
+
+	switch (b->ttype == TYPE_void ? TYPE_void : tpe) {
+	case TYPE_bte:
+		BLOOMADD(bte, BLOOMKEY_int);
+		break;
+	case TYPE_sht:
+		BLOOMADD(sht, BLOOMKEY_int);
+		break;
+	case TYPE_int:
+		BLOOMADD(int, BLOOMKEY_int);
+		break;
+	case TYPE_lng:
+		BLOOMADD(lng, BLOOMKEY_int);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		BLOOMADD(hge, BLOOMKEY_hge);
+		break;
+#endif
+	case TYPE_flt:
+		BLOOMADD(flt, BLOOMKEY_flt);
+		break;
+	case TYPE_dbl:
+		BLOOMADD(dbl, BLOOMKEY_dbl);
+		break;
+	case TYPE_str: {
+		BATiter bi = bat_iterator(b);
+		const char *v;
+
+		for (;;) {
+			BUN p;
+
+			if (cand) {
+				if (cand == candend)
+					break;
+				p = *cand++ - b->hseqbase;
+			} else {
+				if (start == end)
+					break;
+				p = start++;
+			}
+			v = BUNtvar(bi, p);
+			if (strNil(v))
+				continue;
+			h = bloomhash((ulng) strHash(v));
+			bits[BLOOMWORD(h, mask)] |= BLOOMBITS(h);
+			nvals++;
+		}
+		break;
+	}
+	default:
+		/* nil void column or unsupported type: all values
+		 * pass the filter, or no values if the column is all
+		 * nil */
+		break;
+	}
+
+	((lng *) Tloc(bn, 0))[0] = tpe;
+	((lng *) Tloc(bn, 0))[1] = (lng) mask;
+	((lng *) Tloc(bn, 0))[2] = (lng) nvals;
+	BATsetcount(bn, BLOOMOFF + nwords);
+	bn->tsorted = bn->trevsorted = false;
+	bn->tkey = false;
+	bn->tnil = false;
+	bn->tnonil = false;
+
+	ALGODEBUG fprintf(stderr, "#BATbloom(b=" ALGOBATFMT ",s=" ALGOOPTBATFMT
+			  ")=" ALGOBATFMT ": %s, " BUNFMT " values, " BUNFMT
+			  " words (" LLFMT " usec)\n",
+			  ALGOBATPAR(b), ALGOOPTBATPAR(s), ALGOBATPAR(bn),
+			  ATOMname(tpe), nvals, nwords, GDKusec() - t0);
+	return bn;
+}
+
+#define BLOOMPROBE(TYPE, KEY)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		for (p = lo; p < hi; p++) {				\
+			TYPE v = vals[p];				\
+			h = bloomhash(KEY(v));				\
+			w = BLOOMBITS(h);				\
+			o[n] = p + b->hseqbase;				\
+			n += ((bits[BLOOMWORD(h, mask)] & w) == w) &	\
+				!is_##TYPE##_nil(v);			\
+		}							\
+	} while (0)
+
+/* Return a candidate list with all rows of b whose value may occur in
+ * the input of the Bloom filter f.  If after a sample of the input it
+ * turns out that hardly any values are filtered out, we give up and
+ * return all rows. */
+BAT *
+BATbloomprobe(BAT *b, BAT *f)
+{
+	BAT *bn;
+	const lng *hdr;
+	const ulng *restrict bits;
+	ulng h, w;
+	BUN mask, cnt, lo, hi, p, n = 0;
+	oid *restrict o;
+	int tpe;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+
+	BATcheck(b, "BATbloomprobe", NULL);
+	BATcheck(f, "BATbloomprobe", NULL);
+	if (f->ttype != TYPE_lng || BATcount(f) <= BLOOMOFF) {
+		GDKerror("BATbloomprobe: second argument must be a Bloom filter.\n");
+		return NULL;
+	}
+	hdr = (const lng *) Tloc(f, 0);
+	bits = (const ulng *) hdr + BLOOMOFF;
+	mask = (BUN) hdr[1];
+	if (mask + 1 + BLOOMOFF != BATcount(f)) {
+		GDKerror("BATbloomprobe: second argument must be a Bloom filter.\n");
+		return NULL;
+	}
+	cnt = BATcount(b);
+	if (b->ttype == TYPE_void && is_oid_nil(b->tseqbase)) {
+		/* all nil probe side */
+		return BATdense(0, 0, 0);
+	}
+	if (hdr[0] == TYPE_void || b->ttype == TYPE_void) {
+		/* nothing we can filter */
+		ALGODEBUG fprintf(stderr, "#BATbloomprobe(b=" ALGOBATFMT
+				  ",f=" ALGOBATFMT "): no filtering\n",
+				  ALGOBATPAR(b), ALGOBATPAR(f));
+		return BATdense(0, b->hseqbase, cnt);
+	}
+	if (hdr[2] == 0) {
+		/* empty build side */
+		return BATdense(0, 0, 0);
+	}
+	tpe = bloomtype(b->ttype);
+	if (hdr[0] != tpe) {
+		GDKerror("BATbloomprobe: Bloom filter is for a different type.\n");
+		return NULL;
+	}
+
+	bn = COLnew(0, TYPE_oid, cnt, TRANSIENT);
+	if (bn == NULL)
+		return NULL;
+	o = (oid *) Tloc(bn, 0);
+	for (lo = 0; lo < cnt; lo = hi) {
+		/* the first time around we probe a sample, after that
+		 * the rest */
+		hi = lo == 0 ? MIN(cnt, BLOOM_SAMPLE) : cnt;
+		switch (tpe) {
+		case TYPE_bte:
+			BLOOMPROBE(bte, BLOOMKEY_int);
+			break;
+		case TYPE_sht:
+			BLOOMPROBE(sht, BLOOMKEY_int);
+			break;
+		case TYPE_int:
+			BLOOMPROBE(int, BLOOMKEY_int);
+			break;
+		case TYPE_lng:
+			BLOOMPROBE(lng, BLOOMKEY_int);
+			break;
+#ifdef HAVE_HGE
+		case TYPE_hge:
+			BLOOMPROBE(hge, BLOOMKEY_hge);
+			break;
+#endif
+		case TYPE_flt:
+			BLOOMPROBE(flt, BLOOMKEY_flt);
+			break;
+		case TYPE_dbl:
+			BLOOMPROBE(dbl, BLOOMKEY_dbl);
+			break;
+		case TYPE_str: {
+			BATiter bi = bat_iterator(b);
+
+			for (p = lo; p < hi; p++) {
+				const char *v = BUNtvar(bi, p);
+
+				if (strNil(v))
+					continue;
+				h = bloomhash((ulng) strHash(v));
+				w = BLOOMBITS(h);
+				if ((bits[BLOOMWORD(h, mask)] & w) == w)
+					o[n++] = p + b->hseqbase;
+			}
+			break;
+		}
+		default:
+			assert(0);
+		}
+		if (lo == 0 && hi < cnt && n > hi / 4 * 3) {
+			/* not worth it */
+			BBPreclaim(bn);
+			ALGODEBUG fprintf(stderr, "#BATbloomprobe(b=" ALGOBATFMT
+					  ",f=" ALGOBATFMT "): " BUNFMT " of " BUNFMT
+					  " pass, no filtering (" LLFMT " usec)\n",
+					  ALGOBATPAR(b), ALGOBATPAR(f), n, hi,
+					  GDKusec() - t0);
+			return BATdense(0, b->hseqbase, cnt);
+		}
+	}
+	BATsetcount(bn, n);
+	bn->tsorted = true;
+	bn->trevsorted = n <= 1;
+	bn->tkey = true;
+	bn->tnil = false;
+	bn->tnonil = true;
+	bn->tseqbase = n == 0 ? 0 : n == 1 ? o[0] : oid_nil;
+	bn = virtualize(bn);
+
+	ALGODEBUG fprintf(stderr, "#BATbloomprobe(b=" ALGOBATFMT ",f=" ALGOBATFMT
+			  ")=" ALGOBATFMT " (" LLFMT " usec)\n",
+			  ALGOBATPAR(b), ALGOBATPAR(f), ALGOBATPAR(bn),
+			  GDKusec() - t0);
+	return bn;
+}
+
 gdk_return
 BATthetajoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, int op, bool nil_matches, BUN estimate)
 {
@@ -3810,6 +4631,81 @@ BATthetajoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, int op, boo
 	return thetajoin(r1, r2, l, r, sl, sr, opcode, maxsize, t0);
 }
 
+/* Join two string columns whose heaps are both fully double
+ * eliminated (see BATdictusable).  The offsets in the right column
+ * are then unique codes for the strings, so we translate the left
+ * column to those codes by looking up each distinct left string once
+ * in the right heap, after which we join the two columns of codes
+ * instead of the strings. */
+static gdk_return
+dictjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr,
+	 bool nil_matches, BUN estimate, lng t0)
+{
+	Heap *lh = l->tvheap, *rh = r->tvheap;
+	var_t *codes, rnil;
+	int *map, *restrict dst;
+	BAT *lc, *rc;
+	BUN i, n;
+	gdk_return ret;
+
+	assert(sl == NULL && sr == NULL);
+	if ((codes = strDictionary(lh, &n)) == NULL)
+		return GDK_FAIL;
+	if ((map = GDKmalloc((lh->free / GDK_VARALIGN + 1) * sizeof(int))) == NULL) {
+		GDKfree(codes);
+		return GDK_FAIL;
+	}
+	for (i = 0; i < n; i++) {
+		const char *v = lh->base + codes[i];
+		var_t o;
+
+		if (strNil(v))
+			o = (var_t) int_nil;
+		else if ((o = strLocate(rh, v)) == 0)
+			o = (var_t) -1; /* doesn't occur in r */
+		map[codes[i] / GDK_VARALIGN] = (int) o;
+	}
+	GDKfree(codes);
+	rnil = strLocate(rh, str_nil);
+
+	lc = COLnew(l->hseqbase, TYPE_int, BATcount(l), TRANSIENT);
+	rc = COLnew(r->hseqbase, TYPE_int, BATcount(r), TRANSIENT);
+	if (lc == NULL || rc == NULL) {
+		GDKfree(map);
+		BBPreclaim(lc);
+		BBPreclaim(rc);
+		return GDK_FAIL;
+	}
+	dst = (int *) Tloc(lc, 0);
+	for (i = 0; i < BATcount(l); i++)
+		dst[i] = map[VarHeapVal(Tloc(l, 0), i, l->twidth) / GDK_VARALIGN];
+	GDKfree(map);
+	dst = (int *) Tloc(rc, 0);
+	for (i = 0; i < BATcount(r); i++) {
+		var_t o = VarHeapVal(Tloc(r, 0), i, r->twidth);
+		dst[i] = o == rnil ? int_nil : (int) o;
+	}
+	BATsetcount(lc, BATcount(l));
+	BATsetcount(rc, BATcount(r));
+	lc->tsorted = lc->trevsorted = BATcount(lc) <= 1;
+	rc->tsorted = rc->trevsorted = BATcount(rc) <= 1;
+	lc->tkey = BATcount(lc) <= 1;
+	rc->tkey = r->tkey;
+	lc->tnil = rc->tnil = false;
+	lc->tnonil = l->tnonil;
+	rc->tnonil = r->tnonil;
+
+	ALGODEBUG fprintf(stderr, "#dictjoin(l=" ALGOBATFMT ","
+			  "r=" ALGOBATFMT ") translated to codes "
+			  LLFMT "us\n",
+			  ALGOBATPAR(l), ALGOBATPAR(r), GDKusec() - t0);
+
+	ret = BATjoin(r1p, r2p, lc, rc, NULL, NULL, nil_matches, estimate);
+	BBPunfix(lc->batCacheid);
+	BBPunfix(rc->batCacheid);
+	return ret;
+}
+
 gdk_return
 BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches, BUN estimate)
 {
@@ -3934,6 +4830,15 @@ BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches
 		rslots = ((size_t *) r->thash->heap.base)[5];
 		rhash = BATcount(r) / rslots * rcount < lcount + rcount;
 	}
+	if (!lhash && !rhash && sl == NULL && sr == NULL &&
+	    ATOMstorage(l->ttype) == TYPE_str &&
+	    BATdictusable(l, lcount) && BATdictusable(r, rcount)) {
+		/* join codes instead of strings */
+		BBPreclaim(r1);
+		BBPreclaim(r2);
+		*r1p = *r2p = NULL;
+		return dictjoin(r1p, r2p, l, r, sl, sr, nil_matches, estimate, t0);
+	}
 	if (lhash && rhash) {
 		if (lcount == lslots && rcount == rslots) {
 			/* both perfect hashes, smallest on right */
@@ -3986,9 +4891,17 @@ BATjoin(BAT **r1p, BAT **r2p, BAT *l, BAT *r, BAT *sl, BAT *sr, bool nil_matches
 		reason = "left is smaller";
 	}
 	if (swap) {
+		/* without a hash table to reuse, a large inner
+		 * input is better served by a partitioned join */
+		if (!lhash && radixjoin_usable(r, l, sl, lcount))
+			return radixjoin(r2, r1, r, l, sr, sl, nil_matches,
+					 maxsize, t0, true, reason);
 		return hashjoin(r2, r1, r, l, sr, sl, nil_matches, false, false,
 				false, maxsize, t0, true, plhash, reason);
 	} else {
+		if (!rhash && radixjoin_usable(l, r, sr, rcount))
+			return radixjoin(r1, r2, l, r, sl, sr, nil_matches,
+					 maxsize, t0, false, reason);
 		return hashjoin(r1, r2, l, r, sl, sr, nil_matches, false, false,
 				false, maxsize, t0, false, prhash, reason);
 	}
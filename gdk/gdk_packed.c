@@ -0,0 +1,615 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/* Packed integer columns.
+ *
+ * The packed copy of an integer column divides the column into blocks
+ * of PACKED_BLOCK values and stores for each block the smallest
+ * non-nil value (the frame of reference) and, for each value, the
+ * difference with the frame of reference in as few bits as are
+ * needed for the largest difference in the block (see
+ * gdk_packed.h).  Values that span a small range within a block
+ * (identifiers within a partition, counters, timestamps within a day)
+ * thus take a fraction of the space of the column itself.
+ *
+ * The select, sum and project kernels decode the packed copy instead
+ * of reading the column, so that they need to read only a fraction of
+ * the memory (or, for columns that are memory mapped, of the disk).
+ * The bounds of a select are translated to bounds on the codes of a
+ * block, so blocks can also be skipped or accepted as a whole.
+ *
+ * A packed copy is created automatically when a persistent BAT of at
+ * least PACKED_MINSIZE values is saved (i.e. when it is committed),
+ * if a sample of its blocks shows that the packed copy will be at
+ * most half the size of the column.  Like zone maps, the packed copy
+ * is maintained when values are appended (only the last block and
+ * any new blocks are affected) and destroyed on any other change.
+ * The packed copy is stored in a heap next to the tail heap
+ * (extension tpacked). */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_packed.h"
+
+/* whether columns of type tpe can be packed */
+bool
+PACKtype(int tpe)
+{
+	switch (ATOMbasetype(tpe)) {
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* number of bits needed to represent v */
+static unsigned int
+pkbits(ulng v)
+{
+	unsigned int w = 0;
+
+	while (v != 0) {
+		w++;
+		v >>= 1;
+	}
+	return w;
+}
+
+#define PKRANGE(TYPE)							\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		TYPE mn = GDK_##TYPE##_max, mx = GDK_##TYPE##_min;	\
+		for (i = from; i < end; i++) {				\
+			if (is_##TYPE##_nil(vals[i])) {			\
+				nils = true;				\
+			} else {					\
+				if (vals[i] < mn)			\
+					mn = vals[i];			\
+				if (vals[i] > mx)			\
+					mx = vals[i];			\
+			}						\
+		}							\
+		if (mn <= mx) {						\
+			*base = (lng) mn;				\
+			range = (ulng) (lng) mx - (ulng) (lng) mn;	\
+		}							\
+	} while (0)
+
+/* calculate the frame of reference, the code width, and whether there
+ * are nils for the values [from, end) of b */
+static void
+pkrange(BAT *b, BUN from, BUN end, lng *base, unsigned int *w, bool *hasnil)
+{
+	BUN i;
+	ulng range = 0;
+	bool nils = false;
+
+	*base = 0;
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_sht:
+		PKRANGE(sht);
+		break;
+	case TYPE_int:
+		PKRANGE(int);
+		break;
+	case TYPE_lng:
+		PKRANGE(lng);
+		break;
+	default:
+		assert(0);
+	}
+	/* nil gets the largest code; range can't be all ones since
+	 * the smallest value is larger than nil */
+	*w = pkbits(range + nils);
+	*hasnil = nils;
+}
+
+#define PKENCODE(TYPE)							\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		for (i = from, bit = 0; i < end; i++, bit += w) {	\
+			c = is_##TYPE##_nil(vals[i]) ? nilc :		\
+				(ulng) (lng) vals[i] - (ulng) base;	\
+			d[bit / 64] |= c << (bit % 64);			\
+			if (bit % 64 + w > 64)				\
+				d[bit / 64 + 1] |= c >> (64 - bit % 64); \
+		}							\
+	} while (0)
+
+/* store the codes of the values [from, end) of b in d, which must
+ * have been cleared */
+static void
+pkencode(BAT *b, BUN from, BUN end, lng base, unsigned int w, ulng *restrict d)
+{
+	BUN i;
+	size_t bit;
+	ulng c, nilc = PKmask(w);
+
+	if (w == 0)
+		return;
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_sht:
+		PKENCODE(sht);
+		break;
+	case TYPE_int:
+		PKENCODE(int);
+		break;
+	case TYPE_lng:
+		PKENCODE(lng);
+		break;
+	default:
+		assert(0);
+	}
+}
+
+/* Decoding 64 codes of a constant width W at a time: the 64 codes
+ * occupy exactly W ulngs, and all shifts are constants. */
+#define PKX(j, W)	c[j] = PKextract(d, (j) * (W), mw)
+#define PKX8(j, W)							\
+	PKX(j, W); PKX(j + 1, W); PKX(j + 2, W); PKX(j + 3, W);		\
+	PKX(j + 4, W); PKX(j + 5, W); PKX(j + 6, W); PKX(j + 7, W)
+#define PKUNPACK(W)							\
+	case W:								\
+		for (; n >= 64; n -= 64, d += W, c += 64) {		\
+			const ulng mw = PKmask(W);			\
+			PKX8(0, W); PKX8(8, W); PKX8(16, W); PKX8(24, W); \
+			PKX8(32, W); PKX8(40, W); PKX8(48, W); PKX8(56, W); \
+		}							\
+		break
+
+/* store the n codes starting at position i of the codes d of w bits
+ * each in c */
+void
+PACKdecode(const ulng *restrict d, BUN i, BUN n, unsigned int w, ulng *restrict c)
+{
+	ulng m = PKmask(w);
+	size_t bit;
+	BUN k;
+
+	/* codes up to a multiple of 64, i.e. up to a ulng boundary */
+	for (bit = (size_t) i * w, k = MIN(n, (64 - i % 64) % 64);
+	     k > 0; k--, n--, bit += w)
+		*c++ = PKextract(d, bit, m);
+	d += bit / 64;
+	switch (w) {
+	case 0:
+		memset(c, 0, n * sizeof(ulng));
+		return;
+	PKUNPACK(1); PKUNPACK(2); PKUNPACK(3); PKUNPACK(4);
+	PKUNPACK(5); PKUNPACK(6); PKUNPACK(7); PKUNPACK(8);
+	PKUNPACK(9); PKUNPACK(10); PKUNPACK(11); PKUNPACK(12);
+	PKUNPACK(13); PKUNPACK(14); PKUNPACK(15); PKUNPACK(16);
+	PKUNPACK(17); PKUNPACK(18); PKUNPACK(19); PKUNPACK(20);
+	PKUNPACK(21); PKUNPACK(22); PKUNPACK(23); PKUNPACK(24);
+	PKUNPACK(25); PKUNPACK(26); PKUNPACK(27); PKUNPACK(28);
+	PKUNPACK(29); PKUNPACK(30); PKUNPACK(31); PKUNPACK(32);
+	default:
+		break;
+	}
+	/* the remaining codes (all of them if w > 32) */
+	for (bit = 0; n > 0; n--, bit += w)
+		*c++ = PKextract(d, bit, m);
+}
+
+/* add the values of b that are not yet covered by the packed heap
+ * hp; the last block, which may be partially covered, is encoded
+ * anew */
+static gdk_return
+PKfold(BAT *b, Heap *hp)
+{
+	oid *hdr = (oid *) hp->base;
+	BUN cnt = BATcount(b), blk, nblk, from, end;
+	size_t cap = (size_t) hdr[4], pos, words, need;
+	ulng *dir;
+	lng base;
+	unsigned int w;
+	bool hasnil;
+
+	assert((BUN) hdr[1] <= cnt);
+	assert(hdr[3] == (oid) PACKED_BLOCK);
+	blk = (BUN) hdr[1] / PACKED_BLOCK;
+	nblk = (cnt + PACKED_BLOCK - 1) / PACKED_BLOCK;
+	pos = blk < (BUN) hdr[2] ? PKoffset(PKdir(hp), blk) : (size_t) hdr[5];
+	if (nblk > cap) {
+		/* make room in the directory by moving the codes */
+		size_t ncap = MAX(nblk, 2 * cap);
+
+		if (HEAPextend(hp, PKsize(ncap, pos), false) != GDK_SUCCEED)
+			return GDK_FAIL;
+		memmove(PKdir(hp) + 2 * ncap, PKdir(hp) + 2 * cap,
+			pos * sizeof(ulng));
+		hdr = (oid *) hp->base;
+		hdr[4] = (oid) ncap;
+		cap = ncap;
+		hp->free = PKsize(cap, pos);
+	}
+	for (; blk < nblk; blk++) {
+		from = blk * PACKED_BLOCK;
+		end = MIN(cnt, from + PACKED_BLOCK);
+		pkrange(b, from, end, &base, &w, &hasnil);
+		words = PKwords(end - from, w);
+		need = PKsize(cap, pos + words);
+		if (need > hp->size &&
+		    HEAPextend(hp, MAX(need, hp->size + hp->size / 2), false) != GDK_SUCCEED)
+			return GDK_FAIL;
+		dir = PKdir(hp);
+		dir[2 * blk] = (ulng) base;
+		dir[2 * blk + 1] = (ulng) pos << 8 | (ulng) hasnil << 7 | w;
+		memset(dir + 2 * cap + pos, 0, (words + 1) * sizeof(ulng));
+		pkencode(b, from, end, base, w, dir + 2 * cap + pos);
+		pos += words;
+		/* HEAPextend only preserves the used part of the heap */
+		hp->free = PKsize(cap, pos);
+	}
+	hdr = (oid *) hp->base;
+	hdr[1] = (oid) cnt;
+	hdr[2] = (oid) nblk;
+	hdr[5] = (oid) pos;
+	hp->dirty = true;
+	return GDK_SUCCEED;
+}
+
+/* return whether a sample of the blocks of b indicates that the
+ * packed copy of b will be at most half the size of b */
+static bool
+PKworthwhile(BAT *b)
+{
+	BUN nblk = (BATcount(b) + PACKED_BLOCK - 1) / PACKED_BLOCK;
+	BUN step = nblk > 64 ? nblk / 64 : 1, blk, n = 0;
+	size_t bits = 0;
+	lng base;
+	unsigned int w;
+	bool hasnil;
+
+	for (blk = 0; blk < nblk; blk += step) {
+		BUN end = MIN(BATcount(b), (blk + 1) * PACKED_BLOCK);
+
+		pkrange(b, blk * PACKED_BLOCK, end, &base, &w, &hasnil);
+		bits += (size_t) (end - blk * PACKED_BLOCK) * w;
+		n += end - blk * PACKED_BLOCK;
+	}
+	return bits * 2 <= (size_t) n * b->twidth * 8;
+}
+
+/* return TRUE if we have a packed copy of the tail, even if we need
+ * to read one from disk; the packed copy covers all values of b */
+bool
+BATcheckpacked(BAT *b)
+{
+	bool ret;
+	Heap *hp;
+	lng t = 0;
+
+	if (b == NULL)
+		return false;
+	assert(b->batCacheid > 0);
+	ALGODEBUG t = GDKusec();
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->tpacked == (Heap *) 1) {
+		const char *nme = BBP_physical(b->batCacheid);
+		int fd;
+
+		b->tpacked = NULL;
+		if ((hp = GDKzalloc(sizeof(*hp))) != NULL &&
+		    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, packedheap)) >= 0) {
+			snprintf(hp->filename, sizeof(hp->filename), "%s.tpacked", nme);
+
+			/* check whether a persisted packed copy can
+			 * be found */
+			if ((fd = GDKfdlocate(hp->farmid, nme, "rb+", "tpacked")) >= 0) {
+				struct stat st;
+				oid hdata[PACKEDOFF];
+
+				if (read(fd, hdata, sizeof(hdata)) == sizeof(hdata) &&
+				    hdata[0] == (((oid) 1 << 24) | PACKED_VERSION) &&
+				    hdata[1] <= (oid) BATcount(b) &&
+				    hdata[3] == (oid) PACKED_BLOCK &&
+				    hdata[2] == (hdata[1] + hdata[3] - 1) / hdata[3] &&
+				    hdata[4] >= hdata[2] &&
+				    fstat(fd, &st) == 0 &&
+				    st.st_size >= (off_t) (hp->size = hp->free = PKsize(hdata[4], hdata[5])) &&
+				    HEAPload(hp, nme, "tpacked", false) == GDK_SUCCEED) {
+					close(fd);
+					if (hdata[1] == (oid) BATcount(b) ||
+					    PKfold(b, hp) == GDK_SUCCEED) {
+						b->tpacked = hp;
+						ALGODEBUG fprintf(stderr, "#BATcheckpacked(" ALGOBATFMT "): reusing persisted packed heap\n", ALGOBATPAR(b));
+						MT_lock_unset(&GDKhashLock(b->batCacheid));
+						return true;
+					}
+					HEAPfree(hp, false);
+				} else {
+					close(fd);
+				}
+				/* unlink unusable file */
+				GDKunlink(hp->farmid, BATDIR, nme, "tpacked");
+			}
+		}
+		GDKfree(hp);
+		GDKclrerr();	/* we're not currently interested in errors */
+	}
+	if ((hp = b->tpacked) != NULL &&
+	    ((oid *) hp->base)[1] < (oid) BATcount(b) &&
+	    PKfold(b, hp) != GDK_SUCCEED) {
+		/* can't bring the packed copy up to date, so get
+		 * rid of it (PKfold may have changed the directory
+		 * of the last block, so the file is useless) */
+		b->tpacked = NULL;
+		HEAPdelete(hp, BBP_physical(b->batCacheid), "tpacked");
+		GDKfree(hp);
+		GDKclrerr();
+	}
+	ret = b->tpacked != NULL;
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	ALGODEBUG if (ret) fprintf(stderr, "#BATcheckpacked(" ALGOBATFMT "): already has packed heap, waited " LLFMT " usec\n", ALGOBATPAR(b), GDKusec() - t);
+	return ret;
+}
+
+/* Create a packed copy of the tail of b.  If b is a view, the packed
+ * copy is created on its parent. */
+gdk_return
+BATpack(BAT *b)
+{
+	Heap *hp;
+	oid *hdr;
+	size_t cap;
+	lng t0 = 0;
+
+	BATcheck(b, "BATpack", GDK_FAIL);
+
+	if (!PACKtype(b->ttype)) {
+		GDKerror("BATpack: unsupported type\n");
+		return GDK_FAIL;
+	}
+
+	if (VIEWtparent(b)) {
+		/* views use the packed copy of their parent */
+		b = BBPdescriptor(VIEWtparent(b));
+		assert(b);
+	}
+	if (BATcheckpacked(b))
+		return GDK_SUCCEED;
+
+	ALGODEBUG t0 = GDKusec();
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->tpacked == NULL) {
+		/* room in the directory for the capacity of b */
+		cap = (BATcapacity(b) + PACKED_BLOCK - 1) / PACKED_BLOCK;
+		if ((hp = GDKzalloc(sizeof(Heap))) == NULL ||
+		    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, packedheap)) < 0 ||
+		    snprintf(hp->filename, sizeof(hp->filename), "%s.tpacked", BBP_physical(b->batCacheid)) < 0 ||
+		    HEAPalloc(hp, PKsize(cap, (size_t) BATcount(b) * b->twidth / 16 + 1), 1) != GDK_SUCCEED) {
+			GDKfree(hp);
+			MT_lock_unset(&GDKhashLock(b->batCacheid));
+			return GDK_FAIL;
+		}
+		hdr = (oid *) hp->base;
+		hdr[0] = PACKED_VERSION;
+		hdr[1] = 0;
+		hdr[2] = 0;
+		hdr[3] = (oid) PACKED_BLOCK;
+		hdr[4] = (oid) cap;
+		hdr[5] = 0;
+		hp->free = PKsize(cap, 0);
+		if (PKfold(b, hp) != GDK_SUCCEED) {
+			HEAPfree(hp, true);
+			GDKfree(hp);
+			MT_lock_unset(&GDKhashLock(b->batCacheid));
+			return GDK_FAIL;
+		}
+		b->tpacked = hp;
+		ALGODEBUG fprintf(stderr, "#BATpack(" ALGOBATFMT "): packed heap construction, %zu of %zu bytes, " LLFMT " usec\n", ALGOBATPAR(b), hp->free, (size_t) BATcount(b) * b->twidth, GDKusec() - t0);
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	return GDK_SUCCEED;
+}
+
+/* The persistent BAT b was saved: create a packed copy if it is worth
+ * it, and save the packed copy if it changed. */
+void
+PACKsave(BAT *b)
+{
+	Heap *hp;
+	int fd;
+	const char *nme;
+
+	if (b->batPersistence != PERSISTENT ||
+	    isVIEW(b) ||
+	    !PACKtype(b->ttype))
+		return;
+	if (b->tpacked == NULL) {
+		if (BATcount(b) < PACKED_MINSIZE || !PKworthwhile(b))
+			return;
+		if (BATpack(b) != GDK_SUCCEED) {
+			GDKclrerr();	/* not interested in BATpack errors */
+			return;
+		}
+	} else if (b->tpacked == (Heap *) 1) {
+		/* the persisted packed copy covers a prefix of b and
+		 * is extended when it is loaded */
+		return;
+	}
+
+	nme = BBP_physical(b->batCacheid);
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->tpacked) != NULL && hp != (Heap *) 1 && hp->dirty) {
+		((oid *) hp->base)[0] &= ~((oid) 1 << 24);
+		if (HEAPsave(hp, nme, "tpacked") == GDK_SUCCEED &&
+		    (fd = GDKfdlocate(hp->farmid, nme, "rb+", "tpacked")) >= 0) {
+			((oid *) hp->base)[0] |= (oid) 1 << 24;
+			if (write(fd, hp->base, SIZEOF_OID) >= 0) {
+				if (!(GDKdebug & NOSYNCMASK)) {
+#if defined(NATIVE_WIN32)
+					_commit(fd);
+#elif defined(HAVE_FDATASYNC)
+					fdatasync(fd);
+#elif defined(HAVE_FSYNC)
+					fsync(fd);
+#endif
+				}
+			} else {
+				perror("write packed heap");
+			}
+			close(fd);
+			hp->dirty = false;
+		} else {
+			GDKclrerr();
+		}
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+}
+
+/* Calculate the sum of the non-nil values [start, end) of b using the
+ * packed copy of b (or of its parent), the number of nils, and the
+ * number of non-nil values.  Return false if there is no packed copy,
+ * or if the sum doesn't fit in a lng (the caller then calculates the
+ * sum from the values, which deals with overflow). */
+bool
+PACKsum(BAT *b, BUN start, BUN end, lng *sum, BUN *nils, BUN *nonils)
+{
+	BAT *pb = VIEWtparent(b) ? BBPdescriptor(VIEWtparent(b)) : b;
+	const Heap *hp;
+	const ulng *dir, *data, *d;
+	BUN poff, p, e, blk, i, nn;
+	lng base, s = 0, t;
+	ulng c, csum, nilc, codes[PACKED_BLOCK];
+	unsigned int w;
+
+	if (!PACKtype(b->ttype) || pb->tpacked == NULL || !BATcheckpacked(pb))
+		return false;
+	hp = pb->tpacked;
+	poff = (BUN) ((const char *) Tloc(b, 0) - (const char *) Tloc(pb, 0)) >> b->tshift;
+	if (end + poff > (BUN) ((const oid *) hp->base)[1])
+		return false;
+	dir = PKdir(hp);
+	data = PKdata(hp);
+	*nils = *nonils = 0;
+	for (p = start + poff; p < end + poff; p = e) {
+		blk = p / PACKED_BLOCK;
+		e = MIN((blk + 1) * PACKED_BLOCK, end + poff);
+		base = PKbase(dir, blk);
+		w = PKwidth(dir, blk);
+		if (w > 53)
+			return false; /* csum could overflow */
+		nilc = PKhasnil(dir, blk) ? PKmask(w) : ~(ulng) 0;
+		d = data + PKoffset(dir, blk);
+		csum = 0;
+		nn = e - p;
+		PACKdecode(d, p - blk * PACKED_BLOCK, nn, w, codes);
+		if (nilc == ~(ulng) 0) {
+			for (i = 0; i < e - p; i++)
+				csum += codes[i];
+		} else {
+			for (i = 0; i < e - p; i++) {
+				c = codes[i];
+				if (c == nilc) {
+					(*nils)++;
+					nn--;
+				} else {
+					csum += c;
+				}
+			}
+		}
+		if (nn == 0)
+			continue;
+		*nonils += nn;
+		/* s += base * nn + csum, checking for overflow */
+		if (base != 0 &&
+		    (base > GDK_lng_max / (lng) nn || base < -GDK_lng_max / (lng) nn))
+			return false;
+		t = base * (lng) nn;
+		if (t > GDK_lng_max - (lng) csum)
+			return false;
+		t += (lng) csum;
+		if (t > 0 ? s > GDK_lng_max - t : s < -GDK_lng_max - t)
+			return false;
+		s += t;
+	}
+	*sum = s;
+	return true;
+}
+
+/* Values were appended to b: bring the packed copy up to date if it
+ * is loaded (a packed copy that is only on disk is brought up to date
+ * when it is loaded). */
+void
+PACKappend(BAT *b)
+{
+	Heap *hp;
+	bool drop = false;
+
+	if (b->tpacked == NULL)
+		return;
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->tpacked) != NULL && hp != (Heap *) 1 &&
+	    ((oid *) hp->base)[1] < (oid) BATcount(b) &&
+	    PKfold(b, hp) != GDK_SUCCEED) {
+		GDKclrerr();
+		drop = true;
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	if (drop)
+		PACKdestroy(b);
+}
+
+/* The count of b is about to be set to cnt: destroy the packed copy
+ * if it covers values beyond that (if the packed copy is not loaded,
+ * we don't know what it covers, so destroy it if b shrinks). */
+void
+PACKtruncate(BAT *b, BUN cnt)
+{
+	Heap *hp = b->tpacked;
+
+	if (hp == NULL)
+		return;
+	if (hp == (Heap *) 1 ? cnt < BATcount(b) :
+	    ((oid *) hp->base)[1] > (oid) cnt)
+		PACKdestroy(b);
+}
+
+void
+PACKfree(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		if ((hp = b->tpacked) != NULL && hp != (Heap *) 1) {
+			b->tpacked = (Heap *) 1;
+			HEAPfree(hp, false);
+			GDKfree(hp);
+		}
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+	}
+}
+
+void
+PACKdestroy(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		hp = b->tpacked;
+		b->tpacked = NULL;
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+		if (hp == (Heap *) 1) {
+			GDKunlink(BBPselectfarm(b->batRole, b->ttype, packedheap),
+				  BATDIR,
+				  BBP_physical(b->batCacheid),
+				  "tpacked");
+		} else if (hp != NULL) {
+			HEAPdelete(hp, BBP_physical(b->batCacheid), "tpacked");
+			GDKfree(hp);
+		}
+	}
+}
@@ -0,0 +1,52 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+#ifndef GDK_PACKED_H
+#define GDK_PACKED_H
+
+/* The packed heap starts with a header of PACKEDOFF oids:
+ * [0] version (bit 24 is set when the heap was persisted)
+ * [1] number of values covered by the packed heap
+ * [2] number of blocks
+ * [3] number of values per block
+ * [4] number of blocks the block directory has room for
+ * [5] number of ulngs used for the codes
+ * followed by the block directory and the packed codes. */
+#define PACKED_VERSION	((oid) 1)
+#define PACKEDOFF	6
+#define PACKED_BLOCK	((BUN) 1 << 10)	/* values per block */
+#define PACKED_MINSIZE	((BUN) 1 << 18)	/* don't pack smaller columns */
+
+/* The directory has two ulngs for each block: the frame of reference
+ * of the block (its smallest non-nil value, as a lng), and the
+ * position of the codes of the block in the data area (in ulngs)
+ * shifted left by 8, with bit 7 set if the block contains nils and
+ * the number of bits per code in the lowest 7 bits.  The code of a
+ * value is its difference with the frame of reference; if the block
+ * contains nils, nil has the largest code (all bits set).  Codes are
+ * stored from the least significant bit of a ulng up and may
+ * straddle two ulngs; the codes are followed by one unused ulng so
+ * that the codes can be extracted without checking for that. */
+#define PKdir(hp)	((ulng *) ((hp)->base + PACKEDOFF * SIZEOF_OID))
+#define PKdata(hp)	(PKdir(hp) + 2 * (size_t) ((const oid *) (hp)->base)[4])
+#define PKbase(d, i)	((lng) (d)[2 * (i)])
+#define PKwidth(d, i)	((unsigned int) ((d)[2 * (i) + 1] & 0x7F))
+#define PKhasnil(d, i)	((bool) (((d)[2 * (i) + 1] >> 7) & 1))
+#define PKoffset(d, i)	((size_t) ((d)[2 * (i) + 1] >> 8))
+#define PKmask(w)	((w) == 64 ? ~(ulng) 0 : ((ulng) 1 << (w)) - 1)
+#define PKwords(n, w)	(((size_t) (n) * (w) + 63) / 64)
+#define PKsize(cap, words)	(PACKEDOFF * SIZEOF_OID + ((size_t) (cap) * 2 + (size_t) (words) + 1) * sizeof(ulng))
+
+/* the code that starts at bit position bit of d, masked with m;
+ * the second word is shifted in two steps so that nothing of it
+ * remains if the code doesn't straddle */
+#define PKextract(d, bit, m)						\
+	((((d)[(bit) / 64] >> ((bit) % 64)) |				\
+	  (((d)[(bit) / 64 + 1] << 1) << (63 - (bit) % 64))) & (m))
+
+#endif /* GDK_PACKED_H */
@@ -267,9 +267,88 @@ setenv(const char *name, const char *value, int overwrite)
 #endif
 #endif
 
+static size_t MT_hpsize = 0;	/* huge page size, 0 if not available */
+
 void
 MT_init_posix(void)
 {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+	/* transparent huge pages are available unless the kernel says
+	 * "[never]" */
+	FILE *f;
+	char buf[128];
+
+	if ((f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r")) == NULL)
+		return;
+	if (fgets(buf, (int) sizeof(buf), f) == NULL ||
+	    strstr(buf, "[never]") != NULL) {
+		fclose(f);
+		return;
+	}
+	fclose(f);
+	MT_hpsize = (size_t) 1 << 21; /* default 2MiB */
+	if ((f = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r")) != NULL) {
+		if (fgets(buf, (int) sizeof(buf), f) != NULL) {
+			size_t sz = (size_t) strtoull(buf, NULL, 10);
+			/* must be a power of two */
+			if (sz > MT_pagesize() && (sz & (sz - 1)) == 0)
+				MT_hpsize = sz;
+		}
+		fclose(f);
+	}
+#endif
+}
+
+size_t
+MT_hugepagesize(void)
+{
+	return MT_hpsize;
+}
+
+/* ask the kernel to back the part of [p,p+len) that consists of
+ * complete huge pages with huge pages; return 0 on success, -1 if
+ * there was nothing to be done or the kernel refused */
+int
+MT_hugepage_advise(void *p, size_t len)
+{
+#ifdef MADV_HUGEPAGE
+	uintptr_t start, end;
+
+	if (MT_hpsize == 0)
+		return -1;
+	start = ((uintptr_t) p + MT_hpsize - 1) & ~(uintptr_t) (MT_hpsize - 1);
+	end = ((uintptr_t) p + len) & ~(uintptr_t) (MT_hpsize - 1);
+	if (start >= end)
+		return -1;
+	return madvise((void *) start, (size_t) (end - start), MADV_HUGEPAGE);
+#else
+	(void) p;
+	(void) len;
+	return -1;
+#endif
+}
+
+/* return the amount of memory backed by (transparent) huge pages in
+ * bytes */
+size_t
+MT_hugepage_rss(void)
+{
+	size_t sz = 0;
+#ifdef __linux__
+	FILE *f;
+	char buf[256];
+
+	if ((f = fopen("/proc/self/smaps_rollup", "r")) == NULL)
+		return 0;
+	while (fgets(buf, (int) sizeof(buf), f) != NULL) {
+		if (strncmp(buf, "AnonHugePages:", 14) == 0) {
+			sz = (size_t) strtoull(buf + 14, NULL, 10) * 1024;
+			break;
+		}
+	}
+	fclose(f);
+#endif
+	return sz;
 }
 
 /* return RSS in bytes */
@@ -741,6 +820,26 @@ MT_init_posix(void)
 	SetUnhandledExceptionFilter(MT_ignore_exceptions);
 }
 
+size_t
+MT_hugepagesize(void)
+{
+	return 0;
+}
+
+int
+MT_hugepage_advise(void *p, size_t len)
+{
+	(void) p;
+	(void) len;
+	return -1;
+}
+
+size_t
+MT_hugepage_rss(void)
+{
+	return 0;
+}
+
 size_t
 MT_getrss(void)
 {
@@ -132,6 +132,13 @@ gdk_export size_t MT_getrss(void);
 gdk_export void *MT_mmap(const char *path, int mode, size_t len);
 gdk_export int MT_munmap(void *p, size_t len);
 
+/* transparent huge pages: the size of a huge page (0 if they're not
+ * available), ask for [p,p+len) to be backed by huge pages, and the
+ * amount of memory of the process that is backed by huge pages */
+gdk_export size_t MT_hugepagesize(void);
+gdk_export int MT_hugepage_advise(void *p, size_t len);
+gdk_export size_t MT_hugepage_rss(void);
+
 gdk_export int MT_path_absolute(const char *path);
 
 
@@ -25,9 +25,26 @@ enum heaptype {
 	varheap,
 	hashheap,
 	imprintsheap,
-	orderidxheap
+	orderidxheap,
+	zonemapheap,
+	packedheap,
+	rleheap
 };
 
+/* A bitmap candidate list covers the oids first up to (but not
+ * including) first + nbits: bit i is set if first + i is a
+ * candidate. */
+typedef struct {
+	oid first;
+	BUN nbits;
+	uint32_t *mask;
+} Candmask;
+
+#define CANDmaskset(m, o)						\
+	((m)->mask[((o) - (m)->first) >> 5] |= 1U << (((o) - (m)->first) & 31))
+#define CANDmaskisset(m, o)						\
+	(((m)->mask[((o) - (m)->first) >> 5] >> (((o) - (m)->first) & 31)) & 1)
+
 __hidden gdk_return ATOMheap(int id, Heap *hp, size_t cap)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -49,6 +66,12 @@ __hidden gdk_return BATcheckmodes(BAT *b, bool persistent)
 	__attribute__((__visibility__("hidden")));
 __hidden bool BATcheckorderidx(BAT *b)
 	__attribute__((__visibility__("hidden")));
+__hidden bool BATcheckpacked(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden bool BATcheckrle(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden bool BATcheckzonemap(BAT *b)
+	__attribute__((__visibility__("hidden")));
 __hidden BAT *BATcreatedesc(oid hseq, int tt, int heapnames, int role)
 	__attribute__((__visibility__("hidden")));
 __hidden void BATdelete(BAT *b)
@@ -110,6 +133,17 @@ __hidden BUN binsearch_flt(const oid *restrict indir, oid offset, const flt *res
 	__attribute__((__visibility__("hidden")));
 __hidden BUN binsearch_dbl(const oid *restrict indir, oid offset, const dbl *restrict vals, BUN lo, BUN hi, dbl v, int ordering, int last)
 	__attribute__((__visibility__("hidden")));
+__hidden void CANDmaskadd(Candmask *m, BAT *s)
+	__attribute__((__visibility__("hidden")));
+__hidden void CANDmaskand(Candmask *m, const Candmask *n)
+	__attribute__((__visibility__("hidden")));
+__hidden void CANDmaskfree(Candmask *m)
+	__attribute__((__visibility__("hidden")));
+__hidden gdk_return CANDmaskinit(Candmask *m, oid first, oid last)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden BAT *CANDmasktocand(const Candmask *m, BUN cnt)
+	__attribute__((__visibility__("hidden")));
 __hidden Heap *createOIDXheap(BAT *b, bool stable)
 	__attribute__((__visibility__("hidden")));
 __hidden gdk_return BUNreplace(BAT *b, oid left, const void *right, bool force)
@@ -132,6 +166,8 @@ __hidden char *GDKload(int farmid, const char *nme, const char *ext, size_t size
 __hidden void GDKlog(_In_z_ _Printf_format_string_ FILE * fl, const char *format, ...)
 	__attribute__((__format__(__printf__, 2, 3)))
 	__attribute__((__visibility__("hidden")));
+__hidden size_t GDKmallocated(const void *s)
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return GDKmove(int farmid, const char *dir1, const char *nme1, const char *ext1, const char *dir2, const char *nme2, const char *ext2)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -140,9 +176,18 @@ __hidden void *GDKmremap(const char *path, int mode, void *old_address, size_t o
 __hidden gdk_return GDKmunmap(void *addr, size_t len)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
+__hidden void GDKnuma_count(const void *p)
+	__attribute__((__visibility__("hidden")));
+__hidden void GDKparallel(void (*func)(void *), void *args, size_t argsize, int nr)
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return GDKremovedir(int farmid, const char *nme)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
+__hidden gdk_return GDKrsort(void *restrict h, void *restrict t, size_t n, int hs, int ts, int tpe, bool reverse)
+	__attribute__((__warn_unused_result__))
+	__attribute__((__visibility__("hidden")));
+__hidden bool GDKrsortable(int tpe)
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return GDKsave(int farmid, const char *nme, const char *ext, void *buf, size_t size, storage_t mode, bool dosync)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -175,6 +220,8 @@ __hidden void HEAPfree(Heap *h, bool remove)
 __hidden gdk_return HEAPload(Heap *h, const char *nme, const char *ext, bool trunc)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
+__hidden void HEAPpoolflush(void)
+	__attribute__((__visibility__("hidden")));
 __hidden void HEAP_recover(Heap *, const var_t *, BUN)
 	__attribute__((__visibility__("hidden")));
 __hidden gdk_return HEAPsave(Heap *h, const char *nme, const char *ext)
@@ -201,8 +248,44 @@ __hidden int MT_msync(void *p, size_t len)
 	__attribute__((__visibility__("hidden")));
 __hidden void OIDXfree(BAT *b)
 	__attribute__((__visibility__("hidden")));
+__hidden void PACKappend(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void PACKdecode(const ulng *restrict d, BUN i, BUN n, unsigned int w, ulng *restrict c)
+	__attribute__((__visibility__("hidden")));
+__hidden void PACKdestroy(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void PACKfree(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void PACKsave(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden bool PACKsum(BAT *b, BUN start, BUN end, lng *sum, BUN *nils, BUN *nonils)
+	__attribute__((__visibility__("hidden")));
+__hidden void PACKtruncate(BAT *b, BUN cnt)
+	__attribute__((__visibility__("hidden")));
+__hidden bool PACKtype(int tpe)
+	__attribute__((__visibility__("hidden")));
 __hidden void persistOIDX(BAT *b)
 	__attribute__((__visibility__("hidden")));
+__hidden void RLEappend(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void RLEdestroy(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden BUN RLEfind(const Heap *hp, BUN p)
+	__attribute__((__visibility__("hidden")));
+__hidden void RLEfree(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden const Heap *RLEget(BAT *b, BUN *off)
+	__attribute__((__visibility__("hidden")));
+__hidden lng RLEnil(int tpe)
+	__attribute__((__visibility__("hidden")));
+__hidden void RLEsave(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden bool RLEsum(BAT *b, BUN start, BUN end, lng *sum, BUN *nils, BUN *nonils)
+	__attribute__((__visibility__("hidden")));
+__hidden void RLEtruncate(BAT *b, BUN cnt)
+	__attribute__((__visibility__("hidden")));
+__hidden bool RLEtype(int tpe)
+	__attribute__((__visibility__("hidden")));
 __hidden gdk_return rangejoin(BAT *r1, BAT *r2, BAT *l, BAT *rl, BAT *rh, BAT *sl, BAT *sr, bool li, bool hi, BUN maxsize)
 	__attribute__((__warn_unused_result__))
 	__attribute__((__visibility__("hidden")));
@@ -210,6 +293,8 @@ __hidden void strCleanHash(Heap *hp, bool rebuild)
 	__attribute__((__visibility__("hidden")));
 __hidden int strCmpNoNil(const unsigned char *l, const unsigned char *r)
 	__attribute__((__visibility__("hidden")));
+__hidden var_t *strDictionary(const Heap *h, BUN *np)
+	__attribute__((__visibility__("hidden")));
 __hidden var_t strLocate(Heap *h, const char *v)
 	__attribute__((__visibility__("hidden")));
 __hidden gdk_return unshare_string_heap(BAT *b)
@@ -222,6 +307,20 @@ __hidden gdk_return VIEWreset(BAT *b)
 	__attribute__((__visibility__("hidden")));
 __hidden BAT *virtualize(BAT *bn)
 	__attribute__((__visibility__("hidden")));
+__hidden void ZMappend(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void ZMdestroy(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void ZMfree(BAT *b)
+	__attribute__((__visibility__("hidden")));
+__hidden void ZMstrbits(const char *v, unsigned int *h1, unsigned int *h2, unsigned int *hp)
+	__attribute__((__visibility__("hidden")));
+__hidden bool ZMstrmaybe(const char *rec, const char *v, bool prefix, bool caseignore, unsigned int h1, unsigned int h2, unsigned int hp)
+	__attribute__((__visibility__("hidden")));
+__hidden unsigned int ZMstrpfx(const char *v, size_t len)
+	__attribute__((__visibility__("hidden")));
+__hidden void ZMtruncate(BAT *b, BUN cnt)
+	__attribute__((__visibility__("hidden")));
 __hidden bool binsearchcand(const oid *cand, BUN lo, BUN hi, oid v)
 	__attribute__((__visibility__("hidden")));
 __hidden void gdk_bbp_reset(void)
@@ -310,6 +409,8 @@ extern bbplock_t GDKbbpLock[BBP_THREADMASK + 1];
 extern size_t GDK_mmap_minsize_persistent; /* size after which we use memory mapped files for persistent heaps */
 extern size_t GDK_mmap_minsize_transient; /* size after which we use memory mapped files for transient heaps */
 extern size_t GDK_mmap_pagesize; /* mmap granularity */
+extern bool GDK_hugepages; /* back large heaps with huge pages */
+extern size_t GDK_heappool_maxsize; /* max bytes in pool of freed heaps */
 extern MT_Lock GDKnameLock;
 extern MT_Lock GDKthreadLock;
 extern MT_Lock GDKtmLock;
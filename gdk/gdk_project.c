@@ -9,60 +9,136 @@
 #include "monetdb_config.h"
 #include "gdk.h"
 #include "gdk_private.h"
+#include "gdk_packed.h"
 
 /*
  * BATproject returns a BAT aligned with the left input whose values
  * are the values from the right input that were referred to by the
  * OIDs in the tail of the left input.
+ *
+ * With random OIDs into a large right input nearly every value we
+ * fetch is a cache miss.  Therefore a large left input is cut into
+ * slices of at least PROJECT_SLICE OIDs that are projected by
+ * separate threads, and if the right input doesn't fit in the cache,
+ * within a slice we prefetch the value that is referred to
+ * PROJECT_PREFETCH OIDs further on, so that a number of cache misses
+ * are outstanding at any time.  Var-sized values are collected in a
+ * separate BAT per slice; these are appended to the result afterwards,
+ * which copies their string heaps in bulk.
  */
 
+#define PROJECT_SLICE		((BUN) 1 << 16)
+#define PROJECT_PREFETCH	16
+#define PROJECT_BATCH		64	/* OIDs per batch in BATprojectchain */
+
+#ifdef __GNUC__
+#define PREFETCH(p)	__builtin_prefetch(p)
+#else
+#define PREFETCH(p)	((void) 0)
+#endif
+
+struct project_task {
+	BAT *bn;		/* result (var-sized: result for slice) */
+	BAT *l, *r;
+	BUN lo, hi;		/* slice of l handled by this task */
+	bool nilcheck;		/* check for nils in r */
+	bool prefetch;		/* prefetch values from r */
+	bool nil;		/* encountered a nil in r */
+	bool nilo;		/* encountered a nil OID in l */
+	bool nomatch;		/* encountered an OID not in r */
+	gdk_return res;
+};
+
+/* whether it pays to prefetch values of b, i.e. whether they don't
+ * fit in the cache */
+#define project_prefetch(b)						\
+	((b)->theap.free + ((b)->tvheap ? (b)->tvheap->free : 0) > MT_l2cachesize())
+
+/* Return the number of threads to use for projecting cnt values. */
+static int
+project_nthreads(BUN cnt)
+{
+	int nthreads = GDKnr_threads;
+
+	if ((BUN) nthreads > cnt / PROJECT_SLICE)
+		nthreads = (int) (cnt / PROJECT_SLICE);
+	return nthreads < 1 ? 1 : nthreads;
+}
+
+/* note, the OIDs are unsigned, so OIDs below the seqbase of r wrap
+ * around and compare larger than the count of r */
 #define project_loop(TYPE)						\
+static void								\
+project_##TYPE(void *arg)						\
+{									\
+	struct project_task *t = arg;					\
+	BUN lo, hi = t->hi;						\
+	const TYPE *restrict rt = (const TYPE *) Tloc(t->r, 0);		\
+	TYPE *restrict bt = (TYPE *) Tloc(t->bn, 0);			\
+	const oid *restrict o = (const oid *) Tloc(t->l, 0);		\
+	oid p, rseq = t->r->hseqbase;					\
+	BUN rcnt = BATcount(t->r);					\
+	bool nilcheck = t->nilcheck, prefetch = t->prefetch;		\
+	TYPE v;								\
+									\
+	for (lo = t->lo; lo < hi; lo++) {				\
+		if (prefetch && lo + PROJECT_PREFETCH < hi &&		\
+		    (p = o[lo + PROJECT_PREFETCH] - rseq) < rcnt)	\
+			PREFETCH(rt + p);				\
+		p = o[lo] - rseq;					\
+		if (p >= rcnt) {					\
+			if (is_oid_nil(o[lo])) {			\
+				bt[lo] = TYPE##_nil;			\
+				t->nilo = true;				\
+			} else {					\
+				t->nomatch = true;			\
+				return;					\
+			}						\
+		} else {						\
+			v = rt[p];					\
+			bt[lo] = v;					\
+			if (nilcheck && is_##TYPE##_nil(v)) {		\
+				/* one is enough */			\
+				t->nil = true;				\
+				nilcheck = false;			\
+			}						\
+		}							\
+	}								\
+}
+
+/* project type switch */
+project_loop(bte)
+project_loop(sht)
+project_loop(int)
+project_loop(flt)
+project_loop(dbl)
+project_loop(lng)
+#ifdef HAVE_HGE
+project_loop(hge)
+#endif
+
+/* project from the packed copy pk of the parent of r, of which r
+ * starts at position poff; this is only worth while if l is sorted
+ * and dense enough so that we can decode the codes block by block */
+#define project_packed_loop(TYPE)					\
 static gdk_return							\
-project_##TYPE(BAT *bn, BAT *l, BAT *r, bool nilcheck)			\
+project_packed_##TYPE(BAT *bn, BAT *l, BAT *r, const Heap *pk, BUN poff) \
 {									\
 	oid lo, hi;							\
-	const TYPE *restrict rt;					\
 	TYPE *restrict bt;						\
-	TYPE v;								\
 	const oid *restrict o;						\
+	const ulng *dir = PKdir(pk), *data = PKdata(pk);		\
 	oid rseq, rend;							\
+	BUN i, blk, cur = BUN_NONE;					\
+	unsigned int w = 0;						\
+	lng base = 0;							\
+	ulng c, nilc = 0, codes[PACKED_BLOCK];				\
 									\
 	o = (const oid *) Tloc(l, 0);					\
-	rt = (const TYPE *) Tloc(r, 0);					\
 	bt = (TYPE *) Tloc(bn, 0);					\
 	rseq = r->hseqbase;						\
 	rend = rseq + BATcount(r);					\
-	lo = 0;								\
-	hi = lo + BATcount(l);						\
-	if (nilcheck) {							\
-		for (; lo < hi; lo++) {					\
-			if (o[lo] < rseq || o[lo] >= rend) {		\
-				if (is_oid_nil(o[lo])) {		\
-					bt[lo] = TYPE##_nil;		\
-					bn->tnonil = false;		\
-					bn->tnil = true;		\
-					bn->tsorted = false;		\
-					bn->trevsorted = false;		\
-					bn->tkey = false;		\
-					lo++;				\
-					break;				\
-				} else {				\
-					GDKerror("BATproject: does not match always\n"); \
-					return GDK_FAIL;		\
-				}					\
-			} else {					\
-				v = rt[o[lo] - rseq];			\
-				bt[lo] = v;				\
-				if (is_##TYPE##_nil(v) && bn->tnonil) {	\
-					bn->tnonil = false;		\
-					bn->tnil = true;		\
-					lo++;				\
-					break;				\
-				}					\
-			}						\
-		}							\
-	}								\
-	for (; lo < hi; lo++) {						\
+	for (lo = 0, hi = lo + BATcount(l); lo < hi; lo++) {		\
 		if (o[lo] < rseq || o[lo] >= rend) {			\
 			if (is_oid_nil(o[lo])) {			\
 				bt[lo] = TYPE##_nil;			\
@@ -75,9 +151,26 @@ project_##TYPE(BAT *bn, BAT *l, BAT *r, bool nilcheck)			\
 				GDKerror("BATproject: does not match always\n"); \
 				return GDK_FAIL;			\
 			}						\
+			continue;					\
+		}							\
+		i = o[lo] - rseq + poff;				\
+		blk = i / PACKED_BLOCK;					\
+		if (blk != cur) {					\
+			cur = blk;					\
+			w = PKwidth(dir, blk);				\
+			base = PKbase(dir, blk);			\
+			nilc = PKhasnil(dir, blk) ? PKmask(w) : ~(ulng) 0; \
+			PACKdecode(data + PKoffset(dir, blk), 0,	\
+				   MIN(PACKED_BLOCK, ((const oid *) pk->base)[1] - blk * PACKED_BLOCK), \
+				   w, codes);				\
+		}							\
+		c = codes[i - blk * PACKED_BLOCK];			\
+		if (c == nilc) {					\
+			bt[lo] = TYPE##_nil;				\
+			bn->tnonil = false;				\
+			bn->tnil = true;				\
 		} else {						\
-			v = rt[o[lo] - rseq];				\
-			bt[lo] = v;					\
+			bt[lo] = (TYPE) (lng) ((ulng) base + c);	\
 		}							\
 	}								\
 	assert((BUN) lo == BATcount(l));				\
@@ -85,17 +178,9 @@ project_##TYPE(BAT *bn, BAT *l, BAT *r, bool nilcheck)			\
 	return GDK_SUCCEED;						\
 }
 
-
-/* project type switch */
-project_loop(bte)
-project_loop(sht)
-project_loop(int)
-project_loop(flt)
-project_loop(dbl)
-project_loop(lng)
-#ifdef HAVE_HGE
-project_loop(hge)
-#endif
+project_packed_loop(sht)
+project_packed_loop(int)
+project_packed_loop(lng)
 
 static gdk_return
 project_void(BAT *bn, BAT *l, BAT *r)
@@ -137,51 +222,149 @@ project_void(BAT *bn, BAT *l, BAT *r)
 	return GDK_SUCCEED;
 }
 
-static gdk_return
-project_any(BAT *bn, BAT *l, BAT *r, bool nilcheck)
+static void
+project_any(void *arg)
 {
-	BUN n;
-	oid lo, hi;
+	struct project_task *t = arg;
+	BAT *bn = t->bn, *r = t->r;
+	BUN n, lo, hi = t->hi;
 	BATiter ri;
 	int (*cmp)(const void *, const void *) = ATOMcompare(r->ttype);
 	const void *nil = ATOMnilptr(r->ttype);
 	const void *v;
 	const oid *o;
-	oid rseq, rend;
+	oid p, rseq;
+	BUN rcnt;
+	bool nilcheck = t->nilcheck;
+	bool varsized = ATOMvarsized(bn->ttype);
 
-	o = (const oid *) Tloc(l, 0);
-	n = 0;
+	o = (const oid *) Tloc(t->l, 0);
 	ri = bat_iterator(r);
 	rseq = r->hseqbase;
-	rend = rseq + BATcount(r);
-	for (lo = 0, hi = lo + BATcount(l); lo < hi; lo++, n++) {
-		if (o[lo] < rseq || o[lo] >= rend) {
+	rcnt = BATcount(r);
+	for (lo = t->lo, n = 0; lo < hi; lo++, n++) {
+		if (t->prefetch && lo + PROJECT_PREFETCH < hi &&
+		    (p = o[lo + PROJECT_PREFETCH] - rseq) < rcnt) {
+			/* for var-sized values, the offset further
+			 * on was prefetched in an earlier round */
+			if (r->tvarsized) {
+				PREFETCH(BUNtvar(ri, p));
+				if (lo + 2 * PROJECT_PREFETCH < hi &&
+				    (p = o[lo + 2 * PROJECT_PREFETCH] - rseq) < rcnt)
+					PREFETCH(Tloc(r, p));
+			} else {
+				PREFETCH(Tloc(r, p));
+			}
+		}
+		p = o[lo] - rseq;
+		if (p >= rcnt) {
 			if (is_oid_nil(o[lo])) {
-				tfastins_nocheck(bn, n, nil, Tsize(bn));
-				bn->tnonil = false;
-				bn->tnil = true;
-				bn->tsorted = false;
-				bn->trevsorted = false;
-				bn->tkey = false;
+				v = nil;
+				t->nilo = true;
 			} else {
-				GDKerror("BATproject: does not match always\n");
-				goto bunins_failed;
+				t->nomatch = true;
+				return;
 			}
 		} else {
-			v = BUNtail(ri, o[lo] - rseq);
+			v = BUNtail(ri, p);
+			if (nilcheck && cmp(v, nil) == 0) {
+				t->nil = true;
+				nilcheck = false;
+			}
+		}
+		if (varsized) {
 			tfastins_nocheck(bn, n, v, Tsize(bn));
-			if (nilcheck && bn->tnonil && cmp(v, nil) == 0) {
-				bn->tnonil = false;
-				bn->tnil = true;
+		} else {
+			/* slices share bn, so leave its free alone */
+			ATOMputFIX(bn->ttype, Tloc(bn, lo), v);
+		}
+	}
+	if (varsized) {
+		BATsetcount(bn, n);
+		bn->theap.dirty = true;
+	}
+	return;
+  bunins_failed:
+	t->res = GDK_FAIL;
+}
+
+/* Project l and r into bn using the projection function func, in
+ * parallel if l is large enough. */
+static gdk_return
+project_run(void (*func)(void *), BAT *bn, BAT *l, BAT *r, bool nilcheck)
+{
+	struct project_task task, *tasks = &task;
+	BUN cnt = BATcount(l), slice;
+	int nthreads = project_nthreads(cnt), i;
+	bool varsized = ATOMvarsized(bn->ttype);
+	gdk_return res = GDK_SUCCEED;
+	bool nomatch = false;
+
+	if (nthreads > 1 &&
+	    (tasks = GDKzalloc(nthreads * sizeof(*tasks))) == NULL)
+		return GDK_FAIL;
+	slice = cnt / nthreads;
+	for (i = 0; i < nthreads; i++) {
+		tasks[i] = (struct project_task) {
+			.bn = bn,
+			.l = l,
+			.r = r,
+			.lo = i * slice,
+			.hi = i == nthreads - 1 ? cnt : (i + 1) * slice,
+			.nilcheck = nilcheck,
+			.prefetch = project_prefetch(r),
+			.res = GDK_SUCCEED,
+		};
+		if (varsized && i > 0) {
+			tasks[i].bn = COLnew(0, bn->ttype, tasks[i].hi - tasks[i].lo, TRANSIENT);
+			if (tasks[i].bn == NULL) {
+				nthreads = i;
+				res = GDK_FAIL;
+				goto bailout;
 			}
 		}
 	}
-	assert(n == BATcount(l));
-	BATsetcount(bn, n);
-	bn->theap.dirty = true;
-	return GDK_SUCCEED;
-bunins_failed:
-	return GDK_FAIL;
+	ALGODEBUG if (nthreads > 1)
+		fprintf(stderr, "#BATproject(l=%s,r=%s): using %d threads\n",
+			BATgetId(l), BATgetId(r), nthreads);
+
+	GDKparallel(func, tasks, sizeof(*tasks), nthreads);
+
+	for (i = 0; i < nthreads; i++) {
+		if (tasks[i].res != GDK_SUCCEED)
+			res = GDK_FAIL;
+		nomatch |= tasks[i].nomatch;
+		if (tasks[i].nilo) {
+			bn->tsorted = false;
+			bn->trevsorted = false;
+			bn->tkey = false;
+		}
+		if (tasks[i].nil | tasks[i].nilo) {
+			bn->tnonil = false;
+			bn->tnil = true;
+		}
+	}
+	if (nomatch) {
+		GDKerror("BATproject: does not match always\n");
+		res = GDK_FAIL;
+	}
+	if (res == GDK_SUCCEED) {
+		if (varsized) {
+			/* the slice results follow slice 0 which was
+			 * projected into bn itself */
+			for (i = 1; i < nthreads && res == GDK_SUCCEED; i++)
+				res = BATappend(bn, tasks[i].bn, NULL, false);
+		} else {
+			BATsetcount(bn, cnt);
+		}
+	}
+  bailout:
+	if (varsized)
+		for (i = 1; i < nthreads; i++)
+			BBPreclaim(tasks[i].bn);
+	if (tasks != &task)
+		GDKfree(tasks);
+	return res;
 }
 
 BAT *
@@ -288,28 +471,57 @@ BATproject(BAT *l, BAT *r)
 	}
 	bn->tnil = false;
 
+	/* if r (or its parent) has a packed copy that covers r and we
+	 * will access a good part of r sequentially, read the
+	 * (smaller) packed copy instead of r itself */
+	if (!stringtrick && l->tsorted && lcount >= rcount / 4 &&
+	    (tpe == TYPE_sht || tpe == TYPE_int || tpe == TYPE_lng) &&
+	    PACKtype(r->ttype)) {
+		BAT *pb = VIEWtparent(r) ? BBPdescriptor(VIEWtparent(r)) : r;
+		BUN poff = (BUN) ((const char *) Tloc(r, 0) - (const char *) Tloc(pb, 0)) >> r->tshift;
+
+		if (pb->tpacked != NULL && BATcheckpacked(pb) &&
+		    (BUN) ((const oid *) pb->tpacked->base)[1] >= poff + rcount) {
+			ALGODEBUG fprintf(stderr, "#BATproject(l=%s,r=%s): "
+					  "using packed copy\n",
+					  BATgetId(l), BATgetId(r));
+			switch (tpe) {
+			case TYPE_sht:
+				res = project_packed_sht(bn, l, r, pb->tpacked, poff);
+				break;
+			case TYPE_int:
+				res = project_packed_int(bn, l, r, pb->tpacked, poff);
+				break;
+			default:
+				res = project_packed_lng(bn, l, r, pb->tpacked, poff);
+				break;
+			}
+			goto doneproject;
+		}
+	}
+
 	switch (tpe) {
 	case TYPE_bte:
-		res = project_bte(bn, l, r, nilcheck);
+		res = project_run(project_bte, bn, l, r, nilcheck);
 		break;
 	case TYPE_sht:
-		res = project_sht(bn, l, r, nilcheck);
+		res = project_run(project_sht, bn, l, r, nilcheck);
 		break;
 	case TYPE_int:
-		res = project_int(bn, l, r, nilcheck);
+		res = project_run(project_int, bn, l, r, nilcheck);
 		break;
 	case TYPE_flt:
-		res = project_flt(bn, l, r, nilcheck);
+		res = project_run(project_flt, bn, l, r, nilcheck);
 		break;
 	case TYPE_dbl:
-		res = project_dbl(bn, l, r, nilcheck);
+		res = project_run(project_dbl, bn, l, r, nilcheck);
 		break;
 	case TYPE_lng:
-		res = project_lng(bn, l, r, nilcheck);
+		res = project_run(project_lng, bn, l, r, nilcheck);
 		break;
 #ifdef HAVE_HGE
 	case TYPE_hge:
-		res = project_hge(bn, l, r, nilcheck);
+		res = project_run(project_hge, bn, l, r, nilcheck);
 		break;
 #endif
 	case TYPE_oid:
@@ -317,17 +529,18 @@ BATproject(BAT *l, BAT *r)
 			res = project_void(bn, l, r);
 		} else {
 #if SIZEOF_OID == SIZEOF_INT
-			res = project_int(bn, l, r, nilcheck);
+			res = project_run(project_int, bn, l, r, nilcheck);
 #else
-			res = project_lng(bn, l, r, nilcheck);
+			res = project_run(project_lng, bn, l, r, nilcheck);
 #endif
 		}
 		break;
 	default:
-		res = project_any(bn, l, r, nilcheck);
+		res = project_run(project_any, bn, l, r, nilcheck);
 		break;
 	}
 
+  doneproject:
 	if (res != GDK_SUCCEED)
 		goto bailout;
 
@@ -382,6 +595,154 @@ BATproject(BAT *l, BAT *r)
 	return NULL;
 }
 
+/* For each BAT in a projection chain we remember some important
+ * details, however, dense-tailed BATs are optimized away in this list
+ * by combining their details with the following BAT's details.  For
+ * each element in the chain, the value must be in the range
+ * [hlo..hlo+cnt) of the following element. */
+struct projectchain_bat {
+	const oid *vals;	/* if not dense, start of relevant tail values */
+	BAT *b;			/* the BAT */
+	oid hlo;		/* lowest allowed oid to index the BAT */
+	BUN cnt;		/* size of allowed index range */
+};
+
+struct projectchain_task {
+	const struct projectchain_bat *ba;
+	int n;			/* ba[n] is the last BAT */
+	BAT *bn;		/* result (var-sized: result for slice) */
+	const char *src;	/* fixed-sized: values of last BAT */
+	BUN off;		/* var-sized: BUN offset into last BAT */
+	oid tseq;		/* dense last BAT: value of first BUN */
+	const void *nil;	/* nil representation for last BAT */
+	bool prefetch;		/* prefetch values from last BAT */
+	BUN lo, hi;		/* slice of the output handled by this task */
+	bool nil_seen;		/* encountered a nil */
+	bool nomatch;		/* encountered an OID out of range */
+	gdk_return res;
+};
+
+/* Follow the m OIDs in buf through the BATs ba[1..n) and then turn
+ * them into indexes into ba[n] (or oid_nil).  All values of a level
+ * that doesn't fit in the cache are prefetched before any of them is
+ * loaded, so that the cache misses of a batch overlap.  Return false
+ * if an OID is out of range. */
+static bool
+projectchain_follow(const struct projectchain_bat *ba, int n, oid *buf,
+		    BUN m, bool *nil)
+{
+	BUN k;
+	oid o;
+	int i;
+
+	for (i = 1; i <= n; i++) {
+		const oid *vals = ba[i].vals;
+		oid hlo = ba[i].hlo;
+		BUN cnt = ba[i].cnt;
+
+		if (i < n && project_prefetch(ba[i].b)) {
+			for (k = 0; k < m; k++)
+				if ((o = buf[k] - hlo) < cnt)
+					PREFETCH(vals + o);
+		}
+		for (k = 0; k < m; k++) {
+			if (is_oid_nil(buf[k])) {
+				*nil = true;
+				continue;
+			}
+			o = buf[k] - hlo;
+			if (o >= cnt)
+				return false;
+			buf[k] = i < n ? vals[o] : o;
+		}
+	}
+	return true;
+}
+
+#define projectchain_copy(TYPE)						\
+	do {								\
+		const TYPE *restrict src = (const TYPE *) t->src;	\
+		TYPE *restrict dst = (TYPE *) Tloc(t->bn, 0);		\
+		if (t->prefetch)					\
+			for (k = 0; k < m; k++)				\
+				if (!is_oid_nil(buf[k]))		\
+					PREFETCH(src + buf[k]);		\
+		for (k = 0; k < m; k++)					\
+			dst[p + k] = is_oid_nil(buf[k]) ? *(const TYPE *) t->nil : src[buf[k]]; \
+	} while (0)
+
+static void
+projectchain_worker(void *arg)
+{
+	struct projectchain_task *t = arg;
+	const struct projectchain_bat *ba = t->ba;
+	BAT *bn = t->bn, *b = ba[t->n].b;
+	oid buf[PROJECT_BATCH];
+	BUN p, k, m;
+
+	for (p = t->lo; p < t->hi; p += m) {
+		m = MIN(PROJECT_BATCH, t->hi - p);
+		memcpy(buf, ba[0].vals + p, m * sizeof(oid));
+		if (!projectchain_follow(ba, t->n, buf, m, &t->nil_seen)) {
+			t->nomatch = true;
+			return;
+		}
+		if (ATOMvarsized(bn->ttype)) {
+			/* generic code for var-sized atoms */
+			BATiter bi = bat_iterator(b);
+			const void *v;
+
+			if (t->prefetch)
+				for (k = 0; k < m; k++)
+					if (!is_oid_nil(buf[k]))
+						PREFETCH(BUNtvar(bi, buf[k] + t->off));
+			for (k = 0; k < m; k++) {
+				v = is_oid_nil(buf[k]) ? t->nil : BUNtvar(bi, buf[k] + t->off);
+				bunfastappVAR(bn, v);
+			}
+		} else if (t->src == NULL) {
+			/* last BAT is dense-tailed */
+			oid *restrict dst = (oid *) Tloc(bn, 0);
+
+			for (k = 0; k < m; k++)
+				dst[p + k] = is_oid_nil(buf[k]) ? oid_nil : buf[k] + t->tseq;
+		} else {
+			switch (Tsize(bn)) {
+			case 1:
+				projectchain_copy(bte);
+				break;
+			case 2:
+				projectchain_copy(sht);
+				break;
+			case 4:
+				projectchain_copy(int);
+				break;
+			case 8:
+				projectchain_copy(lng);
+				break;
+#ifdef HAVE_HGE
+			case 16:
+				projectchain_copy(hge);
+				break;
+#endif
+			default: {
+				/* generic code for fixed-sized atoms */
+				const char *v;
+
+				for (k = 0; k < m; k++) {
+					v = is_oid_nil(buf[k]) ? t->nil : t->src + buf[k] * Tsize(bn);
+					ATOMputFIX(bn->ttype, Tloc(bn, p + k), v);
+				}
+				break;
+			}
+			}
+		}
+	}
+	return;
+  bunins_failed:
+	t->res = GDK_FAIL;
+}
+
 /* Calculate a chain of BATproject calls.
  * The argument is a NULL-terminated array of BAT pointers.
  * This function is equivalent (apart from reference counting) to a
@@ -397,29 +758,20 @@ BATproject(BAT *l, BAT *r)
 BAT *
 BATprojectchain(BAT **bats)
 {
-	/* For each BAT we remember some important details, however,
-	 * dense-tailed BATs are optimized away in this list by
-	 * combining their details with the following BAT's details.
-	 * For each element in the chain, the value must be in the
-	 * range [hlo..hlo+cnt) of the following element.  If a BAT in
-	 * the chain is dense-tailed, the value tseq is the lowest
-	 * value (corresponding with hlo).  Since dense-tailed BATs
-	 * are combined with their successors, tseq will only be used
-	 * for the last element. */
-	struct {
-		const oid *vals; /* if not dense, start of relevant tail values */
-		BAT *b;		/* the BAT */
-		oid hlo;	/* lowest allowed oid to index the BAT */
-		BUN cnt;	/* size of allowed index range */
-	} *ba;
-	int i, n, tpe;
+	/* If a BAT in the chain is dense-tailed, the value tseq is
+	 * the lowest value (corresponding with hlo).  Since
+	 * dense-tailed BATs are combined with their successors, tseq
+	 * will only be used for the last element. */
+	struct projectchain_bat *ba;
+	struct projectchain_task task, *tasks = &task;
+	int i, n, tpe, nthreads;
 	BAT *b, *bn;
-	oid o;
 	const void *nil;	/* nil representation for last BAT */
-	BUN p, cnt, off;
+	BUN cnt, off, slice;
 	oid hseq, tseq;
 	bool allnil = false, nonil = true;
-	bool stringtrick = false;
+	bool stringtrick = false, varsized, nil_seen = false, nomatch = false;
+	gdk_return res = GDK_SUCCEED;
 
 	/* count number of participating BATs and allocate some
 	 * temporary work space */
@@ -549,180 +901,71 @@ BATprojectchain(BAT **bats)
 	}
 	bn->tnil = bn->tnonil = false; /* we're not paying attention to this */
 	n = i - 1;		/* ba[n] is last BAT */
-
-/* figure out the "other" type, i.e. not compatible with oid */
-#if SIZEOF_OID == SIZEOF_INT
-#define OTPE	lng
-#define TOTPE	TYPE_lng
-#else
-#define OTPE	int
-#define TOTPE	TYPE_int
-#endif
-	if (ATOMstorage(bn->ttype) == ATOMstorage(TYPE_oid)) {
-		/* oids all the way (or the final tail type is a fixed
-		 * sized atom the same size as oid) */
-		oid *restrict v = (oid *) Tloc(bn, 0);
-
-		if (ba[n].vals == NULL) {
-			/* last BAT is dense-tailed */
-			lng offset = 0;
-
-			offset = (lng) tseq - (lng) ba[n].hlo;
-			ba[n].cnt += ba[n].hlo; /* upper bound of last BAT */
-			for (p = 0; p < cnt; p++) {
-				o = ba[0].vals[p];
-				for (i = 1; i < n; i++) {
-					o -= ba[i].hlo;
-					if (o >= ba[i].cnt) {
-						if (o == oid_nil - ba[i].hlo) {
-							bn->tnil = 1;
-							o = oid_nil;
-							break;
-						}
-						GDKerror("BATprojectchain: does not match always\n");
-						goto bunins_failed;
-					}
-					o = ba[i].vals[o];
-				}
-				if (is_oid_nil(o)) {
-					*v++ = *(oid *) nil;
-				} else {
-					if (o < ba[n].hlo || o >= ba[n].cnt) {
-						GDKerror("BATprojectchain: does not match always\n");
-						goto bunins_failed;
-					}
-					*v++ = (oid) (o + offset);
-				}
-			}
-		} else {
-			/* last BAT is materialized */
-			for (p = 0; p < cnt; p++) {
-				o = ba[0].vals[p];
-				for (i = 1; i <= n; i++) { /* note "<=" */
-					o -= ba[i].hlo;
-					if (o >= ba[i].cnt) {
-						if (o == oid_nil - ba[i].hlo) {
-							bn->tnil = true;
-							o = oid_nil;
-							break;
-						}
-						GDKerror("BATprojectchain: does not match always\n");
-						goto bunins_failed;
-					}
-					o = ba[i].vals[o];
-				}
-				*v++ = (is_oid_nil(o)) & !stringtrick ? *(oid *) nil : o;
-			}
-		}
-		assert(v == (oid *) Tloc(bn, cnt));
-	} else if (ATOMstorage(b->ttype) == ATOMstorage(TOTPE)) {
-		/* one special case for a fixed sized BAT */
-		const OTPE *src = (const OTPE *) Tloc(b, off);
-		OTPE *restrict dst = (OTPE *) Tloc(bn, 0);
-
-		for (p = 0; p < cnt; p++) {
-			o = ba[0].vals[p];
-			for (i = 1; i < n; i++) {
-				o -= ba[i].hlo;
-				if (o >= ba[i].cnt) {
-					if (o == oid_nil - ba[i].hlo) {
-						bn->tnil = true;
-						o = oid_nil;
-						break;
-					}
-					GDKerror("BATprojectchain: does not match always\n");
-					goto bunins_failed;
-				}
-				o = ba[i].vals[o];
-			}
-			if (is_oid_nil(o)) {
-				*dst++ = * (OTPE *) nil;
-			} else {
-				o -= ba[n].hlo;
-				if (o >= ba[n].cnt) {
-					GDKerror("BATprojectchain: does not match always\n");
-					goto bunins_failed;
-				}
-				*dst++ = src[o];
-			}
-		}
-	} else if (ATOMvarsized(tpe)) {
-		/* generic code for var-sized atoms */
-		BATiter bi = bat_iterator(b);
-		const void *v = nil; /* make compiler happy with init */
-
-		assert(!stringtrick);
-		for (p = 0; p < cnt; p++) {
-			o = ba[0].vals[p];
-			for (i = 1; i < n; i++) {
-				o -= ba[i].hlo;
-				if (o >= ba[i].cnt) {
-					if (o == oid_nil - ba[i].hlo) {
-						bn->tnil = true;
-						v = nil;
-						o = oid_nil;
-						break;
-					}
-					GDKerror("BATprojectchain: does not match always\n");
-					goto bunins_failed;
-				}
-				o = ba[i].vals[o];
-			}
-			if (!is_oid_nil(o)) {
-				o -= ba[n].hlo;
-				if (o >= ba[n].cnt) {
-					GDKerror("BATprojectchain: does not match always\n");
-					goto bunins_failed;
-				}
-				v = BUNtvar(bi, o + off);
+	varsized = ATOMvarsized(tpe);
+	assert(!varsized || !stringtrick);
+
+	nthreads = project_nthreads(cnt);
+	if (nthreads > 1 &&
+	    (tasks = GDKzalloc(nthreads * sizeof(*tasks))) == NULL) {
+		tasks = &task;
+		nthreads = 0;
+		goto bunins_failed;
+	}
+	slice = cnt / nthreads;
+	for (i = 0; i < nthreads; i++) {
+		tasks[i] = (struct projectchain_task) {
+			.ba = ba,
+			.n = n,
+			.bn = bn,
+			.src = (const char *) ba[n].vals,
+			.off = off,
+			.tseq = tseq,
+			.nil = nil,
+			.prefetch = project_prefetch(b),
+			.lo = i * slice,
+			.hi = i == nthreads - 1 ? cnt : (i + 1) * slice,
+			.res = GDK_SUCCEED,
+		};
+		if (varsized && i > 0) {
+			tasks[i].bn = COLnew(0, tpe, tasks[i].hi - tasks[i].lo, TRANSIENT);
+			if (tasks[i].bn == NULL) {
+				nthreads = i;
+				goto bunins_failed;
 			}
-			bunfastappVAR(bn, v);
 		}
-	} else {
-		/* generic code for fixed-sized atoms */
-		BATiter bi = bat_iterator(b);
-		const void *v = nil; /* make compiler happy with init */
-
-		for (p = 0; p < cnt; p++) {
-			o = ba[0].vals[p];
-			for (i = 1; i < n; i++) {
-				o -= ba[i].hlo;
-				if (o >= ba[i].cnt) {
-					if (o == oid_nil - ba[i].hlo) {
-						bn->tnil = true;
-						v = nil;
-						o = oid_nil;
-						break;
-					}
-					GDKerror("BATprojectchain: does not match always\n");
-					goto bunins_failed;
-				}
-				o = ba[i].vals[o];
-			}
-			if (!is_oid_nil(o)) {
-				o -= ba[n].hlo;
-				if (o >= ba[n].cnt) {
-					GDKerror("BATprojectchain: does not match always\n");
-					goto bunins_failed;
-				}
-				v = BUNtloc(bi, o + off);
-			}
-			if (BATcount(bn) >= BATcapacity(bn)) {
-				if (BATcount(bn) == BUN_MAX) {
-					GDKerror("BATprojectchain: too many elements to accomodate (" BUNFMT ")\n", BUN_MAX);
-					goto bunins_failed;
-				}
-				if (BATextend(bn, BATgrows(bn)) != GDK_SUCCEED)
-					goto bunins_failed;
-			}
-			bn->theap.free += Tsize(bn);
-			bn->theap.dirty |= Tsize(bn) != 0;
-			ATOMputFIX(bn->ttype, Tloc(bn, bn->batCount), v);
-			bn->batCount++;
+	}
+	ALGODEBUG if (nthreads > 1)
+		fprintf(stderr, "#BATprojectchain: using %d threads\n", nthreads);
+
+	GDKparallel(projectchain_worker, tasks, sizeof(*tasks), nthreads);
+
+	for (i = 0; i < nthreads; i++) {
+		if (tasks[i].res != GDK_SUCCEED)
+			res = GDK_FAIL;
+		nil_seen |= tasks[i].nil_seen;
+		nomatch |= tasks[i].nomatch;
+	}
+	if (nomatch) {
+		GDKerror("BATprojectchain: does not match always\n");
+		goto bunins_failed;
+	}
+	if (res != GDK_SUCCEED)
+		goto bunins_failed;
+	if (varsized) {
+		/* the slice results follow slice 0 which was
+		 * projected into bn itself */
+		for (i = 1; i < nthreads; i++) {
+			if (BATappend(bn, tasks[i].bn, NULL, false) != GDK_SUCCEED)
+				goto bunins_failed;
+			BBPreclaim(tasks[i].bn);
+			tasks[i].bn = NULL;
 		}
+		assert(BATcount(bn) == cnt);
 	}
 	bn->theap.dirty = true;
 	BATsetcount(bn, cnt);
+	bn->tnonil = false;
+	bn->tnil = nil_seen;
 	if (stringtrick) {
 		bn->tnonil = bn->tnil = false;
 		bn->tkey = false;
@@ -735,10 +978,17 @@ BATprojectchain(BAT **bats)
 	}
 	bn->tsorted = bn->trevsorted = cnt <= 1;
 	bn->tseqbase = oid_nil;
+	if (tasks != &task)
+		GDKfree(tasks);
 	GDKfree(ba);
 	return bn;
 
   bunins_failed:
+	if (varsized)
+		for (i = 1; i < nthreads; i++)
+			BBPreclaim(tasks[i].bn);
+	if (tasks != &task)
+		GDKfree(tasks);
 	GDKfree(ba);
 	BBPreclaim(bn);
 	return NULL;
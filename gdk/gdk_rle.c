@@ -0,0 +1,489 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/* Run indexes.
+ *
+ * Many persistent columns are sorted or clustered (dates, partition
+ * keys) and consist of long runs of equal values.  The run index of
+ * such a column stores the start position and the value of each run
+ * (see gdk_rle.h), i.e. it is a run-length encoding of the column.
+ *
+ * Kernels that can work per run use the run index instead of the
+ * values: BATselect produces a dense range of candidates for each
+ * qualifying run, BATgroup assigns groups and calculates extents and
+ * histograms per run, and BATsum adds value times run length.  For
+ * sorted columns, every run is a separate group, and the run index
+ * also avoids comparing consecutive values.
+ *
+ * A run index is created automatically when a persistent BAT of at
+ * least RLE_MINSIZE values of an integer type is saved (i.e. when it
+ * is committed), if its runs are on average at least RLE_MINRUN
+ * values long.  The run index is maintained when values are appended
+ * and destroyed on any other change (or when appends make the runs
+ * too short).  The run index is stored in a heap next to the tail
+ * heap (extension trle). */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_rle.h"
+
+/* whether columns of type tpe can have a run index */
+bool
+RLEtype(int tpe)
+{
+	switch (ATOMbasetype(tpe)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* the nil value of type tpe as stored in a run index */
+lng
+RLEnil(int tpe)
+{
+	switch (ATOMbasetype(tpe)) {
+	case TYPE_bte:
+		return bte_nil;
+	case TYPE_sht:
+		return sht_nil;
+	case TYPE_int:
+		return int_nil;
+	default:
+		return lng_nil;
+	}
+}
+
+/* return the index of the run containing position p, which must be
+ * covered by the run index hp */
+BUN
+RLEfind(const Heap *hp, BUN p)
+{
+	const lng *r = RLEruns(hp);
+	BUN lo = 0, hi = RLEnruns(hp), mid;
+
+	assert(p < RLEcount(hp));
+	/* find the last run that starts at or before p */
+	while (hi - lo > 1) {
+		mid = (lo + hi) / 2;
+		if (RLEstart(r, mid) <= p)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+#define RLEFOLD(TYPE)							\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		for (i = (BUN) hdr[1]; i < cnt; i++) {			\
+			if (n == 0 || (lng) vals[i] != RLEvalue(r, n - 1)) { \
+				if (RLEsize(n + 1) > hp->size) {	\
+					/* HEAPextend only preserves	\
+					 * the used part of the heap */	\
+					hp->free = RLEsize(n);		\
+					if (HEAPextend(hp, MAX(RLEsize(n + 1), hp->size + hp->size / 2), false) != GDK_SUCCEED) \
+						return GDK_FAIL;	\
+					r = RLEruns(hp);		\
+				}					\
+				r[2 * n] = (lng) i;			\
+				r[2 * n + 1] = (lng) vals[i];		\
+				n++;					\
+			}						\
+		}							\
+	} while (0)
+
+/* add the values of b that are not yet covered by the run index hp */
+static gdk_return
+RLEfold(BAT *b, Heap *hp)
+{
+	oid *hdr = (oid *) hp->base;
+	BUN cnt = BATcount(b), n = (BUN) hdr[2], i;
+	lng *r = RLEruns(hp);
+
+	assert((BUN) hdr[1] <= cnt);
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		RLEFOLD(bte);
+		break;
+	case TYPE_sht:
+		RLEFOLD(sht);
+		break;
+	case TYPE_int:
+		RLEFOLD(int);
+		break;
+	case TYPE_lng:
+		RLEFOLD(lng);
+		break;
+	default:
+		assert(0);
+	}
+	hdr = (oid *) hp->base;
+	hdr[1] = (oid) cnt;
+	hdr[2] = (oid) n;
+	hp->free = RLEsize(n);
+	hp->dirty = true;
+	return GDK_SUCCEED;
+}
+
+#define RLECOUNT(TYPE)							\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		for (i = 1; i < cnt && n <= max; i++)			\
+			n += vals[i] != vals[i - 1];			\
+	} while (0)
+
+/* return whether the runs of b are on average at least RLE_MINRUN
+ * values long */
+static bool
+RLEworthwhile(BAT *b)
+{
+	BUN cnt = BATcount(b), max = cnt / RLE_MINRUN, n = 1, i;
+
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		RLECOUNT(bte);
+		break;
+	case TYPE_sht:
+		RLECOUNT(sht);
+		break;
+	case TYPE_int:
+		RLECOUNT(int);
+		break;
+	case TYPE_lng:
+		RLECOUNT(lng);
+		break;
+	default:
+		return false;
+	}
+	return n <= max;
+}
+
+/* return TRUE if we have a run index of the tail, even if we need to
+ * read one from disk; the run index covers all values of b */
+bool
+BATcheckrle(BAT *b)
+{
+	bool ret;
+	Heap *hp;
+	lng t = 0;
+
+	if (b == NULL)
+		return false;
+	assert(b->batCacheid > 0);
+	ALGODEBUG t = GDKusec();
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->trle == (Heap *) 1) {
+		const char *nme = BBP_physical(b->batCacheid);
+		int fd;
+
+		b->trle = NULL;
+		if ((hp = GDKzalloc(sizeof(*hp))) != NULL &&
+		    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, rleheap)) >= 0) {
+			snprintf(hp->filename, sizeof(hp->filename), "%s.trle", nme);
+
+			/* check whether a persisted run index can be
+			 * found */
+			if ((fd = GDKfdlocate(hp->farmid, nme, "rb+", "trle")) >= 0) {
+				struct stat st;
+				oid hdata[RLEOFF];
+
+				if (read(fd, hdata, sizeof(hdata)) == sizeof(hdata) &&
+				    hdata[0] == (((oid) 1 << 24) | RLE_VERSION) &&
+				    hdata[1] <= (oid) BATcount(b) &&
+				    hdata[2] <= hdata[1] &&
+				    (hdata[2] > 0 || hdata[1] == 0) &&
+				    fstat(fd, &st) == 0 &&
+				    st.st_size >= (off_t) (hp->size = hp->free = RLEsize(hdata[2])) &&
+				    HEAPload(hp, nme, "trle", false) == GDK_SUCCEED) {
+					close(fd);
+					if (hdata[1] == (oid) BATcount(b) ||
+					    RLEfold(b, hp) == GDK_SUCCEED) {
+						b->trle = hp;
+						ALGODEBUG fprintf(stderr, "#BATcheckrle(" ALGOBATFMT "): reusing persisted run index\n", ALGOBATPAR(b));
+						MT_lock_unset(&GDKhashLock(b->batCacheid));
+						return true;
+					}
+					HEAPfree(hp, false);
+				} else {
+					close(fd);
+				}
+				/* unlink unusable file */
+				GDKunlink(hp->farmid, BATDIR, nme, "trle");
+			}
+		}
+		GDKfree(hp);
+		GDKclrerr();	/* we're not currently interested in errors */
+	}
+	if ((hp = b->trle) != NULL &&
+	    ((oid *) hp->base)[1] < (oid) BATcount(b) &&
+	    RLEfold(b, hp) != GDK_SUCCEED) {
+		/* can't bring the run index up to date, so get rid
+		 * of it */
+		b->trle = NULL;
+		HEAPdelete(hp, BBP_physical(b->batCacheid), "trle");
+		GDKfree(hp);
+		GDKclrerr();
+	}
+	ret = b->trle != NULL;
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	ALGODEBUG if (ret) fprintf(stderr, "#BATcheckrle(" ALGOBATFMT "): already has run index, waited " LLFMT " usec\n", ALGOBATPAR(b), GDKusec() - t);
+	return ret;
+}
+
+/* Return the run index of b (or of its parent if b is a view) if it
+ * exists and covers b, and set *off to the position of the first
+ * value of b in the run index. */
+const Heap *
+RLEget(BAT *b, BUN *off)
+{
+	BAT *pb = VIEWtparent(b) ? BBPdescriptor(VIEWtparent(b)) : b;
+
+	if (!RLEtype(b->ttype) || pb->trle == NULL)
+		return NULL;
+	*off = (BUN) ((const char *) Tloc(b, 0) - (const char *) Tloc(pb, 0)) >> b->tshift;
+	if (!BATcheckrle(pb) ||
+	    RLEcount(pb->trle) < *off + BATcount(b))
+		return NULL;
+	return pb->trle;
+}
+
+/* Create a run index of the tail of b.  If b is a view, the run
+ * index is created on its parent. */
+gdk_return
+BATrle(BAT *b)
+{
+	Heap *hp;
+	oid *hdr;
+	lng t0 = 0;
+
+	BATcheck(b, "BATrle", GDK_FAIL);
+
+	if (!RLEtype(b->ttype)) {
+		GDKerror("BATrle: unsupported type\n");
+		return GDK_FAIL;
+	}
+
+	if (VIEWtparent(b)) {
+		/* views use the run index of their parent */
+		b = BBPdescriptor(VIEWtparent(b));
+		assert(b);
+	}
+	if (BATcheckrle(b))
+		return GDK_SUCCEED;
+
+	ALGODEBUG t0 = GDKusec();
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->trle == NULL) {
+		if ((hp = GDKzalloc(sizeof(Heap))) == NULL ||
+		    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, rleheap)) < 0 ||
+		    snprintf(hp->filename, sizeof(hp->filename), "%s.trle", BBP_physical(b->batCacheid)) < 0 ||
+		    HEAPalloc(hp, RLEsize(BATcount(b) / RLE_MINRUN + 1), 1) != GDK_SUCCEED) {
+			GDKfree(hp);
+			MT_lock_unset(&GDKhashLock(b->batCacheid));
+			return GDK_FAIL;
+		}
+		hdr = (oid *) hp->base;
+		hdr[0] = RLE_VERSION;
+		hdr[1] = 0;
+		hdr[2] = 0;
+		hp->free = RLEsize(0);
+		if (RLEfold(b, hp) != GDK_SUCCEED) {
+			HEAPfree(hp, true);
+			GDKfree(hp);
+			MT_lock_unset(&GDKhashLock(b->batCacheid));
+			return GDK_FAIL;
+		}
+		b->trle = hp;
+		ALGODEBUG fprintf(stderr, "#BATrle(" ALGOBATFMT "): run index construction, " BUNFMT " runs, " LLFMT " usec\n", ALGOBATPAR(b), RLEnruns(hp), GDKusec() - t0);
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	return GDK_SUCCEED;
+}
+
+/* The persistent BAT b was saved: create a run index if it is worth
+ * it, and save the run index if it changed. */
+void
+RLEsave(BAT *b)
+{
+	Heap *hp;
+	int fd;
+	const char *nme;
+
+	if (b->batPersistence != PERSISTENT ||
+	    isVIEW(b) ||
+	    !RLEtype(b->ttype))
+		return;
+	if (b->trle == NULL) {
+		if (BATcount(b) < RLE_MINSIZE || !RLEworthwhile(b))
+			return;
+		if (BATrle(b) != GDK_SUCCEED) {
+			GDKclrerr();	/* not interested in BATrle errors */
+			return;
+		}
+	} else if (b->trle == (Heap *) 1) {
+		/* the persisted run index covers a prefix of b and
+		 * is extended when it is loaded */
+		return;
+	}
+
+	nme = BBP_physical(b->batCacheid);
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->trle) != NULL && hp != (Heap *) 1 && hp->dirty) {
+		((oid *) hp->base)[0] &= ~((oid) 1 << 24);
+		if (HEAPsave(hp, nme, "trle") == GDK_SUCCEED &&
+		    (fd = GDKfdlocate(hp->farmid, nme, "rb+", "trle")) >= 0) {
+			((oid *) hp->base)[0] |= (oid) 1 << 24;
+			if (write(fd, hp->base, SIZEOF_OID) >= 0) {
+				if (!(GDKdebug & NOSYNCMASK)) {
+#if defined(NATIVE_WIN32)
+					_commit(fd);
+#elif defined(HAVE_FDATASYNC)
+					fdatasync(fd);
+#elif defined(HAVE_FSYNC)
+					fsync(fd);
+#endif
+				}
+			} else {
+				perror("write run index");
+			}
+			close(fd);
+			hp->dirty = false;
+		} else {
+			GDKclrerr();
+		}
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+}
+
+/* Calculate the sum of the non-nil values [start, end) of b using the
+ * run index of b (or of its parent), the number of nils, and the
+ * number of non-nil values.  Return false if there is no run index,
+ * or if the sum doesn't fit in a lng (the caller then calculates the
+ * sum from the values, which deals with overflow). */
+bool
+RLEsum(BAT *b, BUN start, BUN end, lng *sum, BUN *nils, BUN *nonils)
+{
+	const Heap *hp;
+	const lng *r;
+	BUN off, i, n, p, e;
+	lng s = 0, t, v, nil = RLEnil(b->ttype);
+
+	if ((hp = RLEget(b, &off)) == NULL || start >= end)
+		return false;
+	r = RLEruns(hp);
+	*nils = *nonils = 0;
+	for (i = RLEfind(hp, start + off), n = RLEnruns(hp); i < n; i++) {
+		p = MAX(RLEstart(r, i), start + off);
+		e = MIN(RLEend(hp, r, i), end + off);
+		if (p >= e)
+			break;
+		v = RLEvalue(r, i);
+		if (v == nil) {
+			*nils += e - p;
+			continue;
+		}
+		*nonils += e - p;
+		/* s += v * (e - p), checking for overflow */
+		if (v != 0 &&
+		    (v > GDK_lng_max / (lng) (e - p) || v < -GDK_lng_max / (lng) (e - p)))
+			return false;
+		t = v * (lng) (e - p);
+		if (t > 0 ? s > GDK_lng_max - t : s < -GDK_lng_max - t)
+			return false;
+		s += t;
+	}
+	*sum = s;
+	return true;
+}
+
+/* Values were appended to b: bring the run index up to date if it is
+ * loaded (a run index that is only on disk is brought up to date when
+ * it is loaded); if the runs have become too short, drop the run
+ * index. */
+void
+RLEappend(BAT *b)
+{
+	Heap *hp;
+	bool drop = false;
+
+	if (b->trle == NULL)
+		return;
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->trle) != NULL && hp != (Heap *) 1 &&
+	    ((oid *) hp->base)[1] < (oid) BATcount(b)) {
+		if (RLEfold(b, hp) != GDK_SUCCEED) {
+			GDKclrerr();
+			drop = true;
+		} else if (RLEnruns(hp) * (RLE_MINRUN / 4) > RLEcount(hp)) {
+			drop = true;
+		}
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	if (drop)
+		RLEdestroy(b);
+}
+
+/* The count of b is about to be set to cnt: destroy the run index if
+ * it covers values beyond that (if the run index is not loaded, we
+ * don't know what it covers, so destroy it if b shrinks). */
+void
+RLEtruncate(BAT *b, BUN cnt)
+{
+	Heap *hp = b->trle;
+
+	if (hp == NULL)
+		return;
+	if (hp == (Heap *) 1 ? cnt < BATcount(b) :
+	    ((oid *) hp->base)[1] > (oid) cnt)
+		RLEdestroy(b);
+}
+
+void
+RLEfree(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		if ((hp = b->trle) != NULL && hp != (Heap *) 1) {
+			b->trle = (Heap *) 1;
+			HEAPfree(hp, false);
+			GDKfree(hp);
+		}
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+	}
+}
+
+void
+RLEdestroy(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		hp = b->trle;
+		b->trle = NULL;
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+		if (hp == (Heap *) 1) {
+			GDKunlink(BBPselectfarm(b->batRole, b->ttype, rleheap),
+				  BATDIR,
+				  BBP_physical(b->batCacheid),
+				  "trle");
+		} else if (hp != NULL) {
+			HEAPdelete(hp, BBP_physical(b->batCacheid), "trle");
+			GDKfree(hp);
+		}
+	}
+}
@@ -0,0 +1,35 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+#ifndef GDK_RLE_H
+#define GDK_RLE_H
+
+/* The run index heap starts with a header of RLEOFF oids:
+ * [0] version (bit 24 is set when the heap was persisted)
+ * [1] number of values covered by the run index
+ * [2] number of runs
+ * followed by one record of two lngs per run: the position of the
+ * first value of the run, and the value of the run (sign extended to
+ * a lng).  A run extends up to the start of the next run, the last
+ * run up to the number of values covered.  Consecutive runs have
+ * different values. */
+#define RLE_VERSION	((oid) 1)
+#define RLEOFF		3
+#define RLE_MINSIZE	((BUN) 1 << 16)	/* don't index smaller columns */
+#define RLE_MINRUN	32		/* minimum average run length */
+
+#define RLEsize(n)	(RLEOFF * SIZEOF_OID + (size_t) (n) * 2 * sizeof(lng))
+#define RLEruns(hp)	((lng *) ((hp)->base + RLEOFF * SIZEOF_OID))
+#define RLEstart(r, i)	((BUN) (r)[2 * (i)])
+#define RLEvalue(r, i)	((r)[2 * (i) + 1])
+#define RLEcount(hp)	((BUN) ((const oid *) (hp)->base)[1])
+#define RLEnruns(hp)	((BUN) ((const oid *) (hp)->base)[2])
+/* the position just beyond run i */
+#define RLEend(hp, r, i)	((i) + 1 < RLEnruns(hp) ? RLEstart(r, (i) + 1) : RLEcount(hp))
+
+#endif /* GDK_RLE_H */
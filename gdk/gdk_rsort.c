@@ -0,0 +1,305 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/* Radix sort for fixed-width numeric types.
+ *
+ * This is a least significant digit first radix sort with 8 bit
+ * digits.  Each value is mapped onto an unsigned key such that the
+ * order of the keys is the order of the values (with nil smallest),
+ * and equal values (including -0.0 and +0.0) have equal keys.  For
+ * descending sorts the keys are complemented.  Since every pass is a
+ * stable counting sort, the result is stable.
+ *
+ * Digits that are the same for all values are skipped.  Each pass is
+ * executed by multiple threads: each thread counts the digits in its
+ * own slice of the input, and from these counts we calculate where
+ * each thread has to put its values with a particular digit, so that
+ * the threads can scatter their values independently (and the sort
+ * remains stable).
+ */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+
+#define RSORT_SLICE	((size_t) 1 << 16) /* minimum values per thread */
+
+/* mapping from value to key */
+#define KEY_bte(v)	((unsigned char) ((unsigned char) (v) ^ 0x80))
+#define KEY_sht(v)	((unsigned short) ((unsigned short) (v) ^ 0x8000))
+#define KEY_int(v)	((unsigned int) (v) ^ 0x80000000U)
+#define KEY_lng(v)	((ulng) (v) ^ ((ulng) 1 << 63))
+#ifdef HAVE_HGE
+#define KEY_hge(v)	((uhge) (v) ^ ((uhge) 1 << 127))
+#endif
+#define KEY_flt(v)	fltkey(v)
+#define KEY_dbl(v)	dblkey(v)
+
+static inline unsigned int
+fltkey(flt v)
+{
+	union {
+		flt f;
+		unsigned int u;
+	} x;
+
+	if (is_flt_nil(v))
+		return 0;
+	x.f = v == 0 ? 0 : v;	/* -0.0 == +0.0 */
+	return x.u & 0x80000000U ? ~x.u : x.u | 0x80000000U;
+}
+
+static inline ulng
+dblkey(dbl v)
+{
+	union {
+		dbl f;
+		ulng u;
+	} x;
+
+	if (is_dbl_nil(v))
+		return 0;
+	x.f = v == 0 ? 0 : v;	/* -0.0 == +0.0 */
+	return x.u & ((ulng) 1 << 63) ? ~x.u : x.u | ((ulng) 1 << 63);
+}
+
+struct rsort {
+	char *h, *t;		/* current input */
+	char *h2, *t2;		/* current output */
+	int tpe;		/* base type of values */
+	bool reverse;
+	int shift;		/* position of current digit */
+	size_t (*counts)[256];	/* per thread histogram/scatter offsets */
+};
+
+enum rsort_phase {
+	RSORT_DIFF,
+	RSORT_HISTOGRAM,
+	RSORT_SCATTER,
+};
+
+struct rsort_task {
+	struct rsort *rs;
+	enum rsort_phase phase;
+	int id;
+	size_t start, end;	/* slice of input */
+	unsigned char diff[16];	/* digits that differ from first key */
+};
+
+#define DIGIT(TYPE, v)							\
+	(((unsigned int) (KEY_##TYPE(v) >> rs->shift) & 0xFF) ^ flip)
+
+#define RSORTWORK(TYPE, UTYPE)						\
+	do {								\
+		const TYPE *restrict src = (const TYPE *) rs->h;	\
+		TYPE *restrict dst = (TYPE *) rs->h2;			\
+		const oid *restrict srct = (const oid *) rs->t;		\
+		oid *restrict dstt = (oid *) rs->t2;			\
+		UTYPE k0, diff = 0;					\
+		size_t i, d;						\
+		unsigned int j;						\
+									\
+		switch (t->phase) {					\
+		case RSORT_DIFF:					\
+			k0 = KEY_##TYPE(src[0]);			\
+			for (i = t->start; i < t->end; i++)		\
+				diff |= KEY_##TYPE(src[i]) ^ k0;	\
+			for (j = 0; j < sizeof(TYPE); j++)		\
+				t->diff[j] = (unsigned char) (diff >> (8 * j)); \
+			break;						\
+		case RSORT_HISTOGRAM:					\
+			memset(cnt, 0, sizeof(rs->counts[0]));		\
+			for (i = t->start; i < t->end; i++)		\
+				cnt[DIGIT(TYPE, src[i])]++;		\
+			break;						\
+		case RSORT_SCATTER:					\
+			if (srct) {					\
+				for (i = t->start; i < t->end; i++) {	\
+					d = cnt[DIGIT(TYPE, src[i])]++;	\
+					dst[d] = src[i];		\
+					dstt[d] = srct[i];		\
+				}					\
+			} else {					\
+				for (i = t->start; i < t->end; i++) {	\
+					d = cnt[DIGIT(TYPE, src[i])]++;	\
+					dst[d] = src[i];		\
+				}					\
+			}						\
+			break;						\
+		}							\
+	} while (0)
+
+static void
+rsort_worker(void *arg)
+{
+	struct rsort_task *t = arg;
+	struct rsort *rs = t->rs;
+	size_t *restrict cnt = rs->counts[t->id];
+	unsigned int flip = rs->reverse ? 0xFF : 0;
+
+	switch (rs->tpe) {
+	case TYPE_bte:
+		RSORTWORK(bte, unsigned char);
+		break;
+	case TYPE_sht:
+		RSORTWORK(sht, unsigned short);
+		break;
+	case TYPE_int:
+		RSORTWORK(int, unsigned int);
+		break;
+	case TYPE_lng:
+		RSORTWORK(lng, ulng);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		RSORTWORK(hge, uhge);
+		break;
+#endif
+	case TYPE_flt:
+		RSORTWORK(flt, unsigned int);
+		break;
+	case TYPE_dbl:
+		RSORTWORK(dbl, ulng);
+		break;
+	default:
+		assert(0);
+	}
+}
+
+/* Return whether values of type tpe can be sorted using GDKrsort. */
+bool
+GDKrsortable(int tpe)
+{
+	if (ATOMvarsized(tpe))
+		return false;
+	switch (ATOMbasetype(tpe)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* Sort the n values of type tpe in h, and if t is not NULL, the oids
+ * in t along with them.  The sort is stable.  This function can fail
+ * if there is not enough memory for the temporary copy of the
+ * data. */
+gdk_return
+GDKrsort(void *restrict h, void *restrict t, size_t n, int hs, int ts, int tpe, bool reverse)
+{
+	struct rsort rs;
+	struct rsort_task *tasks;
+	char *h2, *t2;
+	size_t off, c, slice;
+	int nthreads, i, j, d;
+	unsigned int b;
+	unsigned char diff[16];
+
+	assert(GDKrsortable(tpe));
+	assert(hs == ATOMsize(tpe) && hs <= (int) sizeof(diff));
+	assert(t == NULL ? ts == 0 : ts == (int) sizeof(oid));
+	(void) ts;
+
+	if (n <= 1)
+		return GDK_SUCCEED;
+
+	nthreads = GDKnr_threads;
+	if ((size_t) nthreads > n / RSORT_SLICE)
+		nthreads = (int) (n / RSORT_SLICE);
+	if (nthreads < 1)
+		nthreads = 1;
+
+	rs.h = h;
+	rs.t = t;
+	rs.tpe = ATOMbasetype(tpe);
+	rs.reverse = reverse;
+	rs.shift = 0;
+	tasks = GDKmalloc(nthreads * sizeof(*tasks));
+	rs.counts = GDKmalloc(nthreads * sizeof(rs.counts[0]));
+	rs.h2 = h2 = GDKmalloc(n * hs);
+	rs.t2 = t2 = t ? GDKmalloc(n * sizeof(oid)) : NULL;
+	if (tasks == NULL || rs.counts == NULL || h2 == NULL ||
+	    (t != NULL && t2 == NULL)) {
+		GDKfree(tasks);
+		GDKfree(rs.counts);
+		GDKfree(h2);
+		GDKfree(t2);
+		return GDK_FAIL;
+	}
+
+	slice = n / nthreads;
+	for (i = 0; i < nthreads; i++) {
+		tasks[i].rs = &rs;
+		tasks[i].phase = RSORT_DIFF;
+		tasks[i].id = i;
+		tasks[i].start = i * slice;
+		tasks[i].end = i == nthreads - 1 ? n : (i + 1) * slice;
+	}
+
+	/* find out which digits actually differ */
+	GDKparallel(rsort_worker, tasks, sizeof(*tasks), nthreads);
+	memset(diff, 0, sizeof(diff));
+	for (i = 0; i < nthreads; i++)
+		for (d = 0; d < hs; d++)
+			diff[d] |= tasks[i].diff[d];
+
+	for (d = 0; d < hs; d++) {
+		if (diff[d] == 0)
+			continue;
+		rs.shift = 8 * d;
+		for (i = 0; i < nthreads; i++)
+			tasks[i].phase = RSORT_HISTOGRAM;
+		GDKparallel(rsort_worker, tasks, sizeof(*tasks), nthreads);
+		/* within a digit, the values of slice i come before
+		 * those of slice i + 1 */
+		off = 0;
+		for (b = 0; b < 256; b++) {
+			for (j = 0; j < nthreads; j++) {
+				c = rs.counts[j][b];
+				rs.counts[j][b] = off;
+				off += c;
+			}
+		}
+		assert(off == n);
+		for (i = 0; i < nthreads; i++)
+			tasks[i].phase = RSORT_SCATTER;
+		GDKparallel(rsort_worker, tasks, sizeof(*tasks), nthreads);
+		/* output of this pass is input of the next */
+		h2 = rs.h;
+		rs.h = rs.h2;
+		rs.h2 = h2;
+		t2 = rs.t;
+		rs.t = rs.t2;
+		rs.t2 = t2;
+	}
+	if (rs.h != h) {
+		/* odd number of passes: the result is in the
+		 * temporary buffers */
+		memcpy(h, rs.h, n * hs);
+		if (t)
+			memcpy(t, rs.t, n * sizeof(oid));
+		h2 = rs.h;
+		t2 = rs.t;
+	} else {
+		h2 = rs.h2;
+		t2 = rs.t2;
+	}
+	GDKfree(h2);
+	GDKfree(t2);
+	GDKfree(rs.counts);
+	GDKfree(tasks);
+	return GDK_SUCCEED;
+}
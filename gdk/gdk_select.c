@@ -14,6 +14,12 @@
 
 /* auxiliary functions and structs for imprints */
 #include "gdk_imprints.h"
+/* layout of zone maps */
+#include "gdk_zonemap.h"
+/* layout of packed heaps */
+#include "gdk_packed.h"
+/* layout of run indexes */
+#include "gdk_rle.h"
 
 #define buninsfix(B,A,I,V,G,M,R)					\
 	do {								\
@@ -476,6 +482,342 @@ hashselect(BAT *b, BAT *s, BAT *bn, const void *tl, BUN maximum, bool phash)
 #define MAXVALUEflt	GDK_flt_max
 #define MAXVALUEdbl	GDK_dbl_max
 
+/* Branch-free range scans.
+ *
+ * For the most common kind of scan select, a non-anti inclusive
+ * range (this includes equality selects on a non-nil value), we
+ * process the input in blocks.  Before each block we make sure the
+ * result has room for all values in the block, so that the inner
+ * loop does not need to check the capacity: it writes the oid
+ * unconditionally and only advances the output position if the value
+ * qualifies.  For scans without candidate list over int, lng and dbl
+ * we also have versions of the inner loop that use AVX2 or SSE4.2
+ * instructions.  The version is chosen at run time based on what the
+ * CPU supports, so that the binary still runs on machines without
+ * these extensions.  (With a candidate list, gathering the values
+ * with AVX2 turned out not to be faster than the scalar loop.)
+ *
+ * The kernels select the values v with lo <= v <= hi.  Since nil is
+ * the smallest value for the integer types and NaN for the floating
+ * point types, nils never qualify, unless lo is the smallest value of
+ * the type, which we only use if there are no nils. */
+
+#define RANGESCAN_BLOCK	((BUN) 1 << 14)
+
+/* smallest and largest representable values */
+#define LOWESTbte	bte_nil
+#define LOWESTsht	sht_nil
+#define LOWESTint	int_nil
+#define LOWESTlng	lng_nil
+#ifdef HAVE_HGE
+#define LOWESThge	hge_nil
+#endif
+#define LOWESTflt	(-INFINITY)
+#define LOWESTdbl	(-INFINITY)
+
+#define HIGHESTbte	GDK_bte_max
+#define HIGHESTsht	GDK_sht_max
+#define HIGHESTint	GDK_int_max
+#define HIGHESTlng	GDK_lng_max
+#ifdef HAVE_HGE
+#define HIGHESThge	GDK_hge_max
+#endif
+#define HIGHESTflt	INFINITY
+#define HIGHESTdbl	INFINITY
+
+/* portable versions of the kernels; fullrange works on consecutive
+ * values starting at oid o, candrange on the values indicated by a
+ * candidate list */
+#define rangekernels(TYPE)						\
+static BUN								\
+fullrange_##TYPE##_scalar(const TYPE *restrict src, BUN n,		\
+			  TYPE lo, TYPE hi, oid o, oid *restrict dst)	\
+{									\
+	BUN i, c = 0;							\
+									\
+	for (i = 0; i < n; i++) {					\
+		const TYPE v = src[i];					\
+		dst[c] = o + i;						\
+		c += (v >= lo) & (v <= hi);				\
+	}								\
+	return c;							\
+}									\
+static BUN								\
+candrange_##TYPE(const TYPE *restrict src, const oid *restrict cand,	\
+		 BUN n, TYPE lo, TYPE hi, oid off, oid *restrict dst)	\
+{									\
+	BUN i, c = 0;							\
+									\
+	for (i = 0; i < n; i++) {					\
+		const oid o = cand[i];					\
+		const TYPE v = src[o - off];				\
+		dst[c] = o;						\
+		c += (v >= lo) & (v <= hi);				\
+	}								\
+	return c;							\
+}
+
+rangekernels(bte)
+rangekernels(sht)
+rangekernels(int)
+rangekernels(lng)
+#ifdef HAVE_HGE
+rangekernels(hge)
+#endif
+rangekernels(flt)
+rangekernels(dbl)
+
+#define fullrange_bte	fullrange_bte_scalar
+#define fullrange_sht	fullrange_sht_scalar
+#ifdef HAVE_HGE
+#define fullrange_hge	fullrange_hge_scalar
+#endif
+#define fullrange_flt	fullrange_flt_scalar
+
+#if defined(HAVE___BUILTIN_CPU_SUPPORTS) && SIZEOF_OID == 8
+#include <immintrin.h>
+
+/* for each 4-bit mask of qualifying 64-bit lanes, the permutation
+ * (in 32-bit units) that moves the qualifying lanes to the front */
+static const int rangescan_perm[16][8] = {
+	{0, 0, 0, 0, 0, 0, 0, 0},
+	{0, 1, 0, 0, 0, 0, 0, 0},
+	{2, 3, 0, 0, 0, 0, 0, 0},
+	{0, 1, 2, 3, 0, 0, 0, 0},
+	{4, 5, 0, 0, 0, 0, 0, 0},
+	{0, 1, 4, 5, 0, 0, 0, 0},
+	{2, 3, 4, 5, 0, 0, 0, 0},
+	{0, 1, 2, 3, 4, 5, 0, 0},
+	{6, 7, 0, 0, 0, 0, 0, 0},
+	{0, 1, 6, 7, 0, 0, 0, 0},
+	{2, 3, 6, 7, 0, 0, 0, 0},
+	{0, 1, 2, 3, 6, 7, 0, 0},
+	{4, 5, 6, 7, 0, 0, 0, 0},
+	{0, 1, 4, 5, 6, 7, 0, 0},
+	{2, 3, 4, 5, 6, 7, 0, 0},
+	{0, 1, 2, 3, 4, 5, 6, 7},
+};
+/* number of bits set in a 4-bit mask */
+static const unsigned char rangescan_bits[16] = {
+	0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+};
+
+/* write the (up to) four oids in OIDS selected by mask M at DST[C] and
+ * advance C; note that all four lanes are written, so there must be
+ * room for them */
+#define rangescan_store4(DST, C, OIDS, M)				\
+	do {								\
+		const unsigned _m = (M);				\
+		_mm256_storeu_si256(					\
+			(__m256i *) ((DST) + (C)),			\
+			_mm256_permutevar8x32_epi32(			\
+				(OIDS),					\
+				_mm256_loadu_si256((const __m256i *) rangescan_perm[_m]))); \
+		(C) += rangescan_bits[_m];				\
+	} while (false)
+
+/* same, but for when we only have scalar stores */
+#define rangescan_emit(DST, C, O, M, N)					\
+	do {								\
+		unsigned _j;						\
+		for (_j = 0; _j < (N); _j++) {				\
+			(DST)[C] = (O) + _j;				\
+			(C) += ((M) >> _j) & 1;				\
+		}							\
+	} while (false)
+
+__attribute__((__target__("avx2")))
+static BUN
+fullrange_int_avx2(const int *restrict src, BUN n, int lo, int hi,
+		   oid o, oid *restrict dst)
+{
+	const __m256i vlo = _mm256_set1_epi32(lo);
+	const __m256i vhi = _mm256_set1_epi32(hi);
+	const __m256i four = _mm256_set1_epi64x(4);
+	__m256i oids = _mm256_add_epi64(_mm256_set1_epi64x((long long) o),
+					_mm256_set_epi64x(3, 2, 1, 0));
+	BUN i, c = 0;
+
+	for (i = 0; i + 8 <= n; i += 8) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *) (src + i));
+		const __m256i out = _mm256_or_si256(_mm256_cmpgt_epi32(vlo, v),
+						    _mm256_cmpgt_epi32(v, vhi));
+		const unsigned m = ~(unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(out));
+		rangescan_store4(dst, c, oids, m & 0xF);
+		oids = _mm256_add_epi64(oids, four);
+		rangescan_store4(dst, c, oids, (m >> 4) & 0xF);
+		oids = _mm256_add_epi64(oids, four);
+	}
+	return c + fullrange_int_scalar(src + i, n - i, lo, hi, o + i, dst + c);
+}
+
+__attribute__((__target__("avx2")))
+static BUN
+fullrange_lng_avx2(const lng *restrict src, BUN n, lng lo, lng hi,
+		   oid o, oid *restrict dst)
+{
+	const __m256i vlo = _mm256_set1_epi64x(lo);
+	const __m256i vhi = _mm256_set1_epi64x(hi);
+	const __m256i four = _mm256_set1_epi64x(4);
+	__m256i oids = _mm256_add_epi64(_mm256_set1_epi64x((long long) o),
+					_mm256_set_epi64x(3, 2, 1, 0));
+	BUN i, c = 0;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		const __m256i v = _mm256_loadu_si256((const __m256i *) (src + i));
+		const __m256i out = _mm256_or_si256(_mm256_cmpgt_epi64(vlo, v),
+						    _mm256_cmpgt_epi64(v, vhi));
+		rangescan_store4(dst, c, oids,
+				 ~(unsigned) _mm256_movemask_pd(_mm256_castsi256_pd(out)) & 0xF);
+		oids = _mm256_add_epi64(oids, four);
+	}
+	return c + fullrange_lng_scalar(src + i, n - i, lo, hi, o + i, dst + c);
+}
+
+__attribute__((__target__("avx2")))
+static BUN
+fullrange_dbl_avx2(const dbl *restrict src, BUN n, dbl lo, dbl hi,
+		   oid o, oid *restrict dst)
+{
+	const __m256d vlo = _mm256_set1_pd(lo);
+	const __m256d vhi = _mm256_set1_pd(hi);
+	const __m256i four = _mm256_set1_epi64x(4);
+	__m256i oids = _mm256_add_epi64(_mm256_set1_epi64x((long long) o),
+					_mm256_set_epi64x(3, 2, 1, 0));
+	BUN i, c = 0;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		const __m256d v = _mm256_loadu_pd(src + i);
+		/* ordered comparisons: NaN (nil) never qualifies */
+		const __m256d in = _mm256_and_pd(_mm256_cmp_pd(v, vlo, _CMP_GE_OQ),
+						 _mm256_cmp_pd(v, vhi, _CMP_LE_OQ));
+		rangescan_store4(dst, c, oids, (unsigned) _mm256_movemask_pd(in));
+		oids = _mm256_add_epi64(oids, four);
+	}
+	return c + fullrange_dbl_scalar(src + i, n - i, lo, hi, o + i, dst + c);
+}
+
+__attribute__((__target__("sse4.2")))
+static BUN
+fullrange_int_sse42(const int *restrict src, BUN n, int lo, int hi,
+		    oid o, oid *restrict dst)
+{
+	const __m128i vlo = _mm_set1_epi32(lo);
+	const __m128i vhi = _mm_set1_epi32(hi);
+	BUN i, c = 0;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+		const __m128i out = _mm_or_si128(_mm_cmpgt_epi32(vlo, v),
+						 _mm_cmpgt_epi32(v, vhi));
+		const unsigned m = ~(unsigned) _mm_movemask_ps(_mm_castsi128_ps(out));
+		rangescan_emit(dst, c, o + i, m, 4);
+	}
+	return c + fullrange_int_scalar(src + i, n - i, lo, hi, o + i, dst + c);
+}
+
+__attribute__((__target__("sse4.2")))
+static BUN
+fullrange_lng_sse42(const lng *restrict src, BUN n, lng lo, lng hi,
+		    oid o, oid *restrict dst)
+{
+	const __m128i vlo = _mm_set1_epi64x(lo);
+	const __m128i vhi = _mm_set1_epi64x(hi);
+	BUN i, c = 0;
+
+	for (i = 0; i + 2 <= n; i += 2) {
+		const __m128i v = _mm_loadu_si128((const __m128i *) (src + i));
+		const __m128i out = _mm_or_si128(_mm_cmpgt_epi64(vlo, v),
+						 _mm_cmpgt_epi64(v, vhi));
+		const unsigned m = ~(unsigned) _mm_movemask_pd(_mm_castsi128_pd(out));
+		rangescan_emit(dst, c, o + i, m, 2);
+	}
+	return c + fullrange_lng_scalar(src + i, n - i, lo, hi, o + i, dst + c);
+}
+
+__attribute__((__target__("sse4.2")))
+static BUN
+fullrange_dbl_sse42(const dbl *restrict src, BUN n, dbl lo, dbl hi,
+		    oid o, oid *restrict dst)
+{
+	const __m128d vlo = _mm_set1_pd(lo);
+	const __m128d vhi = _mm_set1_pd(hi);
+	BUN i, c = 0;
+
+	for (i = 0; i + 2 <= n; i += 2) {
+		const __m128d v = _mm_loadu_pd(src + i);
+		const __m128d in = _mm_and_pd(_mm_cmpge_pd(v, vlo),
+					      _mm_cmple_pd(v, vhi));
+		const unsigned m = (unsigned) _mm_movemask_pd(in);
+		rangescan_emit(dst, c, o + i, m, 2);
+	}
+	return c + fullrange_dbl_scalar(src + i, n - i, lo, hi, o + i, dst + c);
+}
+
+/* run-time selection of the best version of the kernels */
+#define rangedispatch(TYPE)						\
+static BUN								\
+fullrange_##TYPE(const TYPE *restrict src, BUN n,			\
+		 TYPE lo, TYPE hi, oid o, oid *restrict dst)		\
+{									\
+	if (__builtin_cpu_supports("avx2"))				\
+		return fullrange_##TYPE##_avx2(src, n, lo, hi, o, dst);	\
+	if (__builtin_cpu_supports("sse4.2"))				\
+		return fullrange_##TYPE##_sse42(src, n, lo, hi, o, dst); \
+	return fullrange_##TYPE##_scalar(src, n, lo, hi, o, dst);	\
+}
+
+rangedispatch(int)
+rangedispatch(lng)
+rangedispatch(dbl)
+
+#else
+
+#define fullrange_int	fullrange_int_scalar
+#define fullrange_lng	fullrange_lng_scalar
+#define fullrange_dbl	fullrange_dbl_scalar
+
+#endif
+
+/* call the kernel for the next N values of the scan */
+#define fullscan_range(TYPE, N)						\
+	fullrange_##TYPE(src + p, (N), rlo, rhi, (oid) (p + off), dst + cnt)
+#define candscan_range(TYPE, N)						\
+	candrange_##TYPE(src, candlist + (p - r), (N), rlo, rhi, (oid) off, dst + cnt)
+
+/* blocked range scan; rlo and rhi must have been set */
+#define rangeloop(NAME, TYPE)						\
+	do {								\
+		ALGODEBUG fprintf(stderr,				\
+				  "#BATselect(b=" ALGOBATFMT ",s=" ALGOOPTBATFMT ",anti=%d): " \
+				  "%s range\n",				\
+				  ALGOBATPAR(b),			\
+				  ALGOOPTBATPAR(s),			\
+				  anti, #NAME);				\
+		while (p < q) {						\
+			BUN n = MIN(q - p, RANGESCAN_BLOCK);		\
+			if (cnt + n > BATcapacity(bn)) {		\
+				BUN ncap = BATcapacity(bn) +		\
+					(BUN) ((dbl) cnt / (dbl) (p == r ? 1 : p - r) \
+					       * (dbl) (q-p) * 1.1 + 1024); \
+				if (ncap > maximum)			\
+					ncap = maximum;			\
+				/* we write all n oids, even if	\
+				 * maximum is an exact result size */	\
+				if (ncap < cnt + n)			\
+					ncap = cnt + n;			\
+				BATsetcount(bn, cnt);			\
+				if (BATextend(bn, ncap) != GDK_SUCCEED) { \
+					BBPreclaim(bn);			\
+					return BUN_NONE;		\
+				}					\
+				dst = (oid *) Tloc(bn, 0);		\
+			}						\
+			cnt += NAME##_range(TYPE, n);			\
+			p += n;						\
+		}							\
+	} while (false)
+
 #define choose(NAME, CAND, TEST, TYPE)			\
 	do {						\
 		if (use_imprints) {			\
@@ -495,6 +837,7 @@ NAME##_##TYPE(BAT *b, BAT *s, BAT *bn, const TYPE *tl, const TYPE *th,	\
 {									\
 	TYPE vl = *tl;							\
 	TYPE vh = *th;							\
+	TYPE rlo, rhi;							\
 	TYPE imp_min;							\
 	TYPE imp_max;							\
 	TYPE v;								\
@@ -532,20 +875,36 @@ NAME##_##TYPE(BAT *b, BAT *s, BAT *bn, const TYPE *tl, const TYPE *th,	\
 		assert(!use_imprints);					\
 		if (lnil)						\
 			scanloop(NAME, CAND, is_##TYPE##_nil(v));	\
-		else							\
-			scanloop(NAME, CAND, v == vl);			\
+		else {							\
+			rlo = rhi = vl;					\
+			rangeloop(NAME, TYPE);				\
+		}							\
 	} else if (anti) {						\
 		if (b->tnonil) {					\
 			choose(NAME, CAND, (v <= vl || v >= vh), TYPE);	\
 		} else {						\
 			choose(NAME, CAND, !is_##TYPE##_nil(v) && (v <= vl || v >= vh), TYPE); \
 		}							\
-	} else if (b->tnonil && vl == minval) {				\
-		choose(NAME, CAND, v <= vh, TYPE);			\
-	} else if (vh == maxval) {					\
-		choose(NAME, CAND, v >= vl, TYPE);			\
+	} else if (use_imprints) {					\
+		if (b->tnonil && vl == minval) {			\
+			bitswitch(CAND, v <= vh, TYPE);			\
+		} else if (vh == maxval) {				\
+			bitswitch(CAND, v >= vl, TYPE);			\
+		} else {						\
+			bitswitch(CAND, v >= vl && v <= vh, TYPE);	\
+		}							\
 	} else {							\
-		choose(NAME, CAND, v >= vl && v <= vh, TYPE);		\
+		if (b->tnonil && vl == minval) {			\
+			rlo = LOWEST##TYPE;				\
+			rhi = vh;					\
+		} else if (vh == maxval) {				\
+			rlo = vl;					\
+			rhi = HIGHEST##TYPE;				\
+		} else {						\
+			rlo = vl;					\
+			rhi = vh;					\
+		}							\
+		rangeloop(NAME, TYPE);					\
 	}								\
 	return cnt;							\
 }
@@ -744,7 +1103,7 @@ fullscan_str(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 			  ALGOBATPAR(b), ALGOOPTBATPAR(s), anti);
 
 	if ((pos = strLocate(b->tvheap, tl)) == 0)
-		return 0;
+		return cnt;
 	assert(pos >= GDK_VAROFFSET);
 	switch (b->twidth) {
 	case 1: {
@@ -836,11 +1195,648 @@ scan_sel(candscan, o = *candlist++, w = (BUN) ((*(oid *) Tloc(s,q?(q - 1):0)) +
 /* scan/imprints select without candidates */
 scan_sel(fullscan, o = (oid) (p+off), w = (BUN) (q+off))
 
+/* zone map select
+ *
+ * The zone map (see gdk_zonemap.c) gives for each block of values the
+ * smallest and the largest non-nil value and the number of nils, or
+ * for strings, a Bloom filter of the values and the number of nils.
+ * Blocks in which no value can qualify are skipped, blocks in which
+ * all values qualify are added in their entirety, and runs of the
+ * remaining blocks are scanned with the normal scan select. */
+
+enum zmverdict {
+	ZM_NONE,		/* no value in the block qualifies */
+	ZM_ALL,			/* all values in the block qualify */
+	ZM_SCAN,		/* the block needs to be scanned */
+};
+
+/* for strings, the zone map can only be used for equi-selects */
+static bool
+zmtype(int tpe, bool equi)
+{
+	switch (ATOMbasetype(tpe)) {
+	case TYPE_str:
+		return equi;
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/* tl and th are normalized (see NORMALIZE below): a value v
+ * qualifies if it is not nil and vl <= v <= vh, or for an anti
+ * select, if it is not nil and v <= vl || v >= vh */
+#define zmcheck(TYPE)							\
+	do {								\
+		TYPE mn = ZMmin(TYPE, rec), mx = ZMmax(TYPE, rec);	\
+		TYPE vl = *(const TYPE *) tl, vh = *(const TYPE *) th;	\
+		if (anti) {						\
+			if (mn > vl && mx < vh)				\
+				return ZM_NONE;				\
+			if (nils == 0 && (mx <= vl || mn >= vh))	\
+				return ZM_ALL;				\
+		} else {						\
+			if (mx < vl || mn > vh)				\
+				return ZM_NONE;				\
+			if (nils == 0 && mn >= vl && mx <= vh)		\
+				return ZM_ALL;				\
+		}							\
+		return ZM_SCAN;						\
+	} while (false)
+
+/* Determine what to do with the values of b starting at position p
+ * (which is at most e); *end is set to the end of the block (or e,
+ * whichever comes first).  Position p of b is position p + zoff in
+ * the zone map. */
+static enum zmverdict
+zmnext(BAT *b, const Heap *zm, BUN zoff, BUN p, BUN e, BUN *end,
+       const void *tl, const void *th, bool equi, bool anti, bool lnil)
+{
+	BUN covered = (BUN) ((const oid *) zm->base)[1];
+	BUN bs = ZMblock(b), blk, first, last, nils;
+	size_t rs = ZMrecsize(b);
+	unsigned int h1, h2, hp;
+	char *rec;
+
+	p += zoff;
+	if (p >= covered) {
+		/* not (yet) covered by the zone map */
+		*end = e;
+		return ZM_SCAN;
+	}
+	blk = p / bs;
+	first = blk * bs;
+	last = MIN(first + bs, covered);
+	*end = MIN(last - zoff, e);
+	rec = ZMrec(zm, rs, blk);
+	nils = ZMnils(rs, rec);
+	if (equi && lnil)
+		return nils == 0 ? ZM_NONE : nils == last - first ? ZM_ALL : ZM_SCAN;
+	if (nils == last - first)
+		return ZM_NONE;
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		zmcheck(bte);
+	case TYPE_sht:
+		zmcheck(sht);
+	case TYPE_int:
+		zmcheck(int);
+	case TYPE_lng:
+		zmcheck(lng);
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		zmcheck(hge);
+#endif
+	case TYPE_flt:
+		zmcheck(flt);
+	case TYPE_dbl:
+		zmcheck(dbl);
+	case TYPE_str:
+		assert(equi);
+		ZMstrbits((const char *) tl, &h1, &h2, &hp);
+		if (!ZMstrmaybe(rec, (const char *) tl, false, false, h1, h2, hp))
+			return ZM_NONE;
+		return ZM_SCAN;
+	default:
+		assert(0);
+		return ZM_SCAN;
+	}
+}
+
+/* return whether the zone map allows us to skip or accept any block
+ * of values [p, e) of b */
+static bool
+zmuseful(BAT *b, const Heap *zm, BUN zoff, BUN p, BUN e,
+	 const void *tl, const void *th, bool equi, bool anti, bool lnil)
+{
+	BUN end;
+
+	for (; p < e; p = end)
+		if (zmnext(b, zm, zoff, p, e, &end, tl, th, equi, anti, lnil) != ZM_SCAN)
+			return true;
+	return false;
+}
+
+/* scan the run [p, q) of blocks */
+#ifdef HAVE_HGE
+#define zmscan_hge	case TYPE_hge: cnt = fullscan_hge(scanargs); break;
+#else
+#define zmscan_hge
+#endif
+#define zmscan()							\
+	do {								\
+		switch (ATOMbasetype(b->ttype)) {			\
+		case TYPE_bte: cnt = fullscan_bte(scanargs); break;	\
+		case TYPE_sht: cnt = fullscan_sht(scanargs); break;	\
+		case TYPE_int: cnt = fullscan_int(scanargs); break;	\
+		case TYPE_lng: cnt = fullscan_lng(scanargs); break;	\
+		zmscan_hge						\
+		case TYPE_flt: cnt = fullscan_flt(scanargs); break;	\
+		case TYPE_dbl: cnt = fullscan_dbl(scanargs); break;	\
+		case TYPE_str: cnt = fullscan_str(scanargs); break;	\
+		default: assert(0);					\
+		}							\
+		if (cnt == BUN_NONE)					\
+			return BUN_NONE;				\
+		dst = (oid *) Tloc(bn, 0);				\
+	} while (false)
+
+static BUN
+zonemapselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
+	      bool li, bool hi, bool equi, bool anti, bool lval, bool hval,
+	      bool lnil, BUN r, BUN e, lng off, BUN maximum,
+	      const Heap *zm, BUN zoff)
+{
+	BUN p, q, end, n, cnt = 0;
+	oid o, *restrict dst = (oid *) Tloc(bn, 0);
+	const oid *candlist = NULL;
+	const bool use_imprints = false;
+
+	ALGODEBUG fprintf(stderr,
+			  "#BATselect(b=" ALGOBATFMT ",s=" ALGOOPTBATFMT ",anti=%d): "
+			  "zone map select\n",
+			  ALGOBATPAR(b), ALGOOPTBATPAR(s), anti);
+	/* [p, q) is the run of blocks that needs to be scanned */
+	for (p = q = r; q < e; p = q = end) {
+		switch (zmnext(b, zm, zoff, q, e, &end, tl, th, equi, anti, lnil)) {
+		case ZM_SCAN:
+			/* extend the run with the blocks that follow
+			 * and also need to be scanned */
+			for (q = end; q < e; q = end)
+				if (zmnext(b, zm, zoff, q, e, &end, tl, th, equi, anti, lnil) != ZM_SCAN)
+					break;
+			zmscan();
+			end = q;
+			break;
+		case ZM_ALL:
+			n = end - q;
+			if (cnt + n > BATcapacity(bn)) {
+				BUN ncap = cnt + n +
+					(BUN) ((dbl) (cnt + n) / (dbl) (end - r)
+					       * (dbl) (e - end) * 1.1 + 1024);
+				if (ncap > maximum)
+					ncap = maximum;
+				if (ncap < cnt + n)
+					ncap = cnt + n;
+				BATsetcount(bn, cnt);
+				if (BATextend(bn, ncap) != GDK_SUCCEED) {
+					BBPreclaim(bn);
+					return BUN_NONE;
+				}
+				dst = (oid *) Tloc(bn, 0);
+			}
+			for (o = (oid) (q + off); n > 0; n--)
+				dst[cnt++] = o++;
+			break;
+		case ZM_NONE:
+			break;
+		}
+	}
+	return cnt;
+}
+
+
+/* packed select
+ *
+ * The packed copy of a column (see gdk_packed.c) stores for each
+ * block of values the smallest value and the differences of the
+ * values with it in as few bits as possible.  For each block, the
+ * bounds of the select are translated to bounds on these codes, so
+ * that blocks in which no value or all values qualify are dealt with
+ * without looking at the values, and in the other blocks, the codes
+ * are compared instead of the (much larger) values. */
+
+/* Determine which codes of a block with frame of reference base,
+ * codes of w bits, and nils (if hasnil) qualify: those in [*l1, *h1]
+ * or in [*l2, *h2].  Like for zone maps, tl and th are normalized,
+ * see NORMALIZE below. */
+static enum zmverdict
+pknext(lng base, unsigned int w, bool hasnil, lng vl, lng vh,
+       bool equi, bool anti, bool lnil,
+       ulng *l1, ulng *h1, ulng *l2, ulng *h2)
+{
+	ulng nilc = PKmask(w), maxc;
+	lng mx;
+
+	if (equi && lnil) {
+		if (!hasnil)
+			return ZM_NONE;
+		*l1 = *h1 = *l2 = *h2 = nilc;
+		return w == 0 ? ZM_ALL : ZM_SCAN;
+	}
+	if (hasnil && w == 0)
+		return ZM_NONE;		/* only nils */
+	/* largest code of a non-nil value */
+	maxc = hasnil ? nilc - 1 : nilc;
+	mx = (lng) ((ulng) base + maxc);
+	if (anti) {
+		/* v <= vl || v >= vh */
+		if (vl < base && vh > mx)
+			return ZM_NONE;
+		*l1 = 0;
+		*h1 = vl < base ? 0 : vl >= mx ? maxc : (ulng) vl - (ulng) base;
+		*l2 = vh > mx ? maxc : vh <= base ? 0 : (ulng) vh - (ulng) base;
+		*h2 = maxc;
+		if (vl < base) {
+			*l1 = *l2;	/* only the upper range */
+			*h1 = *h2;
+		} else if (vh > mx) {
+			*l2 = *l1;	/* only the lower range */
+			*h2 = *h1;
+		}
+		if (!hasnil &&
+		    ((*l1 == 0 && *h1 == maxc) ||
+		     (*l2 == 0 && *h2 == maxc) ||
+		     (*l1 == 0 && *h2 == maxc && *h1 + 1 >= *l2)))
+			return ZM_ALL;
+		return ZM_SCAN;
+	}
+	/* vl <= v <= vh */
+	if (vh < base || vl > mx)
+		return ZM_NONE;
+	*l1 = *l2 = vl <= base ? 0 : (ulng) vl - (ulng) base;
+	*h1 = *h2 = vh >= mx ? maxc : (ulng) vh - (ulng) base;
+	if (!hasnil && *l1 == 0 && *h1 == maxc)
+		return ZM_ALL;
+	return ZM_SCAN;
+}
+
+static BUN
+packedselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
+	     bool equi, bool anti, bool lnil, BUN r, BUN e, lng off,
+	     BUN maximum, const Heap *pk, BUN poff)
+{
+	const ulng *dir = PKdir(pk), *data = PKdata(pk), *restrict d;
+	BUN p, end, blk, i, n, cnt = 0;
+	oid o, *restrict dst = (oid *) Tloc(bn, 0);
+	lng vl = 0, vh = 0;
+	ulng l1 = 0, h1 = 0, l2 = 0, h2 = 0, c, codes[PACKED_BLOCK];
+	unsigned int w;
+
+	ALGODEBUG fprintf(stderr,
+			  "#BATselect(b=" ALGOBATFMT ",s=" ALGOOPTBATFMT ",anti=%d): "
+			  "packed select\n",
+			  ALGOBATPAR(b), ALGOOPTBATPAR(s), anti);
+	if (!(equi && lnil)) {
+		switch (ATOMbasetype(b->ttype)) {
+		case TYPE_sht:
+			vl = *(const sht *) tl;
+			vh = equi ? vl : *(const sht *) th;
+			break;
+		case TYPE_int:
+			vl = *(const int *) tl;
+			vh = equi ? vl : *(const int *) th;
+			break;
+		case TYPE_lng:
+			vl = *(const lng *) tl;
+			vh = equi ? vl : *(const lng *) th;
+			break;
+		default:
+			assert(0);
+		}
+	}
+	for (p = r; p < e; p = end) {
+		blk = (p + poff) / PACKED_BLOCK;
+		end = MIN(e, (blk + 1) * PACKED_BLOCK - poff);
+		w = PKwidth(dir, blk);
+		switch (pknext(PKbase(dir, blk), w, PKhasnil(dir, blk),
+			       vl, vh, equi, anti, lnil, &l1, &h1, &l2, &h2)) {
+		case ZM_NONE:
+			break;
+		case ZM_ALL:
+			n = end - p;
+			if (cnt + n > BATcapacity(bn)) {
+				BUN ncap = cnt + n +
+					(BUN) ((dbl) (cnt + n) / (dbl) (end - r)
+					       * (dbl) (e - end) * 1.1 + 1024);
+				if (ncap > maximum)
+					ncap = maximum;
+				if (ncap < cnt + n)
+					ncap = cnt + n;
+				BATsetcount(bn, cnt);
+				if (BATextend(bn, ncap) != GDK_SUCCEED) {
+					BBPreclaim(bn);
+					return BUN_NONE;
+				}
+				dst = (oid *) Tloc(bn, 0);
+			}
+			for (o = (oid) (p + off); n > 0; n--)
+				dst[cnt++] = o++;
+			break;
+		case ZM_SCAN:
+			d = data + PKoffset(dir, blk);
+			PACKdecode(d, p + poff - blk * PACKED_BLOCK, end - p, w, codes);
+			for (i = 0; p < end; p++, i++) {
+				c = codes[i];
+				if (c - l1 <= h1 - l1 || c - l2 <= h2 - l2) {
+					buninsfix(bn, dst, cnt, (oid) (p + off),
+						  (BUN) ((dbl) cnt / (dbl) (p == r ? 1 : p - r)
+							 * (dbl) (e - p) * 1.1 + 1024),
+						  maximum, BUN_NONE);
+					cnt++;
+				}
+			}
+			break;
+		}
+	}
+	return cnt;
+}
+
+/* run index select
+ *
+ * With a run index (see gdk_rle.c), the predicate is evaluated once
+ * for each run, and the positions of a qualifying run are added as a
+ * dense range.  Like for zone maps and packed heaps, tl and th are
+ * normalized, see NORMALIZE below. */
+
+static BUN
+rleselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
+	  bool equi, bool anti, bool lnil, BUN r, BUN e, lng off,
+	  BUN maximum, const Heap *rh, BUN roff)
+{
+	const lng *runs = RLEruns(rh);
+	BUN i, nruns = RLEnruns(rh), p, end, n, cnt = 0;
+	oid o, *restrict dst = (oid *) Tloc(bn, 0);
+	lng v, vl = 0, vh = 0, nil = RLEnil(b->ttype);
+	bool match;
+
+	ALGODEBUG fprintf(stderr,
+			  "#BATselect(b=" ALGOBATFMT ",s=" ALGOOPTBATFMT ",anti=%d): "
+			  "run index select\n",
+			  ALGOBATPAR(b), ALGOOPTBATPAR(s), anti);
+	if (r >= e)
+		return 0;
+	if (!(equi && lnil)) {
+		switch (ATOMbasetype(b->ttype)) {
+		case TYPE_bte:
+			vl = *(const bte *) tl;
+			vh = equi ? vl : *(const bte *) th;
+			break;
+		case TYPE_sht:
+			vl = *(const sht *) tl;
+			vh = equi ? vl : *(const sht *) th;
+			break;
+		case TYPE_int:
+			vl = *(const int *) tl;
+			vh = equi ? vl : *(const int *) th;
+			break;
+		case TYPE_lng:
+			vl = *(const lng *) tl;
+			vh = equi ? vl : *(const lng *) th;
+			break;
+		default:
+			assert(0);
+		}
+	}
+	for (i = RLEfind(rh, r + roff); i < nruns; i++) {
+		p = MAX(RLEstart(runs, i), r + roff) - roff;
+		end = MIN(RLEend(rh, runs, i), e + roff) - roff;
+		if (p >= end)
+			break;
+		v = RLEvalue(runs, i);
+		if (equi && lnil)
+			match = v == nil;
+		else if (anti)
+			match = v != nil && (v <= vl || v >= vh);
+		else
+			match = vl <= v && v <= vh;
+		if (!match)
+			continue;
+		n = end - p;
+		if (cnt + n > BATcapacity(bn)) {
+			BUN ncap = MAX(cnt + n, 2 * BATcapacity(bn));
+
+			if (ncap > maximum)
+				ncap = maximum;
+			if (ncap < cnt + n)
+				ncap = cnt + n;
+			BATsetcount(bn, cnt);
+			if (BATextend(bn, ncap) != GDK_SUCCEED) {
+				BBPreclaim(bn);
+				return BUN_NONE;
+			}
+			dst = (oid *) Tloc(bn, 0);
+		}
+		for (o = (oid) (p + off); n > 0; n--)
+			dst[cnt++] = o++;
+	}
+	return cnt;
+}
+
+/* dictionary select
+ *
+ * If the string heap of b is fully double eliminated (see
+ * GDK_ELIMDOUBLES), every distinct string occurs exactly once in the
+ * heap, so the offsets in the tail are codes into a dictionary (the
+ * heap).  A predicate can then be evaluated once for each string in
+ * the dictionary, after which the select is a scan over the codes
+ * that only needs to test a bit for each value. */
+
+/* Return whether it is cheaper to evaluate a predicate on the
+ * dictionary of the string column b than on n values of b. */
+bool
+BATdictusable(BAT *b, BUN n)
+{
+	return ATOMstorage(b->ttype) == TYPE_str &&
+		GDK_ELIMDOUBLES(b->tvheap) &&
+		/* a bound on the size of the dictionary */
+		n >= (BUN) (b->tvheap->free / GDK_VARALIGN);
+}
+
+/* Return a bitmap with a bit set for each code (heap position) of a
+ * string in the dictionary of b for which pred returns true. */
+static uint64_t *
+dictmap(BAT *b, bool (*pred)(const char *, void *), void *arg)
+{
+	const Heap *h = b->tvheap;
+	var_t *codes;
+	uint64_t *map;
+	BUN i, n;
+
+	if ((codes = strDictionary(h, &n)) == NULL)
+		return NULL;
+	if ((map = GDKzalloc((h->free / 64 + 1) * sizeof(uint64_t))) == NULL) {
+		GDKfree(codes);
+		return NULL;
+	}
+	for (i = 0; i < n; i++)
+		if ((*pred)(h->base + codes[i], arg))
+			map[codes[i] / 64] |= (uint64_t) 1 << (codes[i] % 64);
+	GDKfree(codes);
+	return map;
+}
+
+struct dictrange {
+	const void *tl, *th;
+	bool li, hi, anti, lval, hval;
+	int (*cmp)(const void *, const void *);
+};
+
+/* the predicate of a range select on strings (see fullscan_any) */
+static bool
+dictrangepred(const char *v, void *arg)
+{
+	const struct dictrange *r = arg;
+	int c;
+
+	if (strNil(v))
+		return false;
+	if (r->anti)
+		return (r->lval &&
+			((c = (*r->cmp)(r->tl, v)) > 0 ||
+			 (!r->li && c == 0))) ||
+			(r->hval &&
+			 ((c = (*r->cmp)(r->th, v)) < 0 ||
+			  (!r->hi && c == 0)));
+	return (!r->lval ||
+		(c = (*r->cmp)(r->tl, v)) < 0 ||
+		(r->li && c == 0)) &&
+		(!r->hval ||
+		 (c = (*r->cmp)(r->th, v)) > 0 ||
+		 (r->hi && c == 0));
+}
+
+#define DICTSCAN(TYPE, OFF)						\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		var_t x;						\
+		if (candlist) {						\
+			for (; p < q; p++) {				\
+				o = *candlist++;			\
+				x = (var_t) vals[o - off] + (OFF);	\
+				if ((map[x / 64] >> (x % 64)) & 1) {	\
+					buninsfix(bn, dst, cnt, o,	\
+						  (BUN) ((dbl) cnt / (dbl) (p == r ? 1 : p - r) \
+							 * (dbl) (q-p) * 1.1 + 1024), \
+						  maximum, BUN_NONE);	\
+					cnt++;				\
+				}					\
+			}						\
+		} else {						\
+			for (; p < q; p++) {				\
+				x = (var_t) vals[p] + (OFF);		\
+				if ((map[x / 64] >> (x % 64)) & 1) {	\
+					buninsfix(bn, dst, cnt, (oid) (p + off), \
+						  (BUN) ((dbl) cnt / (dbl) (p == r ? 1 : p - r) \
+							 * (dbl) (q-p) * 1.1 + 1024), \
+						  maximum, BUN_NONE);	\
+					cnt++;				\
+				}					\
+			}						\
+		}							\
+	} while (false)
+
+/* Add the oids of the values of b whose code has a bit set in map to
+ * bn (which contains cnt values).  If candlist is set, the values
+ * are given by the candidates candlist[0..q-p), otherwise they are
+ * the values at positions [p, q) of b. */
+static BUN
+dictscan(BAT *b, BAT *bn, const uint64_t *map, const oid *candlist,
+	 BUN p, BUN q, BUN cnt, lng off, BUN maximum)
+{
+	oid o, *restrict dst = (oid *) Tloc(bn, 0);
+	const BUN r = p;
+
+	switch (b->twidth) {
+	case 1:
+		DICTSCAN(uint8_t, GDK_VAROFFSET);
+		break;
+	case 2:
+		DICTSCAN(uint16_t, GDK_VAROFFSET);
+		break;
+#if SIZEOF_VAR_T == 8
+	case 4:
+		DICTSCAN(uint32_t, 0);
+		break;
+#endif
+	default:
+		DICTSCAN(var_t, 0);
+		break;
+	}
+	return cnt;
+}
+
+/* Return a candidate list with the candidates of s (or, if s is NULL,
+ * the values of b) for which pred returns true, evaluating pred only
+ * once for each distinct string.  The string heap of b must be fully
+ * double eliminated (see BATdictusable). */
+BAT *
+BATdictselect(BAT *b, BAT *s, bool (*pred)(const char *v, void *arg), void *arg)
+{
+	BAT *bn;
+	uint64_t *map;
+	const oid *candlist = NULL;
+	BUN p, q, cnt;
+	oid o;
+	lng off, t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+	BATcheck(b, "BATdictselect", NULL);
+	assert(ATOMstorage(b->ttype) == TYPE_str);
+	assert(GDK_ELIMDOUBLES(b->tvheap));
+
+	off = (lng) b->hseqbase;
+	if (s && !BATtdense(s)) {
+		assert(s->tsorted);
+		assert(s->tkey);
+		o = b->hseqbase + BATcount(b);
+		q = SORTfndfirst(s, &o);
+		p = SORTfndfirst(s, &b->hseqbase);
+		candlist = (const oid *) Tloc(s, p);
+	} else if (s) {
+		p = (BUN) s->tseqbase;
+		q = p + BATcount(s);
+		if ((oid) p < b->hseqbase)
+			p = (BUN) b->hseqbase;
+		if ((oid) q > b->hseqbase + BATcount(b))
+			q = (BUN) b->hseqbase + BATcount(b);
+		if (p > q)
+			p = q;
+		p = (BUN) (p - off);
+		q = (BUN) (q - off);
+	} else {
+		p = 0;
+		q = BATcount(b);
+	}
+	if ((bn = COLnew(0, TYPE_oid, q - p, TRANSIENT)) == NULL)
+		return NULL;
+	if ((map = dictmap(b, pred, arg)) == NULL) {
+		BBPreclaim(bn);
+		return NULL;
+	}
+	cnt = dictscan(b, bn, map, candlist, p, q, 0, off, q - p);
+	GDKfree(map);
+	if (cnt == BUN_NONE)
+		return NULL;
+	BATsetcount(bn, cnt);
+	bn->tsorted = true;
+	bn->trevsorted = cnt <= 1;
+	bn->tkey = true;
+	bn->tnil = false;
+	bn->tnonil = true;
+	bn->tseqbase = cnt == 0 ? 0 : cnt == 1 ? *(const oid *) Tloc(bn, 0) : oid_nil;
+	ALGODEBUG fprintf(stderr, "#BATdictselect(b=" ALGOBATFMT
+			  ",s=" ALGOOPTBATFMT ")=" ALGOBATFMT
+			  " (" LLFMT " usec)\n",
+			  ALGOBATPAR(b), ALGOOPTBATPAR(s),
+			  ALGOBATPAR(bn), GDKusec() - t0);
+	return virtualize(bn);
+}
 
 static BAT *
 scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 	   bool li, bool hi, bool equi, bool anti, bool lval, bool hval,
-	   bool lnil, BUN maximum, bool use_imprints)
+	   bool lnil, BUN maximum, bool use_imprints, bool use_zonemap,
+	   bool use_packed, bool use_rle)
 {
 #ifndef NDEBUG
 	int (*cmp)(const void *, const void *);
@@ -850,6 +1846,9 @@ scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 	oid o, *restrict dst;
 	lng off;
 	const oid *candlist;
+	const Heap *zm = NULL, *pk = NULL, *rh = NULL;
+	BUN zoff = 0, poff = 0, roff = 0;
+	uint64_t *dict = NULL;
 
 	assert(b != NULL);
 	assert(bn != NULL);
@@ -867,6 +1866,61 @@ scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 
 	assert(!lval || !hval || (*cmp)(tl, th) <= 0);
 
+	/* use the run index of b (or of its parent) if it exists
+	 * and covers b; it is preferred over everything else since it
+	 * evaluates the predicate only once for each run */
+	if (use_rle) {
+		assert(s == NULL || BATtdense(s));
+		if ((rh = RLEget(b, &roff)) != NULL) {
+			use_packed = false;
+			use_zonemap = false;
+			use_imprints = false;
+		} else {
+			use_rle = false;
+		}
+	}
+
+	/* use the packed copy of b (or of its parent) if it exists
+	 * and covers b; it is preferred over the zone map and over
+	 * imprints since it allows skipping and accepting blocks like
+	 * a zone map, and it needs less memory to be scanned */
+	if (use_packed) {
+		BAT *pb = VIEWtparent(b) ? BBPdescriptor(VIEWtparent(b)) : b;
+
+		assert(s == NULL || BATtdense(s));
+		poff = (BUN) ((const char *) Tloc(b, 0) - (const char *) Tloc(pb, 0)) >> b->tshift;
+		if (BATcheckpacked(pb) &&
+		    (BUN) ((const oid *) pb->tpacked->base)[1] >= poff + BATcount(b)) {
+			pk = pb->tpacked;
+			use_zonemap = false;
+			use_imprints = false;
+		} else {
+			use_packed = false;
+		}
+	}
+
+	/* use the zone map of b (or of its parent), creating it if
+	 * necessary, but if we could use imprints, only if the zone
+	 * map allows us to skip or accept at least some blocks */
+	if (use_zonemap) {
+		BAT *pb = VIEWtparent(b) ? BBPdescriptor(VIEWtparent(b)) : b;
+
+		assert(s == NULL || BATtdense(s));
+		if (BATzonemap(b) != GDK_SUCCEED) {
+			GDKclrerr();	/* not interested in BATzonemap errors */
+			use_zonemap = false;
+		} else {
+			zm = pb->tzonemap;
+			zoff = (BUN) ((const char *) Tloc(b, 0) - (const char *) Tloc(pb, 0)) >> b->tshift;
+			if (use_imprints &&
+			    !zmuseful(b, zm, zoff, 0, BATcount(b),
+				      tl, th, equi, anti, lnil))
+				use_zonemap = false;
+			else
+				use_imprints = false;
+		}
+	}
+
 	/* build imprints if they do not exist */
 	if (use_imprints && (BATimprints(b) != GDK_SUCCEED)) {
 		GDKclrerr();	/* not interested in BATimprints errors */
@@ -879,6 +1933,28 @@ scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 
 	t = ATOMbasetype(b->ttype);
 
+	/* evaluate a range predicate on strings once for each
+	 * distinct value if that is cheaper (equality selects already
+	 * compare offsets, see fullscan_str) */
+	if (t == TYPE_str && !equi && !use_zonemap &&
+	    BATdictusable(b, s ? BATcount(s) : BATcount(b))) {
+		struct dictrange r = {
+			.tl = tl, .th = th,
+			.li = li, .hi = hi, .anti = anti,
+			.lval = lval, .hval = hval,
+			.cmp = ATOMcompare(b->ttype),
+		};
+
+		if ((dict = dictmap(b, dictrangepred, &r)) == NULL) {
+			BBPreclaim(bn);
+			return NULL;
+		}
+		ALGODEBUG fprintf(stderr,
+				  "#BATselect(b=" ALGOBATFMT ",s=" ALGOOPTBATFMT ",anti=%d): "
+				  "dictionary select\n",
+				  ALGOBATPAR(b), ALGOOPTBATPAR(s), anti);
+	}
+
 	if (s && !BATtdense(s)) {
 
 		assert(s->tsorted);
@@ -894,33 +1970,38 @@ scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 		/* call type-specific core scan select function */
 		assert(b->batCapacity >= BATcount(b));
 		assert(s->batCapacity >= BATcount(s));
-		switch (t) {
-		case TYPE_bte:
-			cnt = candscan_bte(scanargs);
-			break;
-		case TYPE_sht:
-			cnt = candscan_sht(scanargs);
-			break;
-		case TYPE_int:
-			cnt = candscan_int(scanargs);
-			break;
-		case TYPE_flt:
-			cnt = candscan_flt(scanargs);
-			break;
-		case TYPE_dbl:
-			cnt = candscan_dbl(scanargs);
-			break;
-		case TYPE_lng:
-			cnt = candscan_lng(scanargs);
-			break;
+		if (dict) {
+			cnt = dictscan(b, bn, dict, candlist, p, q, cnt, off,
+				       BATcapacity(bn) + q - p);
+		} else {
+			switch (t) {
+			case TYPE_bte:
+				cnt = candscan_bte(scanargs);
+				break;
+			case TYPE_sht:
+				cnt = candscan_sht(scanargs);
+				break;
+			case TYPE_int:
+				cnt = candscan_int(scanargs);
+				break;
+			case TYPE_flt:
+				cnt = candscan_flt(scanargs);
+				break;
+			case TYPE_dbl:
+				cnt = candscan_dbl(scanargs);
+				break;
+			case TYPE_lng:
+				cnt = candscan_lng(scanargs);
+				break;
 #ifdef HAVE_HGE
-		case TYPE_hge:
-			cnt = candscan_hge(scanargs);
-			break;
+			case TYPE_hge:
+				cnt = candscan_hge(scanargs);
+				break;
 #endif
-		default:
-			cnt = candscan_any(scanargs);
-			break;
+			default:
+				cnt = candscan_any(scanargs);
+				break;
+			}
 		}
 	} else {
 		if (s) {
@@ -939,38 +2020,54 @@ scanselect(BAT *b, BAT *s, BAT *bn, const void *tl, const void *th,
 		}
 		candlist = NULL;
 		/* call type-specific core scan select function */
-		switch (t) {
-		case TYPE_bte:
-			cnt = fullscan_bte(scanargs);
-			break;
-		case TYPE_sht:
-			cnt = fullscan_sht(scanargs);
-			break;
-		case TYPE_int:
-			cnt = fullscan_int(scanargs);
-			break;
-		case TYPE_flt:
-			cnt = fullscan_flt(scanargs);
-			break;
-		case TYPE_dbl:
-			cnt = fullscan_dbl(scanargs);
-			break;
-		case TYPE_lng:
-			cnt = fullscan_lng(scanargs);
-			break;
+		if (dict) {
+			cnt = dictscan(b, bn, dict, NULL, p, q, cnt, off,
+				       BATcapacity(bn) + q - p);
+		} else if (use_rle) {
+			cnt = rleselect(b, s, bn, tl, th, equi, anti, lnil,
+					p, q, off, maximum, rh, roff);
+		} else if (use_packed) {
+			cnt = packedselect(b, s, bn, tl, th, equi, anti, lnil,
+					   p, q, off, maximum, pk, poff);
+		} else if (use_zonemap) {
+			cnt = zonemapselect(b, s, bn, tl, th, li, hi, equi,
+					    anti, lval, hval, lnil, p, q, off,
+					    maximum, zm, zoff);
+		} else {
+			switch (t) {
+			case TYPE_bte:
+				cnt = fullscan_bte(scanargs);
+				break;
+			case TYPE_sht:
+				cnt = fullscan_sht(scanargs);
+				break;
+			case TYPE_int:
+				cnt = fullscan_int(scanargs);
+				break;
+			case TYPE_flt:
+				cnt = fullscan_flt(scanargs);
+				break;
+			case TYPE_dbl:
+				cnt = fullscan_dbl(scanargs);
+				break;
+			case TYPE_lng:
+				cnt = fullscan_lng(scanargs);
+				break;
 #ifdef HAVE_HGE
-		case TYPE_hge:
-			cnt = fullscan_hge(scanargs);
-			break;
+			case TYPE_hge:
+				cnt = fullscan_hge(scanargs);
+				break;
 #endif
-		case TYPE_str:
-			cnt = fullscan_str(scanargs);
-			break;
-		default:
-			cnt = fullscan_any(scanargs);
-			break;
+			case TYPE_str:
+				cnt = fullscan_str(scanargs);
+				break;
+			default:
+				cnt = fullscan_any(scanargs);
+				break;
+			}
 		}
 	}
+	GDKfree(dict);
 	if (cnt == BUN_NONE) {
 		return NULL;
 	}
@@ -1618,33 +2715,57 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 
 				rs = (const oid *) b->torderidx->base + ORDERIDXOFF;
 				rs += low;
-				bn = COLnew(0, TYPE_oid, high-low, TRANSIENT);
-				if (bn == NULL)
-					return NULL;
-
-				rbn = (oid *) Tloc((bn), 0);
-
-				for (i = low; i < high; i++) {
-					if (vwl <= *rs && *rs < vwh) {
-						*rbn++ = *rs;
-						cnt++;
-					}
-					rs++;
-				}
-				BATsetcount(bn, cnt);
-
-				/* output must be sorted */
-				GDKqsort(Tloc(bn, 0), NULL, NULL, (size_t) bn->batCount, sizeof(oid), 0, TYPE_oid);
-				bn->tsorted = true;
-				bn->trevsorted = bn->batCount <= 1;
-				bn->tkey = true;
-				bn->tseqbase = bn->batCount == 0 ? 0 : bn->batCount == 1 ? * (oid *) Tloc(bn, 0) : oid_nil;
-				bn->tnil = false;
-				bn->tnonil = true;
 				if (s) {
-					s = BATintersectcand(bn, s);
-					BBPunfix(bn->batCacheid);
-					bn = s;
+					/* s is dense: restrict range */
+					assert(BATtdense(s));
+					if (vwl < s->tseqbase)
+						vwl = s->tseqbase;
+					if (vwh > s->tseqbase + BATcount(s))
+						vwh = s->tseqbase + BATcount(s);
+					if (vwh < vwl)
+						vwh = vwl;
+				}
+				if (vwh - vwl <= 64 * (high - low)) {
+					/* the output must be sorted: collect
+					 * the oids in a bitmap which we then
+					 * convert to a candidate list */
+					Candmask m;
+
+					if (CANDmaskinit(&m, vwl, vwh) != GDK_SUCCEED)
+						return NULL;
+					for (i = low; i < high; i++) {
+						if (vwl <= *rs && *rs < vwh)
+							CANDmaskset(&m, *rs);
+						rs++;
+					}
+					bn = CANDmasktocand(&m, high - low);
+					CANDmaskfree(&m);
+					if (bn == NULL)
+						return NULL;
+				} else {
+					bn = COLnew(0, TYPE_oid, high-low, TRANSIENT);
+					if (bn == NULL)
+						return NULL;
+
+					rbn = (oid *) Tloc((bn), 0);
+
+					for (i = low; i < high; i++) {
+						if (vwl <= *rs && *rs < vwh) {
+							*rbn++ = *rs;
+							cnt++;
+						}
+						rs++;
+					}
+					BATsetcount(bn, cnt);
+
+					/* output must be sorted */
+					GDKqsort(Tloc(bn, 0), NULL, NULL, (size_t) bn->batCount, sizeof(oid), 0, TYPE_oid);
+					bn->tsorted = true;
+					bn->trevsorted = bn->batCount <= 1;
+					bn->tkey = true;
+					bn->tseqbase = bn->batCount == 0 ? 0 : bn->batCount == 1 ? * (oid *) Tloc(bn, 0) : oid_nil;
+					bn->tnil = false;
+					bn->tnonil = true;
 				}
 			} else {
 				/* match: [low..high) */
@@ -1820,8 +2941,38 @@ BATselect(BAT *b, BAT *s, const void *tl, const void *th,
 			 (parent != 0 &&
 			  (tmp = BBPquickdesc(parent, 0)) != NULL &&
 			  tmp->batPersistence == PERSISTENT));
+		/* use a zone map if
+		 *   i) there is no candidate list, or a dense one,
+		 *  ii) the type is a numeric type, or it is an
+		 *      equi-select on a string type, and
+		 * iii) b (or its parent) already has a zone map, or
+		 *      it is persistent and large enough.
+		 */
+		bool use_zonemap = (s == NULL || BATtdense(s)) &&
+			zmtype(b->ttype, equi) &&
+			(tmp = parent != 0 ? BBPquickdesc(parent, 0) : b) != NULL &&
+			(tmp->tzonemap != NULL ||
+			 (tmp->batPersistence == PERSISTENT &&
+			  BATcount(tmp) >= ZONEMAP_MINSIZE));
+		/* use the packed copy if
+		 *   i) there is no candidate list, or a dense one, and
+		 *  ii) b (or its parent) has a packed copy.
+		 */
+		bool use_packed = (s == NULL || BATtdense(s)) &&
+			PACKtype(b->ttype) &&
+			(tmp = parent != 0 ? BBPquickdesc(parent, 0) : b) != NULL &&
+			tmp->tpacked != NULL;
+		/* use the run index if
+		 *   i) there is no candidate list, or a dense one, and
+		 *  ii) b (or its parent) has a run index.
+		 */
+		bool use_rle = (s == NULL || BATtdense(s)) &&
+			RLEtype(b->ttype) &&
+			(tmp = parent != 0 ? BBPquickdesc(parent, 0) : b) != NULL &&
+			tmp->trle != NULL;
 		bn = scanselect(b, s, bn, tl, th, li, hi, equi, anti,
-				lval, hval, lnil, maximum, use_imprints);
+				lval, hval, lnil, maximum, use_imprints,
+				use_zonemap, use_packed, use_rle);
 	}
 
 	ALGODEBUG fprintf(stderr, "#BATselect(b=%s)=" ALGOOPTBATFMT
@@ -781,6 +781,10 @@ BATsave(BAT *bd)
 	if (err == GDK_SUCCEED) {
 		bd->batCopiedtodisk = 1;
 		DESCclean(bd);
+		/* now that the tail is on disk, maybe also save a
+		 * packed copy and a run index */
+		PACKsave(bd);
+		RLEsave(bd);
 		return GDK_SUCCEED;
 	}
 	return err;
@@ -874,6 +878,9 @@ BATdelete(BAT *b)
 		HASHdestroy(b);
 		IMPSdestroy(b);
 		OIDXdestroy(b);
+		ZMdestroy(b);
+		PACKdestroy(b);
+		RLEdestroy(b);
 	}
 	if (b->batCopiedtodisk || (b->theap.storage != STORE_MEM)) {
 		if (b->ttype != TYPE_void &&
@@ -42,6 +42,7 @@
 #endif
 
 #include <signal.h>
+#include <string.h>
 
 #include <unistd.h>		/* for sysconf symbols */
 
@@ -778,3 +779,244 @@ MT_check_nr_cores(void)
 
 	return ncpus;
 }
+
+/*
+ * @- Thread data
+ * Every thread has one pointer that the higher layers can use to pass
+ * information to code that has no other means of getting at it.  It
+ * is NULL until it is set, also in threads not created through
+ * MT_create_thread.
+ */
+#if !defined(HAVE_PTHREAD_H) && defined(_MSC_VER)
+static DWORD threadslot = TLS_OUT_OF_INDEXES;
+
+void
+MT_init_threaddata(void)
+{
+	if (threadslot == TLS_OUT_OF_INDEXES)
+		threadslot = TlsAlloc();
+}
+
+void
+MT_thread_setdata(void *data)
+{
+	if (threadslot != TLS_OUT_OF_INDEXES)
+		TlsSetValue(threadslot, data);
+}
+
+void *
+MT_thread_getdata(void)
+{
+	if (threadslot == TLS_OUT_OF_INDEXES)
+		return NULL;
+	return TlsGetValue(threadslot);
+}
+#else
+static pthread_key_t threadkey;
+static bool threadkey_init = false;
+
+void
+MT_init_threaddata(void)
+{
+	if (!threadkey_init)
+		threadkey_init = pthread_key_create(&threadkey, NULL) == 0;
+}
+
+void
+MT_thread_setdata(void *data)
+{
+	if (threadkey_init)
+		pthread_setspecific(threadkey, data);
+}
+
+void *
+MT_thread_getdata(void)
+{
+	if (!threadkey_init)
+		return NULL;
+	return pthread_getspecific(threadkey);
+}
+#endif
+
+/*
+ * @- NUMA support
+ * On Linux we find the NUMA topology in /sys/devices/system/node.  We
+ * use the get_mempolicy and mbind system calls directly so that we
+ * don't depend on libnuma.  If anything goes wrong, we pretend there
+ * is only a single node, and then all functions below are no-ops.
+ */
+#if defined(__linux__) && defined(HAVE_PTHREAD_H) && defined(CPU_SETSIZE)
+#include <sys/syscall.h>
+#if defined(SYS_get_mempolicy) && defined(SYS_mbind)
+#define HAVE_NUMA 1
+#endif
+#endif
+
+#ifdef HAVE_NUMA
+/* values from <linux/mempolicy.h> */
+#define MPOL_PREFERRED	1
+#define MPOL_F_NODE	(1 << 0)
+#define MPOL_F_ADDR	(1 << 1)
+#define MPOL_MF_MOVE	(1 << 1)
+
+static cpu_set_t MT_nodecpus[MT_MAXNODES]; /* the cpus of each node */
+static signed char MT_cpunode[CPU_SETSIZE]; /* the node of each cpu */
+#endif
+static int MT_nodes = 1;
+
+#ifdef HAVE_NUMA
+/* read a list of the form "0-3,8,10-11" as found in sysfs into set;
+ * return the highest number in the list, or -1 */
+static int
+MT_read_list(const char *fmt, int nr, cpu_set_t *set)
+{
+	char buf[1024], path[128], *s;
+	FILE *f;
+	int max = -1;
+
+	CPU_ZERO(set);
+	snprintf(path, sizeof(path), fmt, nr);
+	if ((f = fopen(path, "r")) == NULL)
+		return -1;
+	s = fgets(buf, (int) sizeof(buf), f);
+	fclose(f);
+	while (s && *s >= '0' && *s <= '9') {
+		long lo, hi;
+
+		lo = hi = strtol(s, &s, 10);
+		if (*s == '-')
+			hi = strtol(s + 1, &s, 10);
+		if (lo < 0 || hi >= CPU_SETSIZE)
+			return -1;
+		for (; lo <= hi; lo++)
+			CPU_SET((int) lo, set);
+		if (hi > max)
+			max = (int) hi;
+		if (*s == ',')
+			s++;
+	}
+	return max;
+}
+#endif
+
+void
+MT_init_nodes(void)
+{
+#ifdef HAVE_NUMA
+	cpu_set_t online;
+	int node, nodes, cpu, mode;
+
+	MT_nodes = 1;
+	nodes = MT_read_list("/sys/devices/system/node/online", 0, &online) + 1;
+	if (nodes <= 1 || nodes > MT_MAXNODES)
+		return;
+	/* the system calls may be disallowed (e.g. in a container) */
+	if (syscall(SYS_get_mempolicy, &mode, NULL, 0UL, NULL, 0UL) < 0)
+		return;
+	memset(MT_cpunode, -1, sizeof(MT_cpunode));
+	for (node = 0; node < nodes; node++) {
+		if (!CPU_ISSET(node, &online) ||
+		    MT_read_list("/sys/devices/system/node/node%d/cpulist", node, &MT_nodecpus[node]) < 0)
+			CPU_ZERO(&MT_nodecpus[node]);
+		for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			if (CPU_ISSET(cpu, &MT_nodecpus[node]))
+				MT_cpunode[cpu] = (signed char) node;
+	}
+	MT_nodes = nodes;
+#endif
+}
+
+/* the number of NUMA nodes, at least 1 */
+int
+MT_nr_nodes(void)
+{
+	return MT_nodes;
+}
+
+/* restrict the calling thread to the cores of the given node */
+int
+MT_thread_setnode(int node)
+{
+	if (MT_nodes <= 1)
+		return 0;
+#ifdef HAVE_NUMA
+	if (node < 0 || node >= MT_nodes || CPU_COUNT(&MT_nodecpus[node]) == 0)
+		return -1;
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &MT_nodecpus[node]) == 0 ? 0 : -1;
+#else
+	(void) node;
+	return -1;
+#endif
+}
+
+/* the node the calling thread currently runs on, or -1 if unknown */
+int
+MT_thread_getnode(void)
+{
+	if (MT_nodes <= 1)
+		return 0;
+#ifdef HAVE_NUMA
+	{
+		int cpu = sched_getcpu();
+
+		if (cpu >= 0 && cpu < CPU_SETSIZE)
+			return MT_cpunode[cpu];
+	}
+#endif
+	return -1;
+}
+
+/* the node the memory at address p lives on, or -1 if unknown; note
+ * that the page is faulted in if it wasn't yet */
+int
+MT_addr_node(const void *p)
+{
+	if (MT_nodes <= 1)
+		return 0;
+#ifdef HAVE_NUMA
+	{
+		int node = -1;
+
+		if (syscall(SYS_get_mempolicy, &node, NULL, 0UL, p, (unsigned long) (MPOL_F_NODE | MPOL_F_ADDR)) == 0)
+			return node;
+	}
+#else
+	(void) p;
+#endif
+	return -1;
+}
+
+/* prefer node for the pages in [p,p+size); if move is set, pages that
+ * are already in use are migrated to the node, otherwise only pages
+ * that are faulted in later are affected */
+int
+MT_place_node(void *p, size_t size, int node, int move)
+{
+	if (MT_nodes <= 1)
+		return 0;
+#ifdef HAVE_NUMA
+	{
+		static size_t pagesize;
+		unsigned long mask;
+		uintptr_t start, end;
+
+		if (node < 0 || node >= MT_nodes || size == 0)
+			return -1;
+		if (pagesize == 0)
+			pagesize = (size_t) sysconf(_SC_PAGESIZE);
+		start = (uintptr_t) p & ~(uintptr_t) (pagesize - 1);
+		end = ((uintptr_t) p + size + pagesize - 1) & ~(uintptr_t) (pagesize - 1);
+		mask = 1UL << node;
+		if (syscall(SYS_mbind, (void *) start, (unsigned long) (end - start),
+			    MPOL_PREFERRED, &mask, (unsigned long) MT_MAXNODES + 1,
+			    move ? (unsigned) MPOL_MF_MOVE : 0U) == 0)
+			return 0;
+	}
+#else
+	(void) p;
+	(void) size;
+	(void) node;
+	(void) move;
+#endif
+	return -1;
+}
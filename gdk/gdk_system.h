@@ -384,4 +384,20 @@ typedef struct {
 
 gdk_export int MT_check_nr_cores(void);
 
+gdk_export void MT_thread_setdata(void *data);
+gdk_export void *MT_thread_getdata(void);
+
+/*
+ * @- NUMA support
+ * Nodes are numbered from 0.  If the topology cannot be determined
+ * there is a single node and the functions below don't do anything.
+ */
+#define MT_MAXNODES	64
+
+gdk_export int MT_nr_nodes(void);
+gdk_export int MT_thread_setnode(int node);
+gdk_export int MT_thread_getnode(void);
+gdk_export int MT_addr_node(const void *p);
+gdk_export int MT_place_node(void *p, size_t size, int node, int move);
+
 #endif /*_GDK_SYSTEM_H_*/
@@ -285,6 +285,8 @@ BATSIGinit(void)
 size_t GDK_mmap_minsize_persistent = MMAP_MINSIZE_PERSISTENT;
 size_t GDK_mmap_minsize_transient = MMAP_MINSIZE_TRANSIENT;
 size_t GDK_mmap_pagesize = MMAP_PAGESIZE; /* mmap granularity */
+bool GDK_hugepages = false;	/* back large heaps with huge pages */
+size_t GDK_heappool_maxsize = 0; /* max bytes in pool of freed heaps */
 size_t GDK_mem_maxsize = GDK_VM_MAXSIZE;
 size_t GDK_vm_maxsize = GDK_VM_MAXSIZE;
 
@@ -303,6 +305,8 @@ static volatile ATOMIC_TYPE GDK_mallocedbytes_estimate = 0;
 static volatile lng GDK_malloc_success_count = -1;
 #endif
 static volatile ATOMIC_TYPE GDK_vm_cursize = 0;
+static volatile ATOMIC_TYPE GDK_numa_local = 0;
+static volatile ATOMIC_TYPE GDK_numa_remote = 0;
 #ifdef ATOMIC_LOCK
 static MT_Lock mbyteslock MT_LOCK_INITIALIZER("mbyteslock");
 static MT_Lock GDKstoppedLock MT_LOCK_INITIALIZER("GDKstoppedLock");
@@ -310,6 +314,8 @@ static MT_Lock GDKstoppedLock MT_LOCK_INITIALIZER("GDKstoppedLock");
 
 size_t _MT_pagesize = 0;	/* variable holding page size */
 size_t _MT_npages = 0;		/* variable holding memory size in pages */
+size_t _MT_l2cachesize = 0;	/* size of the (per core) L2 cache */
+size_t _MT_l3cachesize = 0;	/* size of the (shared) last level cache */
 
 void
 MT_init(void)
@@ -405,6 +411,22 @@ MT_init(void)
 #else
 # error "don't know how to get the amount of physical memory for your OS"
 #endif
+
+#if defined(HAVE_SYSCONF) && defined(_SC_LEVEL2_CACHE_SIZE)
+	_MT_l2cachesize = (size_t) sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+#if defined(HAVE_SYSCONF) && defined(_SC_LEVEL3_CACHE_SIZE)
+	_MT_l3cachesize = (size_t) sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+	/* sysconf returns -1 or 0 if the value is unknown */
+	if (_MT_l2cachesize == 0 || _MT_l2cachesize == (size_t) -1)
+		_MT_l2cachesize = (size_t) 1 << 18; /* default: 256KiB */
+	if (_MT_l3cachesize == 0 || _MT_l3cachesize == (size_t) -1 ||
+	    _MT_l3cachesize < _MT_l2cachesize)
+		_MT_l3cachesize = _MT_l2cachesize * 8;
+
+	MT_init_nodes();
+	MT_init_threaddata();
 }
 
 /*
@@ -441,6 +463,7 @@ GDKinit(opt *set, int setlen)
 	int i, nlen = 0;
 	int farmid;
 	char buf[16];
+	bool heappool_set = false;
 
 	/* some sanity checks (should also find if symbols are not defined) */
 	assert(sizeof(char) == SIZEOF_CHAR);
@@ -577,8 +600,15 @@ GDKinit(opt *set, int setlen)
 			     * two */
 			    (GDK_mmap_pagesize & (GDK_mmap_pagesize - 1)) != 0)
 				GDKfatal("GDKinit: gdk_mmap_pagesize must be power of 2 between 2**12 and 2**20\n");
+		} else if (strcmp("gdk_hugepages", n[i].name) == 0) {
+			GDK_hugepages = strcmp(n[i].value, "yes") == 0;
+		} else if (strcmp("gdk_heappool_maxsize", n[i].name) == 0) {
+			GDK_heappool_maxsize = (size_t) strtoll(n[i].value, NULL, 10);
+			heappool_set = true;
 		}
 	}
+	if (!heappool_set)
+		GDK_heappool_maxsize = GDK_mem_maxsize / 16;
 
 	GDKkey = COLnew(0, TYPE_str, 100, TRANSIENT);
 	GDKval = COLnew(0, TYPE_str, 100, TRANSIENT);
@@ -649,6 +679,46 @@ int GDKnr_threads = 0;
 static int GDKnrofthreads;
 static ThreadRec GDKthreads[THREADS];
 
+/* Run func in parallel on nr argument structures of argsize bytes
+ * each that are laid out consecutively starting at args.  All but
+ * the last invocation are done on newly started threads, the last
+ * one is done by the calling thread.  If a thread cannot be started,
+ * its work is done by the calling thread instead.  The function
+ * returns when all invocations have finished.
+ * Note that the worker threads are not registered with GDK, so func
+ * should not depend on thread specific data (e.g. GDKerror); errors
+ * should be passed back through the argument structure. */
+void
+GDKparallel(void (*func)(void *), void *args, size_t argsize, int nr)
+{
+	MT_Id *tids;
+	bool *started;
+	int i;
+
+	if (nr <= 0)
+		return;
+	if (nr == 1 ||
+	    (tids = GDKmalloc((nr - 1) * (sizeof(MT_Id) + sizeof(bool)))) == NULL) {
+		GDKclrerr();
+		for (i = 0; i < nr; i++)
+			(*func)((char *) args + i * argsize);
+		return;
+	}
+	started = (bool *) (tids + nr - 1);
+	for (i = 0; i < nr - 1; i++)
+		started[i] = MT_create_thread(&tids[i], func,
+					      (char *) args + i * argsize,
+					      MT_THR_JOINABLE) == 0;
+	for (i = 0; i < nr - 1; i++)
+		if (!started[i])
+			(*func)((char *) args + i * argsize);
+	(*func)((char *) args + (nr - 1) * argsize);
+	for (i = 0; i < nr - 1; i++)
+		if (started[i])
+			MT_join_thread(tids[i]);
+	GDKfree(tids);
+}
+
 int
 GDKexiting(void)
 {
@@ -759,6 +829,7 @@ GDKreset(int status, int exit)
 			/* we can't clean up after killing threads */
 			BBPexit();
 		}
+		HEAPpoolflush();
 		GDKlog(GET_GDKLOCK(0), GDKLOGOFF);
 
 		for (farmid = 0; farmid < MAXFARMS; farmid++) {
@@ -1591,6 +1662,37 @@ GDKvm_cursize(void)
 	return (size_t) ATOMIC_GET(GDK_vm_cursize, mbyteslock) + GDKmem_cursize();
 }
 
+/* count whether the memory at p lives on the NUMA node of the
+ * calling thread */
+void
+GDKnuma_count(const void *p)
+{
+	int node, pnode;
+
+	if (MT_nr_nodes() <= 1)
+		return;
+	node = MT_thread_getnode();
+	pnode = MT_addr_node(p);
+	if (node < 0 || pnode < 0)
+		return;
+	if (node == pnode)
+		(void) ATOMIC_INC(GDK_numa_local, mbyteslock);
+	else
+		(void) ATOMIC_INC(GDK_numa_remote, mbyteslock);
+}
+
+size_t
+GDKnuma_local(void)
+{
+	return (size_t) ATOMIC_GET(GDK_numa_local, mbyteslock);
+}
+
+size_t
+GDKnuma_remote(void)
+{
+	return (size_t) ATOMIC_GET(GDK_numa_remote, mbyteslock);
+}
+
 #define heapinc(_memdelta)						\
 	(void) ATOMIC_ADD(GDK_mallocedbytes_estimate, _memdelta, mbyteslock)
 #define heapdec(_memdelta)						\
@@ -1762,6 +1864,194 @@ GDKstrndup(const char *s, size_t size)
 	return p;
 }
 
+/* Arenas
+ *
+ * A query does many small allocations of which the result is freed
+ * again soon after, e.g. the string that a scalar function returns
+ * for one value of a column.  Code that knows its allocations are
+ * short-lived can take them from the arena of the current query with
+ * GDKarenamalloc.  The interpreter makes the arena of the query
+ * available to the threads working for it with GDKarenaset, and
+ * releases it as a whole when the query is done.  Without an arena,
+ * GDKarenamalloc is GDKmalloc.
+ *
+ * Arena memory is handed out from blocks of ARENA_BLOCK bytes.  In
+ * front of it is the same amount of extra space as GDKmalloc uses:
+ * the size with the lowest bit set, so that GDKfree and GDKrealloc
+ * can recognize arena memory, and before that the arena itself.
+ * Freeing the most recent allocation of an arena gives the space
+ * back, other frees are ignored.  Large requests, and requests after
+ * the arena grew to ARENA_MAXSIZE, go to GDKmalloc. */
+#define ARENA_BLOCK	((size_t) 64 << 10)
+#define ARENA_MAXALLOC	((size_t) 4 << 10)
+#define ARENA_MAXSIZE	((size_t) 64 << 20)
+#define ARENA_HEADER	((size_t) 16) /* link to previous block */
+
+struct GDKarena {
+	MT_Lock lock;
+	char *blk;		/* current block */
+	size_t used;		/* bytes used in current block */
+	size_t size;		/* bytes in all blocks */
+	lng nalloc;		/* allocations served by the arena */
+	lng nmalloc;		/* allocations passed on to GDKmalloc */
+};
+
+static MT_Lock arenalock MT_LOCK_INITIALIZER("arenalock");
+static lng arenaallocs, arenamallocs;
+
+void *
+GDKarenamalloc(size_t size)
+{
+	GDKarena *a = MT_thread_getdata();
+	size_t nsize;
+	char *s;
+
+	if (a == NULL)
+		return GDKmalloc(size);
+	nsize = ((size + 15) & ~15) + MALLOC_EXTRA_SPACE;
+	MT_lock_set(&a->lock);
+	if (size == 0 || nsize > ARENA_MAXALLOC)
+		goto use_malloc;
+	if (a->blk == NULL || a->used + nsize > ARENA_BLOCK) {
+		char *b;
+
+		if (a->size >= ARENA_MAXSIZE ||
+		    (b = GDKmalloc(ARENA_BLOCK)) == NULL)
+			goto use_malloc;
+		*(char **) b = a->blk;
+		a->blk = b;
+		a->used = ARENA_HEADER;
+		a->size += ARENA_BLOCK;
+	}
+	s = a->blk + a->used + MALLOC_EXTRA_SPACE;
+	a->used += nsize;
+	a->nalloc++;
+	MT_lock_unset(&a->lock);
+	((size_t *) s)[-1] = nsize | 1;
+	((size_t *) s)[-2] = (size_t) a;
+	return s;
+
+  use_malloc:
+	a->nmalloc++;
+	MT_lock_unset(&a->lock);
+	return GDKmalloc(size);
+}
+
+char *
+GDKarenastrndup(const char *s, size_t size)
+{
+	char *p;
+
+	if (s == NULL)
+		return NULL;
+	if ((p = GDKarenamalloc(size + 1)) == NULL)
+		return NULL;
+	if (size > 0)
+		memcpy(p, s, size);
+	p[size] = '\0';
+	return p;
+}
+
+static void
+GDKarenafree(void *s, size_t asize)
+{
+	GDKarena *a = (GDKarena *) ((size_t *) s)[-2];
+
+#ifndef NDEBUG
+	assert((asize & 2) == 0);   /* check against duplicate free */
+	((size_t *) s)[-1] |= 2; /* indicate area is freed */
+	DEADBEEFCHK memset(s, '\xDB', (asize & ~(size_t) 1) - MALLOC_EXTRA_SPACE);
+#endif
+	asize &= ~(size_t) 1;
+	MT_lock_set(&a->lock);
+	if ((char *) s - MALLOC_EXTRA_SPACE + asize == a->blk + a->used)
+		a->used -= asize;
+	MT_lock_unset(&a->lock);
+}
+
+GDKarena *
+GDKarenacreate(void)
+{
+	GDKarena *a;
+
+	if ((a = GDKzalloc(sizeof(GDKarena))) == NULL)
+		return NULL;
+	MT_lock_init(&a->lock, "GDKarena");
+	return a;
+}
+
+/* give back all memory of the arena, but keep one block if keep is
+ * set */
+static void
+GDKarenaclear(GDKarena *a, bool keep)
+{
+	char *b;
+
+	MT_lock_set(&a->lock);
+	b = a->blk;
+	if (keep && b != NULL) {
+		b = *(char **) a->blk;
+		*(char **) a->blk = NULL;
+		a->used = ARENA_HEADER;
+		a->size = ARENA_BLOCK;
+	} else {
+		a->blk = NULL;
+		a->used = 0;
+		a->size = 0;
+	}
+	MT_lock_set(&arenalock);
+	arenaallocs += a->nalloc;
+	arenamallocs += a->nmalloc;
+	MT_lock_unset(&arenalock);
+	a->nalloc = a->nmalloc = 0;
+	MT_lock_unset(&a->lock);
+	while (b) {
+		char *p = b;
+		b = *(char **) b;
+		GDKfree(p);
+	}
+}
+
+/* release everything that was allocated in the arena */
+void
+GDKarenareset(GDKarena *a)
+{
+	if (a)
+		GDKarenaclear(a, true);
+}
+
+void
+GDKarenadestroy(GDKarena *a)
+{
+	if (a) {
+		GDKarenaclear(a, false);
+		MT_lock_destroy(&a->lock);
+		GDKfree(a);
+	}
+}
+
+/* make a the arena of the calling thread, return the previous one */
+GDKarena *
+GDKarenaset(GDKarena *a)
+{
+	GDKarena *o = MT_thread_getdata();
+
+	if (o != a)
+		MT_thread_setdata(a);
+	return o;
+}
+
+/* the number of allocations that were served by arenas and that were
+ * passed on to GDKmalloc, of arenas that were reset or destroyed */
+void
+GDKarenastatistics(lng *allocs, lng *mallocs)
+{
+	MT_lock_set(&arenalock);
+	*allocs = arenaallocs;
+	*mallocs = arenamallocs;
+	MT_lock_unset(&arenalock);
+}
+
 #undef GDKfree
 void
 GDKfree(void *s)
@@ -1773,6 +2063,12 @@ GDKfree(void *s)
 
 	asize = ((size_t *) s)[-1]; /* how much allocated last */
 
+	if (asize & 1) {
+		/* memory from an arena */
+		GDKarenafree(s, asize);
+		return;
+	}
+
 #ifndef NDEBUG
 	assert((asize & 2) == 0);   /* check against duplicate free */
 	/* check for out-of-bounds writes */
@@ -1795,6 +2091,19 @@ GDKfree(void *s)
 	heapdec((ssize_t) asize);
 }
 
+/* the number of bytes that can be used in memory returned by
+ * GDKmalloc/GDKrealloc */
+size_t
+GDKmallocated(const void *s)
+{
+#ifndef NDEBUG
+	/* only what was asked for, the rest is checked on free */
+	return ((const size_t *) s)[-2];
+#else
+	return ((const size_t *) s)[-1] - MALLOC_EXTRA_SPACE - DEBUG_SPACE;
+#endif
+}
+
 #undef GDKrealloc
 void *
 GDKrealloc(void *s, size_t size)
@@ -1813,6 +2122,18 @@ GDKrealloc(void *s, size_t size)
 	nsize = (size + 7) & ~7;
 	asize = ((size_t *) s)[-1]; /* how much allocated last */
 
+	if (asize & 1) {
+		/* memory from an arena: copy it */
+		void *p;
+
+		asize = (asize & ~(size_t) 3) - MALLOC_EXTRA_SPACE;
+		if ((p = GDKarenamalloc(size)) == NULL)
+			return NULL;
+		memcpy(p, s, MIN(asize, size));
+		GDKfree(s);
+		return p;
+	}
+
 	if (nsize > asize &&
 	    GDKvm_cursize() + nsize - asize >= GDK_vm_maxsize) {
 		GDKerror("allocating too much memory\n");
@@ -1923,6 +2244,56 @@ GDKstrndup(const char *s, size_t size)
 	return p;
 }
 
+size_t
+GDKmallocated(const void *s)
+{
+	(void) s;
+	return 0;		/* unknown */
+}
+
+GDKarena *
+GDKarenacreate(void)
+{
+	return NULL;
+}
+
+void
+GDKarenareset(GDKarena *a)
+{
+	(void) a;
+}
+
+void
+GDKarenadestroy(GDKarena *a)
+{
+	(void) a;
+}
+
+GDKarena *
+GDKarenaset(GDKarena *a)
+{
+	(void) a;
+	return NULL;
+}
+
+void *
+GDKarenamalloc(size_t size)
+{
+	return GDKmalloc(size);
+}
+
+char *
+GDKarenastrndup(const char *s, size_t size)
+{
+	return GDKstrndup(s, size);
+}
+
+void
+GDKarenastatistics(lng *allocs, lng *mallocs)
+{
+	*allocs = *mallocs = 0;
+}
+
 #endif	/* STATIC_CODE_ANALYSIS */
 
 void
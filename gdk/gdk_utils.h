@@ -69,9 +69,13 @@ gdk_export gdk_return GDKsetenv(const char *name, const char *value);
 /* virtual memory defines */
 gdk_export size_t _MT_npages;
 gdk_export size_t _MT_pagesize;
+gdk_export size_t _MT_l2cachesize;
+gdk_export size_t _MT_l3cachesize;
 
 #define MT_pagesize()	_MT_pagesize
 #define MT_npages()	_MT_npages
+#define MT_l2cachesize()	_MT_l2cachesize
+#define MT_l3cachesize()	_MT_l3cachesize
 
 gdk_export void MT_init(void);	/*  init the package. */
 gdk_export int GDKinit(opt *set, int setlen);
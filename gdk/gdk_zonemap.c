@@ -0,0 +1,624 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/* Zone maps.
+ *
+ * A zone map divides a column into blocks of ZONEMAP_BLOCK values and
+ * records for each block the smallest and the largest non-nil value
+ * and the number of nils in the block.  A select can use this to skip
+ * blocks in which no value can qualify, and to add all values of a
+ * block in which all values qualify without looking at them.  If the
+ * values of a column are clustered (e.g. a date column of a table
+ * that was loaded in date order), this avoids most of the work of a
+ * scan.
+ *
+ * For string columns, minimum and maximum are of little use, so
+ * instead we record for each (much smaller) block of ZONEMAP_STRBLOCK
+ * values Bloom filters of the values and of some of their prefixes
+ * and the set of first bytes (see gdk_zonemap.h).  An equality
+ * select can skip blocks that cannot contain the value, and a LIKE
+ * select with a fixed prefix can skip blocks that cannot contain a
+ * value with that prefix (see BATzonemapcands).
+ *
+ * Since the summary of a block only depends on the values in that
+ * block, the zone map can be maintained cheaply when values are
+ * appended: only the last block and any new blocks are affected.  Any
+ * other change to the column destroys the zone map.  A zone map
+ * always covers a prefix of the column; values beyond the covered
+ * part (e.g. values that were appended since a persisted zone map was
+ * written) are added the next time the zone map is checked.
+ *
+ * The zone map is stored in a heap next to the tail heap (extension
+ * tzonemap) and is persisted when the BAT is persistent and clean, in
+ * the same way as the order index. */
+
+#include "monetdb_config.h"
+#include "gdk.h"
+#include "gdk_private.h"
+#include "gdk_zonemap.h"
+
+static void
+BATzmsync(void *arg)
+{
+	BAT *b = arg;
+	Heap *hp;
+	int fd;
+	lng t0 = 0;
+
+	ALGODEBUG t0 = GDKusec();
+
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->tzonemap) != NULL && hp != (Heap *) 1) {
+		if (HEAPsave(hp, BBP_physical(b->batCacheid), "tzonemap") == GDK_SUCCEED &&
+		    (fd = GDKfdlocate(hp->farmid, BBP_physical(b->batCacheid), "rb+", "tzonemap")) >= 0) {
+			((oid *) hp->base)[0] |= (oid) 1 << 24;
+			if (write(fd, hp->base, SIZEOF_OID) >= 0) {
+				if (!(GDKdebug & NOSYNCMASK)) {
+#if defined(NATIVE_WIN32)
+					_commit(fd);
+#elif defined(HAVE_FDATASYNC)
+					fdatasync(fd);
+#elif defined(HAVE_FSYNC)
+					fsync(fd);
+#endif
+				}
+			} else {
+				perror("write zonemap");
+			}
+			close(fd);
+		}
+		ALGODEBUG fprintf(stderr, "#BATzmsync(%s): zone map persisted"
+				  " (" LLFMT " usec)\n",
+				  BATgetId(b), GDKusec() - t0);
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	BBPunfix(b->batCacheid);
+}
+
+/* maybe persist the zone map; must be called with GDKhashLock held */
+static void
+persistZM(BAT *b)
+{
+	if ((BBP_status(b->batCacheid) & BBPEXISTING) &&
+	    b->batInserted == b->batCount &&
+	    !b->theap.dirty) {
+		MT_Id tid;
+		BBPfix(b->batCacheid);
+		if (MT_create_thread(&tid, BATzmsync, b, MT_THR_DETACHED) < 0)
+			BBPunfix(b->batCacheid);
+	} else
+		ALGODEBUG fprintf(stderr, "#persistZM(" ALGOBATFMT "): NOT persisting zone map\n", ALGOBATPAR(b));
+}
+
+#define ZMFOLD(TYPE, EMPTYMIN, EMPTYMAX)				\
+	do {								\
+		const TYPE *restrict vals = (const TYPE *) Tloc(b, 0);	\
+		for (blk = from / bs; from < cnt; blk++) {		\
+			char *rec = ZMrec(hp, rs, blk);			\
+			BUN end = MIN(cnt, (blk + 1) * bs);		\
+			TYPE mn, mx;					\
+			BUN nils;					\
+									\
+			if (from == blk * bs) {				\
+				/* new block */				\
+				mn = EMPTYMIN;				\
+				mx = EMPTYMAX;				\
+				nils = 0;				\
+			} else {					\
+				mn = ZMmin(TYPE, rec);			\
+				mx = ZMmax(TYPE, rec);			\
+				nils = ZMnils(rs, rec);			\
+			}						\
+			for (; from < end; from++) {			\
+				TYPE v = vals[from];			\
+				if (is_##TYPE##_nil(v)) {		\
+					nils++;				\
+				} else {				\
+					if (v < mn)			\
+						mn = v;			\
+					if (v > mx)			\
+						mx = v;			\
+				}					\
+			}						\
+			ZMmin(TYPE, rec) = mn;				\
+			ZMmax(TYPE, rec) = mx;				\
+			ZMnils(rs, rec) = nils;				\
+		}							\
+	} while (0)
+
+/* the bit in the prefix filter of the first len bytes of v (v is at
+ * least len bytes long) */
+unsigned int
+ZMstrpfx(const char *v, size_t len)
+{
+	unsigned int h = (unsigned int) len;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		h = (h ^ ZMlower((unsigned char) v[i])) * 0x01000193U;
+	return (h * 0x9E3779B1U) >> 24;
+}
+
+/* calculate the bits of the string v that are used by ZMstrmaybe */
+void
+ZMstrbits(const char *v, unsigned int *h1, unsigned int *h2, unsigned int *hp)
+{
+	size_t len;
+
+	ZMstrhash(v, *h1, *h2);
+	*hp = ~0U;
+	for (len = 2; len <= 8 && strnlen(v, len) == len; len++)
+		*hp = ZMstrpfx(v, len);
+}
+
+static void
+ZMfoldstr(BAT *b, Heap *hp, BUN from, BUN cnt)
+{
+	BATiter bi = bat_iterator(b);
+	BUN blk, end;
+	unsigned int h1, h2;
+	const char *v;
+	char *rec;
+	size_t len;
+
+	for (blk = from / ZONEMAP_STRBLOCK; from < cnt; blk++) {
+		rec = ZMrec(hp, ZMSTRRECSIZE, blk);
+		end = MIN(cnt, (blk + 1) * ZONEMAP_STRBLOCK);
+		if (from == blk * ZONEMAP_STRBLOCK)
+			memset(rec, 0, ZMSTRRECSIZE); /* new block */
+		for (; from < end; from++) {
+			v = BUNtvar(bi, from);
+			ZMstrhash(v, h1, h2);
+			ZMbitset(ZMstrvals(rec), h1);
+			ZMbitset(ZMstrvals(rec), h2);
+			if (strNil(v)) {
+				ZMnils(ZMSTRRECSIZE, rec)++;
+			} else {
+				ZMbitset(ZMstrfirst(rec), ZMlower((unsigned char) v[0]));
+				for (len = 2; len <= 8; len++) {
+					if (strnlen(v, len) < len)
+						break;
+					ZMbitset(ZMstrpref(rec), ZMstrpfx(v, len));
+				}
+			}
+		}
+	}
+}
+
+/* add the values of b that are not yet covered by the zone map hp */
+static gdk_return
+ZMfold(BAT *b, Heap *hp)
+{
+	oid *hdr = (oid *) hp->base;
+	BUN from = (BUN) hdr[1], cnt = BATcount(b), blk, nblk;
+	BUN bs = ZMblock(b);
+	size_t rs = ZMrecsize(b);
+
+	assert(from <= cnt);
+	assert(hdr[3] == (oid) bs);
+	nblk = (cnt + bs - 1) / bs;
+	if (HEAPextend(hp, ZMsize(rs, nblk), false) != GDK_SUCCEED)
+		return GDK_FAIL;
+	hdr = (oid *) hp->base;
+
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+		ZMFOLD(bte, GDK_bte_max, GDK_bte_min);
+		break;
+	case TYPE_sht:
+		ZMFOLD(sht, GDK_sht_max, GDK_sht_min);
+		break;
+	case TYPE_int:
+		ZMFOLD(int, GDK_int_max, GDK_int_min);
+		break;
+	case TYPE_lng:
+		ZMFOLD(lng, GDK_lng_max, GDK_lng_min);
+		break;
+#ifdef HAVE_HGE
+	case TYPE_hge:
+		ZMFOLD(hge, GDK_hge_max, GDK_hge_min);
+		break;
+#endif
+	case TYPE_flt:
+		ZMFOLD(flt, (flt) INFINITY, (flt) -INFINITY);
+		break;
+	case TYPE_dbl:
+		ZMFOLD(dbl, (dbl) INFINITY, (dbl) -INFINITY);
+		break;
+	case TYPE_str:
+		ZMfoldstr(b, hp, from, cnt);
+		break;
+	default:
+		assert(0);
+	}
+	hdr[1] = (oid) cnt;
+	hdr[2] = (oid) nblk;
+	hp->free = ZMsize(rs, nblk);
+	hp->dirty = true;
+	return GDK_SUCCEED;
+}
+
+/* return TRUE if we have a zone map on the tail, even if we need to
+ * read one from disk; the zone map covers all values of b */
+bool
+BATcheckzonemap(BAT *b)
+{
+	bool ret;
+	Heap *hp;
+	lng t = 0;
+
+	if (b == NULL)
+		return false;
+	assert(b->batCacheid > 0);
+	ALGODEBUG t = GDKusec();
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->tzonemap == (Heap *) 1) {
+		const char *nme = BBP_physical(b->batCacheid);
+		int fd;
+
+		b->tzonemap = NULL;
+		if ((hp = GDKzalloc(sizeof(*hp))) != NULL &&
+		    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, zonemapheap)) >= 0) {
+			snprintf(hp->filename, sizeof(hp->filename), "%s.tzonemap", nme);
+
+			/* check whether a persisted zone map can be found */
+			if ((fd = GDKfdlocate(hp->farmid, nme, "rb+", "tzonemap")) >= 0) {
+				struct stat st;
+				oid hdata[ZONEMAPOFF];
+
+				if (read(fd, hdata, sizeof(hdata)) == sizeof(hdata) &&
+				    hdata[0] == (((oid) 1 << 24) | ZONEMAP_VERSION) &&
+				    hdata[1] <= (oid) BATcount(b) &&
+				    hdata[3] == (oid) ZMblock(b) &&
+				    hdata[2] == (hdata[1] + hdata[3] - 1) / hdata[3] &&
+				    fstat(fd, &st) == 0 &&
+				    st.st_size >= (off_t) (hp->size = hp->free = ZMsize(ZMrecsize(b), hdata[2])) &&
+				    HEAPload(hp, nme, "tzonemap", false) == GDK_SUCCEED) {
+					close(fd);
+					if (hdata[1] == (oid) BATcount(b) ||
+					    ZMfold(b, hp) == GDK_SUCCEED) {
+						b->tzonemap = hp;
+						ALGODEBUG fprintf(stderr, "#BATcheckzonemap(" ALGOBATFMT "): reusing persisted zone map\n", ALGOBATPAR(b));
+						MT_lock_unset(&GDKhashLock(b->batCacheid));
+						return true;
+					}
+					HEAPfree(hp, false);
+				} else {
+					close(fd);
+				}
+				/* unlink unusable file */
+				GDKunlink(hp->farmid, BATDIR, nme, "tzonemap");
+			}
+		}
+		GDKfree(hp);
+		GDKclrerr();	/* we're not currently interested in errors */
+	}
+	if ((hp = b->tzonemap) != NULL &&
+	    ((oid *) hp->base)[1] < (oid) BATcount(b) &&
+	    ZMfold(b, hp) != GDK_SUCCEED) {
+		/* can't bring the zone map up to date, so get rid
+		 * of it (the file was written for fewer values and
+		 * is still valid) */
+		b->tzonemap = (Heap *) 1;
+		HEAPfree(hp, false);
+		GDKfree(hp);
+		GDKclrerr();
+	}
+	ret = b->tzonemap != NULL && b->tzonemap != (Heap *) 1;
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	ALGODEBUG if (ret) fprintf(stderr, "#BATcheckzonemap(" ALGOBATFMT "): already has zone map, waited " LLFMT " usec\n", ALGOBATPAR(b), GDKusec() - t);
+	return ret;
+}
+
+/* Create a zone map on the tail of b.  If b is a view, the zone map
+ * is created on its parent. */
+gdk_return
+BATzonemap(BAT *b)
+{
+	Heap *hp;
+	oid *hdr;
+	lng t0 = 0;
+
+	BATcheck(b, "BATzonemap", GDK_FAIL);
+
+	switch (ATOMbasetype(b->ttype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_flt:
+	case TYPE_dbl:
+	case TYPE_str:
+		break;
+	default:
+		GDKerror("BATzonemap: unsupported type\n");
+		return GDK_FAIL;
+	}
+
+	if (VIEWtparent(b)) {
+		/* views use the zone map of their parent */
+		b = BBPdescriptor(VIEWtparent(b));
+		assert(b);
+	}
+	if (BATcheckzonemap(b))
+		return GDK_SUCCEED;
+
+	ALGODEBUG t0 = GDKusec();
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if (b->tzonemap == NULL || b->tzonemap == (Heap *) 1) {
+		if ((hp = GDKzalloc(sizeof(Heap))) == NULL ||
+		    (hp->farmid = BBPselectfarm(b->batRole, b->ttype, zonemapheap)) < 0 ||
+		    snprintf(hp->filename, sizeof(hp->filename), "%s.tzonemap", BBP_physical(b->batCacheid)) < 0 ||
+		    HEAPalloc(hp, ZMsize(ZMrecsize(b), (BATcount(b) + ZMblock(b) - 1) / ZMblock(b)), 1) != GDK_SUCCEED) {
+			GDKfree(hp);
+			MT_lock_unset(&GDKhashLock(b->batCacheid));
+			return GDK_FAIL;
+		}
+		hdr = (oid *) hp->base;
+		hdr[0] = ZONEMAP_VERSION;
+		hdr[1] = 0;
+		hdr[2] = 0;
+		hdr[3] = (oid) ZMblock(b);
+		hp->free = ZMsize(ZMrecsize(b), 0);
+		if (ZMfold(b, hp) != GDK_SUCCEED) {
+			HEAPfree(hp, true);
+			GDKfree(hp);
+			MT_lock_unset(&GDKhashLock(b->batCacheid));
+			return GDK_FAIL;
+		}
+		b->tzonemap = hp;
+		b->batDirtydesc = true;
+		persistZM(b);
+		ALGODEBUG fprintf(stderr, "#BATzonemap(" ALGOBATFMT "): zone map construction " LLFMT " usec\n", ALGOBATPAR(b), GDKusec() - t0);
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	return GDK_SUCCEED;
+}
+
+/* Return whether the block with record rec of a string zone map may
+ * contain a value equal to v (if prefix is false) or starting with v
+ * (if prefix is true); h1 and h2 are the bits of v in the Bloom
+ * filter of the values, and hp is the bit of the longest usable
+ * prefix of v in the prefix filter (or ~0U if v is too short), see
+ * ZMstrbits. */
+bool
+ZMstrmaybe(const char *rec, const char *v, bool prefix, bool caseignore,
+	   unsigned int h1, unsigned int h2, unsigned int hp)
+{
+	const ulng *first = ZMstrfirst(rec);
+
+	if (caseignore) {
+		/* a non-ASCII character may be equal to an ASCII
+		 * character when case is ignored, so we can only use
+		 * the first byte if the block contains no non-ASCII
+		 * first bytes (v starts with an ASCII character) */
+		return (first[2] | first[3]) != 0 ||
+			ZMbittst(first, ZMlower((unsigned char) v[0]));
+	}
+	if (!prefix &&
+	    (!ZMbittst(ZMstrvals(rec), h1) || !ZMbittst(ZMstrvals(rec), h2)))
+		return false;
+	return ZMbittst(first, ZMlower((unsigned char) v[0])) &&
+		(hp == ~0U || ZMbittst(ZMstrpref(rec), hp));
+}
+
+/* Return a candidate list with those candidates of s (or, if s is
+ * NULL, those values of b) that are in blocks of the string zone map
+ * of b that may contain a value equal to v (if prefix is false) or
+ * starting with v (if prefix is true), ignoring case if caseignore is
+ * set.  The zone map is created if b (or its parent) is persistent
+ * and large enough.  If there is no zone map, or if it cannot exclude
+ * any candidates, the result contains all candidates (it may then be
+ * s itself with an extra reference).  In any case the result must be
+ * released by the caller. */
+BAT *
+BATzonemapcands(BAT *b, BAT *s, const char *v, bool prefix, bool caseignore)
+{
+	BAT *pb, *bn;
+	const Heap *zm;
+	const oid *cand;
+	oid *restrict dst;
+	BUN zoff, covered, p, q, e, blk, n, i, m, cnt = 0;
+	oid off;
+	unsigned int h1, h2, hp;
+	bool maybe = true;
+	lng t0 = 0;
+
+	BATcheck(b, "BATzonemapcands", NULL);
+	ALGODEBUG t0 = GDKusec();
+
+	pb = VIEWtparent(b) ? BBPdescriptor(VIEWtparent(b)) : b;
+	if (ATOMbasetype(b->ttype) != TYPE_str ||
+	    v == NULL || strNil(v) ||
+	    (prefix && *v == 0) ||
+	    (caseignore && (unsigned char) *v >= 0x80) ||
+	    (pb->tzonemap == NULL &&
+	     (pb->batPersistence != PERSISTENT ||
+	      BATcount(pb) < ZONEMAP_MINSIZE)))
+		goto nofilter;
+	if (BATzonemap(b) != GDK_SUCCEED) {
+		GDKclrerr();	/* not interested in BATzonemap errors */
+		goto nofilter;
+	}
+	zm = pb->tzonemap;
+	zoff = (BUN) ((const char *) Tloc(b, 0) - (const char *) Tloc(pb, 0)) >> b->tshift;
+	covered = (BUN) ((const oid *) zm->base)[1];
+	ZMstrbits(v, &h1, &h2, &hp);
+	off = b->hseqbase;
+
+/* set maybe to whether position i of b may qualify (blk caches the
+ * block of the previous position) */
+#define ZMMAYBE(i)							\
+	do {								\
+		if ((i) + zoff >= covered)				\
+			maybe = true;					\
+		else if (((i) + zoff) / ZONEMAP_STRBLOCK != blk) {	\
+			blk = ((i) + zoff) / ZONEMAP_STRBLOCK;		\
+			maybe = ZMstrmaybe(ZMrec(zm, ZMSTRRECSIZE, blk), \
+					   v, prefix, caseignore,	\
+					   h1, h2, hp);			\
+		}							\
+	} while (0)
+
+	if (s == NULL || BATtdense(s)) {
+		if (s) {
+			p = (BUN) s->tseqbase;
+			q = p + BATcount(s);
+			if ((oid) p < off)
+				p = (BUN) off;
+			if ((oid) q > off + BATcount(b))
+				q = (BUN) off + BATcount(b);
+			if (p > q)
+				p = q;
+			p = (BUN) (p - off);
+			q = (BUN) (q - off);
+		} else {
+			p = 0;
+			q = BATcount(b);
+		}
+		/* count the values in blocks that may qualify */
+		for (i = p, blk = BUN_NONE; i < q; i = e) {
+			ZMMAYBE(i);
+			e = MIN(q, (i + zoff) / ZONEMAP_STRBLOCK * ZONEMAP_STRBLOCK + ZONEMAP_STRBLOCK - zoff);
+			if (maybe)
+				cnt += e - i;
+		}
+		if (cnt == q - p)
+			goto nofilter;
+		if ((bn = COLnew(0, TYPE_oid, cnt, TRANSIENT)) == NULL)
+			return NULL;
+		dst = (oid *) Tloc(bn, 0);
+		cnt = 0;
+		for (i = p, blk = BUN_NONE; i < q; i = e) {
+			ZMMAYBE(i);
+			e = MIN(q, (i + zoff) / ZONEMAP_STRBLOCK * ZONEMAP_STRBLOCK + ZONEMAP_STRBLOCK - zoff);
+			if (maybe)
+				for (; i < e; i++)
+					dst[cnt++] = off + i;
+		}
+	} else {
+		n = BATcount(s);
+		cand = (const oid *) Tloc(s, 0);
+		if ((bn = COLnew(0, TYPE_oid, n, TRANSIENT)) == NULL)
+			return NULL;
+		dst = (oid *) Tloc(bn, 0);
+		for (i = m = 0, blk = BUN_NONE; i < n; i++) {
+			if (cand[i] < off)
+				continue;
+			if (cand[i] >= off + BATcount(b))
+				break;
+			m++;
+			ZMMAYBE(cand[i] - off);
+			if (maybe)
+				dst[cnt++] = cand[i];
+		}
+		if (cnt == m) {
+			BBPreclaim(bn);
+			goto nofilter;
+		}
+	}
+	BATsetcount(bn, cnt);
+	bn->tsorted = true;
+	bn->trevsorted = cnt <= 1;
+	bn->tkey = true;
+	bn->tnil = false;
+	bn->tnonil = true;
+	bn->tseqbase = cnt == 0 ? 0 : cnt == 1 ? *(const oid *) Tloc(bn, 0) : oid_nil;
+	ALGODEBUG fprintf(stderr, "#BATzonemapcands(b=" ALGOBATFMT
+			  ",s=" ALGOOPTBATFMT ",prefix=%d,caseignore=%d)="
+			  ALGOBATFMT " (" LLFMT " usec)\n",
+			  ALGOBATPAR(b), ALGOOPTBATPAR(s), prefix, caseignore,
+			  ALGOBATPAR(bn), GDKusec() - t0);
+	return virtualize(bn);
+
+  nofilter:
+	if (s) {
+		BBPfix(s->batCacheid);
+		return s;
+	}
+	return BATdense(b->hseqbase, b->hseqbase, BATcount(b));
+}
+
+/* Values were appended to b: bring the zone map up to date if it is
+ * loaded (a zone map that is only on disk is brought up to date when
+ * it is loaded). */
+void
+ZMappend(BAT *b)
+{
+	Heap *hp;
+	bool drop = false;
+
+	if (b->tzonemap == NULL)
+		return;
+	MT_lock_set(&GDKhashLock(b->batCacheid));
+	if ((hp = b->tzonemap) != NULL && hp != (Heap *) 1 &&
+	    ((oid *) hp->base)[1] < (oid) BATcount(b) &&
+	    ZMfold(b, hp) != GDK_SUCCEED) {
+		GDKclrerr();
+		drop = true;
+	}
+	MT_lock_unset(&GDKhashLock(b->batCacheid));
+	if (drop)
+		ZMdestroy(b);
+}
+
+/* The count of b is about to be set to cnt: destroy the zone map if
+ * it covers values beyond that (if the zone map is not loaded, we
+ * don't know what it covers, so destroy it if b shrinks). */
+void
+ZMtruncate(BAT *b, BUN cnt)
+{
+	Heap *hp = b->tzonemap;
+
+	if (hp == NULL)
+		return;
+	if (hp == (Heap *) 1 ? cnt < BATcount(b) :
+	    ((oid *) hp->base)[1] > (oid) cnt)
+		ZMdestroy(b);
+}
+
+void
+ZMfree(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		if ((hp = b->tzonemap) != NULL && hp != (Heap *) 1) {
+			b->tzonemap = (Heap *) 1;
+			HEAPfree(hp, false);
+			GDKfree(hp);
+		}
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+	}
+}
+
+void
+ZMdestroy(BAT *b)
+{
+	if (b) {
+		Heap *hp;
+
+		MT_lock_set(&GDKhashLock(b->batCacheid));
+		hp = b->tzonemap;
+		b->tzonemap = NULL;
+		MT_lock_unset(&GDKhashLock(b->batCacheid));
+		if (hp == (Heap *) 1) {
+			GDKunlink(BBPselectfarm(b->batRole, b->ttype, zonemapheap),
+				  BATDIR,
+				  BBP_physical(b->batCacheid),
+				  "tzonemap");
+		} else if (hp != NULL) {
+			HEAPdelete(hp, BBP_physical(b->batCacheid), "tzonemap");
+			GDKfree(hp);
+		}
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+#ifndef GDK_ZONEMAP_H
+#define GDK_ZONEMAP_H
+
+/* The zone map heap starts with a header of ZONEMAPOFF oids:
+ * [0] version (bit 24 is set when the heap was persisted)
+ * [1] number of values covered by the zone map
+ * [2] number of blocks
+ * [3] number of values per block
+ * followed by one record per block. */
+#define ZONEMAP_VERSION	((oid) 2)
+#define ZONEMAPOFF	4
+#define ZONEMAP_BLOCK	((BUN) 1 << 16)	/* values per block */
+#define ZONEMAP_STRBLOCK ((BUN) 1 << 10) /* values per block for strings */
+#define ZONEMAP_MINSIZE	(4 * ZONEMAP_BLOCK) /* don't create smaller zone maps */
+
+/* A block record of a numeric column consists of the smallest and the
+ * largest non-nil value in the block (each w bytes wide) and the
+ * number of nils in the block.  Records are aligned on the larger of
+ * 8 and w bytes.
+ *
+ * A block record of a string column consists of three filters of
+ * ZMSTRBITS bits each and the number of nils in the block: a Bloom
+ * filter of the values (two bits per value), the set of first bytes
+ * of the values, and a Bloom filter of the prefixes of 2 up to 8
+ * bytes of the values (as far as the values are long enough, one bit
+ * per prefix).  Nils only occur in the first filter, and in the other
+ * two, ASCII upper case letters are folded to lower case.
+ *
+ * In both cases, the number of nils is the last field of the
+ * record. */
+#define ZMalign(w)	((size_t) ((w) > 8 ? (w) : 8))
+#define ZMnumrecsize(w)	(((size_t) (w) * 2 + SIZEOF_BUN + ZMalign(w) - 1) & ~(ZMalign(w) - 1))
+#define ZMSTRBITS	256
+#define ZMSTRRECSIZE	((size_t) 3 * ZMSTRBITS / 8 + SIZEOF_BUN)
+#define ZMrecsize(b)	(ATOMbasetype((b)->ttype) == TYPE_str ? ZMSTRRECSIZE : ZMnumrecsize((b)->twidth))
+#define ZMblock(b)	(ATOMbasetype((b)->ttype) == TYPE_str ? ZONEMAP_STRBLOCK : ZONEMAP_BLOCK)
+#define ZMsize(rs, n)	(ZONEMAPOFF * SIZEOF_OID + (size_t) (n) * (rs))
+
+#define ZMrec(hp, rs, i)	((hp)->base + ZONEMAPOFF * SIZEOF_OID + (size_t) (i) * (rs))
+#define ZMmin(TYPE, r)	(((TYPE *) (r))[0])
+#define ZMmax(TYPE, r)	(((TYPE *) (r))[1])
+#define ZMnils(rs, r)	(*(BUN *) ((r) + (rs) - SIZEOF_BUN))
+
+#define ZMstrvals(r)	((ulng *) (r))
+#define ZMstrfirst(r)	((ulng *) (r) + ZMSTRBITS / 64)
+#define ZMstrpref(r)	((ulng *) (r) + 2 * ZMSTRBITS / 64)
+#define ZMbitset(f, i)	((f)[(i) / 64] |= (ulng) 1 << ((i) % 64))
+#define ZMbittst(f, i)	(((f)[(i) / 64] >> ((i) % 64)) & 1)
+
+/* the two bits of a value in the Bloom filter of the values */
+#define ZMstrhash(v, h1, h2)					\
+	do {							\
+		BUN _h;						\
+		GDK_STRHASH(v, _h);				\
+		h1 = (unsigned int) (_h % ZMSTRBITS);		\
+		h2 = (unsigned int) ((_h >> 8) % ZMSTRBITS);	\
+	} while (0)
+/* ASCII lower case version of a byte */
+#define ZMlower(c)	((unsigned int) ((c) >= 'A' && (c) <= 'Z' ? (c) + ('a' - 'A') : (c)))
+
+#endif /* GDK_ZONEMAP_H */
@@ -260,6 +260,7 @@ typedef struct MALSTK {
 	int tag;		/* unique invocation call tag */
 	struct MALSTK *up;	/* stack trace list */
 	struct MALBLK *blk;	/* associated definition */
+	GDKarena *arena;	/* short-lived allocations of the query */
 	ValRecord stk[FLEXIBLE_ARRAY_MEMBER];
 } MalStack, *MalStkPtr;
 
@@ -48,6 +48,7 @@ typedef struct FLOWEVENT {
 	lng hotclaim;   /* memory foot print of result variables */
 	lng argclaim;   /* memory foot print of arguments */
 	lng maxclaim;   /* memory foot print of  largest argument, counld be used to indicate result size */
+	int node;       /* NUMA node of the largest argument, -1 if unknown */
 } *FlowEvent, FlowEventRec;
 
 typedef struct queue {
@@ -93,6 +94,20 @@ static MT_Lock exitingLock MT_LOCK_INITIALIZER("exitingLock");
 static volatile ATOMIC_TYPE exiting = 0;
 static MT_Lock dataflowLock MT_LOCK_INITIALIZER("dataflowLock");
 
+/* On NUMA machines, the workers are pinned to the nodes round robin,
+ * and they prefer instructions whose (largest) argument lives on
+ * their own node.  We only look at arguments of at least
+ * DFLOW_NUMA_MINSIZE bytes, and look that far back in the queue.  We
+ * count how many instructions were picked up by a worker on the same
+ * node as their argument and how many by a worker on another node. */
+#define DFLOW_NUMA_MINSIZE	((size_t) 1 << 20)
+#define DFLOW_NUMA_LOOKAHEAD	32
+#ifdef ATOMIC_LOCK
+static MT_Lock numaLock MT_LOCK_INITIALIZER("numaLock");
+#endif
+static volatile ATOMIC_TYPE numalocal = 0;
+static volatile ATOMIC_TYPE numaremote = 0;
+
 void
 mal_dataflow_reset(void)
 {
@@ -222,7 +237,7 @@ q_requeue(Queue *q, FlowEvent d)
 #endif
 
 static FlowEvent
-q_dequeue(Queue *q, Client cntxt)
+q_dequeue(Queue *q, Client cntxt, int node)
 {
 	FlowEvent r = NULL, s = NULL;
 	//int i;
@@ -267,7 +282,24 @@ q_dequeue(Queue *q, Client cntxt)
 		return NULL;
 	}
 	assert(q->last > 0);
-	if (q->last > 0) {
+	if (q->last > 0 && node >= 0 && q->data[q->last - 1]->node != node) {
+		int i;
+
+		/* NUMA: look for recent work on our own node */
+		for (i = q->last - 2; i >= 0 && i >= q->last - DFLOW_NUMA_LOOKAHEAD; i--) {
+			if (q->data[i]->node == node) {
+				r = q->data[i];
+				q->last--;
+				while (i < q->last) {
+					q->data[i] = q->data[i + 1];
+					i++;
+				}
+				q->data[q->last] = 0;
+				break;
+			}
+		}
+	}
+	if (r == NULL && q->last > 0) {
 		/* LIFO favors garbage collection */
 		r = q->data[--q->last];
 /*  Line coverage test shows it is an expensive loop that is hardly ever leads to adjustment
@@ -330,6 +362,7 @@ DFLOWworker(void *T)
 	int i,last;
 	Client cntxt;
 	InstrPtr p;
+	int node = -1;
 
 	thr = THRnew("DFLOWworker");
 	if (thr == NULL) {
@@ -339,6 +372,9 @@ DFLOWworker(void *T)
 	}
 	MT_sema_up(&t->startup);
 
+	if (MT_nr_nodes() > 1 && MT_thread_setnode(id % MT_nr_nodes()) == 0)
+		node = id % MT_nr_nodes();
+
 #ifdef _MSC_VER
 	srand((unsigned int) GDKusec());
 #endif
@@ -359,7 +395,7 @@ DFLOWworker(void *T)
 			MT_lock_set(&dataflowLock);
 			cntxt = t->cntxt;
 			MT_lock_unset(&dataflowLock);
-			fe = q_dequeue(todo, cntxt);
+			fe = q_dequeue(todo, cntxt, node);
 			if (fe == NULL) {
 				if (cntxt) {
 					/* we're not done yet with work for the current
@@ -374,6 +410,12 @@ DFLOWworker(void *T)
 				/* no more work to be done: exit */
 				break;
 			}
+			if (node >= 0 && fe->node >= 0) {
+				if (fe->node == node)
+					(void) ATOMIC_INC(numalocal, numaLock);
+				else
+					(void) ATOMIC_INC(numaremote, numaLock);
+			}
 		} else
 			fe = fnxt;
 		if (ATOMIC_GET(exiting, exitingLock)) {
@@ -491,6 +533,13 @@ DFLOWworker(void *T)
 	MT_lock_unset(&dataflowLock);
 }
 
+void
+DFLOWnumastatistics(lng *local, lng *remote)
+{
+	*local = (lng) ATOMIC_GET(numalocal, numaLock);
+	*remote = (lng) ATOMIC_GET(numaremote, numaLock);
+}
+
 /*
  * Create an interpreter pool.
  * One worker will adaptively be available for each client.
@@ -584,6 +633,7 @@ DFLOWinitBlk(DataFlow flow, MalBlkPtr mb, int size)
 		flow->status[n].pc = pc;
 		flow->status[n].state = DFLOWpending;
 		flow->status[n].cost = -1;
+		flow->status[n].node = -1;
 		flow->status[n].flow->error = NULL;
 
 		/* administer flow dependencies */
@@ -720,6 +770,40 @@ static void showFlowEvent(DataFlow flow, int pc)
 }
 */
 
+/*
+ * The NUMA node on which the largest BAT argument of an instruction
+ * lives, or -1 if we don't know or it doesn't matter.
+ */
+static int
+DFLOWnode(DataFlow flow, FlowEvent fe)
+{
+	InstrPtr p;
+	const void *addr = NULL;
+	size_t sz, maxsz = 0;
+	int j;
+
+	if (MT_nr_nodes() <= 1)
+		return -1;
+	p = getInstrPtr(flow->mb, fe->pc);
+	for (j = p->retc; j < p->argc; j++) {
+		ValPtr v = &flow->stk->stk[getArg(p, j)];
+		BAT *b;
+
+		if (v->vtype != TYPE_bat || is_bat_nil(v->val.bval) ||
+			(b = BBPquickdesc(v->val.bval, false)) == NULL ||
+			b->ttype == TYPE_void || b->theap.base == NULL)
+			continue;
+		sz = (size_t) BATcount(b) << b->tshift;
+		if (sz > maxsz) {
+			maxsz = sz;
+			addr = Tloc(b, 0);
+		}
+	}
+	if (maxsz < DFLOW_NUMA_MINSIZE)
+		return -1;
+	return MT_addr_node(addr);
+}
+
 static str
 DFLOWscheduler(DataFlow flow, struct worker *w)
 {
@@ -753,6 +837,7 @@ DFLOWscheduler(DataFlow flow, struct worker *w)
 			for (j = p->retc; j < p->argc; j++)
 				fe[i].argclaim = getMemoryClaim(fe[0].flow->mb, fe[0].flow->stk, p, j, FALSE);
 #endif
+			flow->status[i].node = DFLOWnode(flow, flow->status + i);
 			q_enqueue(todo, flow->status + i);
 			flow->status[i].state = DFLOWrunning;
 			PARDEBUG fprintf(stderr, "#enqueue pc=%d claim=" LLFMT "\n", flow->status[i].pc, flow->status[i].argclaim);
@@ -763,7 +848,7 @@ DFLOWscheduler(DataFlow flow, struct worker *w)
 	PARDEBUG fprintf(stderr, "#run %d instructions in dataflow block\n", actions);
 
 	while (actions != tasks ) {
-		f = q_dequeue(flow->done, NULL);
+		f = q_dequeue(flow->done, NULL, -1);
 		if (ATOMIC_GET(exiting, exitingLock))
 			break;
 		if (f == NULL)
@@ -783,6 +868,7 @@ DFLOWscheduler(DataFlow flow, struct worker *w)
 				if (flow->status[i].blocks == 1 ) {
 					flow->status[i].state = DFLOWrunning;
 					flow->status[i].blocks--;
+					flow->status[i].node = DFLOWnode(flow, flow->status + i);
 					q_enqueue(todo, flow->status + i);
 					PARDEBUG fprintf(stderr, "#enqueue pc=%d claim= " LLFMT "\n", flow->status[i].pc, flow->status[i].argclaim);
 				} else {
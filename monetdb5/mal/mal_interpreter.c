@@ -326,6 +326,7 @@ str runMAL(Client cntxt, MalBlkPtr mb, MalBlkPtr mbcaller, MalStkPtr env)
 		if (stk == 0)
 			throw(MAL, "mal.interpreter", MAL_STACK_FAIL);
 		stk->blk = mb;
+		stk->arena = GDKarenacreate();
 		stk->cmd = cntxt->itrace;    /* set debug mode */
 		/*safeguardStack*/
 		if( env){
@@ -420,6 +421,7 @@ callMAL(Client cntxt, MalBlkPtr mb, MalStkPtr *env, ValPtr argv[], char debug)
 			if (stk == NULL)
 				throw(MAL, "mal.interpreter", SQLSTATE(HY001) MAL_MALLOC_FAIL);
 			stk->up = 0;
+			stk->arena = GDKarenacreate();
 			*env = stk;
 		} else {
 			ValPtr lhs, rhs;
@@ -450,8 +452,12 @@ callMAL(Client cntxt, MalBlkPtr mb, MalStkPtr *env, ValPtr argv[], char debug)
 	default:
 		throw(MAL, "mal.interpreter", RUNTIME_UNKNOWN_INSTRUCTION);
 	}
-	if (stk) 
+	if (stk) {
 		garbageCollector(cntxt, mb, stk, TRUE);
+		/* the stack is kept for the next call, but the values
+		 * of this call are gone */
+		GDKarenareset(stk->arena);
+	}
 	if ( ret == MAL_SUCCEED && cntxt->qtimeout && mb->starttime && GDKusec()- mb->starttime > cntxt->qtimeout)
 		throw(MAL, "mal.interpreter", SQLSTATE(HYT00) RUNTIME_QRY_TIMEOUT);
 	return ret;
@@ -471,6 +477,8 @@ str runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 	int i, k;
 	InstrPtr pci = 0;
 	int exceptionVar;
+	MalStkPtr top;
+	GDKarena *oarena;
 	str ret = 0, localGDKerrbuf= GDKerrbuf;
 	ValRecord backups[16];
 	ValPtr backup;
@@ -529,6 +537,11 @@ str runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 			throw(MAL, "mal.interpreter", SQLSTATE(HYT00) RUNTIME_SESSION_TIMEOUT);
 		}
 	} 
+	/* functions can allocate short-lived memory in the arena of the
+	 * query, which belongs to the outermost stack */
+	for (top = stk; top->up; top = top->up)
+		;
+	oarena = GDKarenaset(top->arena);
 	stkpc = startpc;
 	exceptionVar = -1;
 
@@ -1223,6 +1236,7 @@ str runMALsequence(Client cntxt, MalBlkPtr mb, int startpc,
 			ret = createException(MAL, nme, "Exception not caught");
 		}
 	}
+	GDKarenaset(oarena);
 	if( startedProfileQueue)
 		runtimeProfileFinish(cntxt, mb, stk);
 	if ( backup != backups) GDKfree(backup);
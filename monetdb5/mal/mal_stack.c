@@ -96,6 +96,7 @@ freeStack(MalStkPtr stk)
 {
 	if (stk != NULL) {
 		clearStack(stk);
+		GDKarenadestroy(stk->arena);
 		GDKfree(stk);
 	}
 }
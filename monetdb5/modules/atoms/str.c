@@ -3021,7 +3021,7 @@ convertCase(BAT *from, BAT *to, str *res, const char *src, const char *malfunc)
 	if (strNil(src)) {
 		*res = GDKstrdup(str_nil);
 	} else {
-		*res = GDKmalloc(len + 1);
+		*res = GDKarenamalloc(len + 1);
 		if (*res != NULL) {
 			dst = *res;
 			while (src < end) {
@@ -3539,7 +3539,7 @@ STRStrip(str *res, const str *arg1)
 		s += n;
 		len -= n;
 		n = rstrip(s, len, whitespace, NSPACES);
-		*res = GDKstrndup(s, n);
+		*res = GDKarenastrndup(s, n);
 	}
 	if (*res == NULL)
 		throw(MAL, "str.trim", SQLSTATE(HY001) MAL_MALLOC_FAIL);
@@ -3559,7 +3559,7 @@ STRLtrim(str *res, const str *arg1)
 	} else {
 		len = strlen(s);
 		n = lstrip(s, len, whitespace, NSPACES);
-		*res = GDKstrndup(s + n, len - n);
+		*res = GDKarenastrndup(s + n, len - n);
 	}
 	if (*res == NULL)
 		throw(MAL, "str.ltrim", SQLSTATE(HY001) MAL_MALLOC_FAIL);
@@ -3579,7 +3579,7 @@ STRRtrim(str *res, const str *arg1)
 	} else {
 		len = strlen(s);
 		n = rstrip(s, len, whitespace, NSPACES);
-		*res = GDKstrndup(s, n);
+		*res = GDKarenastrndup(s, n);
 	}
 	if (*res == NULL)
 		throw(MAL, "str.rtrim", SQLSTATE(HY001) MAL_MALLOC_FAIL);
@@ -3591,7 +3591,7 @@ static int *
 trimchars(const char *s, size_t *n)
 {
 	size_t len = 0;
-	int *chars = GDKmalloc(strlen(s) * sizeof(int));
+	int *chars = GDKarenamalloc(strlen(s) * sizeof(int));
 	int c;
 
 	if (chars == NULL)
@@ -3629,7 +3629,7 @@ STRStrip2(str *res, const str *arg1, const str *arg2)
 		len -= n;
 		n = rstrip(s, len, chars, nchars);
 		GDKfree(chars);
-		*res = GDKstrndup(s, n);
+		*res = GDKarenastrndup(s, n);
 	}
 	if (*res == NULL)
 		throw(MAL, "str.trim", SQLSTATE(HY001) MAL_MALLOC_FAIL);
@@ -3656,7 +3656,7 @@ STRLtrim2(str *res, const str *arg1, const str *arg2)
 		len = strlen(s);
 		n = lstrip(s, len, chars, nchars);
 		GDKfree(chars);
-		*res = GDKstrndup(s + n, len - n);
+		*res = GDKarenastrndup(s + n, len - n);
 	}
 	if (*res == NULL)
 		throw(MAL, "str.ltrim", SQLSTATE(HY001) MAL_MALLOC_FAIL);
@@ -3683,7 +3683,7 @@ STRRtrim2(str *res, const str *arg1, const str *arg2)
 		len = strlen(s);
 		n = rstrip(s, len, chars, nchars);
 		GDKfree(chars);
-		*res = GDKstrndup(s, n);
+		*res = GDKarenastrndup(s, n);
 	}
 	if (*res == NULL)
 		throw(MAL, "str.rtrim", SQLSTATE(HY001) MAL_MALLOC_FAIL);
@@ -3707,7 +3707,7 @@ pad(const char *s, const char *pad, int len, int left)
 	if (slen > (size_t) len) {
 		/* truncate */
 		pad = UTF8_strtail(s, len);
-		return GDKstrndup(s, pad - s);
+		return GDKarenastrndup(s, pad - s);
 	}
 
 	padlen = UTF8_strlen(pad);
@@ -3722,7 +3722,7 @@ pad(const char *s, const char *pad, int len, int left)
 		residual = (size_t) (UTF8_strtail(pad, (int) residual) - pad);
 	padlen = strlen(pad);
 	slen = strlen(s);
-	res = GDKmalloc(slen + repeats * padlen + residual + 1);
+	res = GDKarenamalloc(slen + repeats * padlen + residual + 1);
 	if (res == NULL)
 		return NULL;
 	if (left) {
@@ -57,7 +57,8 @@ AGGRgrouped(bat *retval1, bat *retval2, const bat *bid, const bat *gid, const ba
 		throw(MAL, malfunc, SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
 	}
 	if (tp == TYPE_any &&
-		(grpfunc1 == BATgroupmedian || quantilefunc == BATgroupquantile))
+		(grpfunc1 == BATgroupmedian || quantilefunc == BATgroupquantile ||
+		 quantilefunc == BATgroupapprox_quantile))
 		tp = b->ttype;
 
 	if (grpfunc1) {
@@ -851,6 +852,27 @@ AGGRquantile(void *retval, const bat *bid, const bat *qid)
 	return err;
 }
 
+mal_export str AGGRquantiles(bat *retval, const bat *bid, const bat *qid);
+str
+AGGRquantiles(bat *retval, const bat *bid, const bat *qid)
+{
+	BAT *b, *q, *bn;
+
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, "aggr.quantiles", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if ((q = BATdescriptor(*qid)) == NULL) {
+		BBPunfix(b->batCacheid);
+		throw(MAL, "aggr.quantiles", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	bn = BATquantiles(b, NULL, q, true);
+	BBPunfix(b->batCacheid);
+	BBPunfix(q->batCacheid);
+	if (bn == NULL)
+		throw(MAL, "aggr.quantiles", GDK_EXCEPTION);
+	BBPkeepref(*retval = bn->batCacheid);
+	return MAL_SUCCEED;
+}
+
 mal_export str AGGRsubquantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils);
 str
 AGGRsubquantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils)
@@ -869,6 +891,76 @@ AGGRsubquantilecand(bat *retval, const bat *bid, const bat *quantile, const bat
 					   quantile, "aggr.subquantile");
 }
 
+/* approximate count distinct */
+mal_export str AGGRapprox_count_distinct(lng *retval, const bat *bid);
+str
+AGGRapprox_count_distinct(lng *retval, const bat *bid)
+{
+	str err;
+	bat rval;
+	if ((err = AGGRgrouped(&rval, NULL, bid, NULL, NULL, NULL, 1,
+						   0, TYPE_lng, BATgroupapprox_count_distinct, NULL,
+						   NULL, NULL, "aggr.approx_count_distinct")) == MAL_SUCCEED) {
+		oid pos = 0;
+		err = ALGfetchoid(retval, &rval, &pos);
+		BBPrelease(rval);
+	}
+	return err;
+}
+
+mal_export str AGGRsubapprox_count_distinct(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubapprox_count_distinct(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+					   0, TYPE_lng, BATgroupapprox_count_distinct, NULL,
+					   NULL, NULL, "aggr.subapprox_count_distinct");
+}
+
+mal_export str AGGRsubapprox_count_distinctcand(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+str
+AGGRsubapprox_count_distinctcand(bat *retval, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, sid, *skip_nils,
+					   0, TYPE_lng, BATgroupapprox_count_distinct, NULL,
+					   NULL, NULL, "aggr.subapprox_count_distinct");
+}
+
+/* approximate quantiles */
+mal_export str AGGRapprox_quantile(void *retval, const bat *bid, const bat *qid);
+str
+AGGRapprox_quantile(void *retval, const bat *bid, const bat *qid)
+{
+	str err;
+	bat rval;
+	if ((err = AGGRgrouped(&rval, NULL, bid, NULL, NULL, NULL, 1,
+						   0, TYPE_any, NULL, NULL, BATgroupapprox_quantile,
+						   qid, "aggr.approx_quantile")) == MAL_SUCCEED) {
+		oid pos = 0;
+		err = ALGfetchoid(retval, &rval, &pos);
+		BBPrelease(rval);
+	}
+	return err;
+}
+
+mal_export str AGGRsubapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils);
+str
+AGGRsubapprox_quantile(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, NULL, *skip_nils,
+					   0, TYPE_any, NULL, NULL, BATgroupapprox_quantile,
+					   quantile, "aggr.subapprox_quantile");
+}
+
+mal_export str AGGRsubapprox_quantilecand(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+str
+AGGRsubapprox_quantilecand(bat *retval, const bat *bid, const bat *quantile, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	return AGGRgrouped(retval, NULL, bid, gid, eid, sid, *skip_nils,
+					   0, TYPE_any, NULL, NULL, BATgroupapprox_quantile,
+					   quantile, "aggr.subapprox_quantile");
+}
+
 static str
 AGGRgroup_str_concat(bat *retval1, const bat *bid, const bat *gid, const bat *eid, const bat *sid, int skip_nils,
 					 int abort_on_error, BAT *(*str_func)(BAT *, BAT *, BAT *, BAT *, int, int, const str),
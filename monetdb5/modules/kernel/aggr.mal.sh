@@ -232,6 +232,10 @@ command quantile(b:bat[:any_1],q:bat[:dbl]) :any_1
 address AGGRquantile
 comment "Quantile aggregate";
 
+command quantiles(b:bat[:any_1],q:bat[:dbl]) :bat[:any_1]
+address AGGRquantiles
+comment "Quantile aggregate for each of the quantiles in q, determined in a single pass";
+
 command subquantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:any_1]
 address AGGRsubquantile
 comment "Grouped quantile aggregate";
@@ -240,6 +244,30 @@ command subquantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],s:bat[:o
 address AGGRsubquantilecand
 comment "Grouped quantile aggregate with candidate list";
 
+command approx_count_distinct(b:bat[:any_1]) :lng
+address AGGRapprox_count_distinct
+comment "Approximate number of distinct non-nil values, estimated with HyperLogLog";
+
+command subapprox_count_distinct(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:lng]
+address AGGRsubapprox_count_distinct
+comment "Grouped approximate number of distinct non-nil values";
+
+command subapprox_count_distinct(b:bat[:any_1],g:bat[:oid],e:bat[:any_2],s:bat[:oid],skip_nils:bit) :bat[:lng]
+address AGGRsubapprox_count_distinctcand
+comment "Grouped approximate number of distinct non-nil values with candidate list";
+
+command approx_quantile(b:bat[:any_1],q:bat[:dbl]) :any_1
+address AGGRapprox_quantile
+comment "Approximate quantile aggregate, estimated with a t-digest";
+
+command subapprox_quantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],skip_nils:bit) :bat[:any_1]
+address AGGRsubapprox_quantile
+comment "Grouped approximate quantile aggregate";
+
+command subapprox_quantile(b:bat[:any_1],q:bat[:dbl],g:bat[:oid],e:bat[:any_2],s:bat[:oid],skip_nils:bit) :bat[:any_1]
+address AGGRsubapprox_quantilecand
+comment "Grouped approximate quantile aggregate with candidate list";
+
 EOF
 
 cat <<EOF
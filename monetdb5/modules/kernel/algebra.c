@@ -512,6 +512,35 @@ ALGintersect(bat *r1, const bat *lid, const bat *rid, const bat *slid, const bat
 				   NULL, NULL, NULL, NULL, BATintersect, "algebra.intersect");
 }
 
+str
+ALGbloom2(bat *result, const bat *bid, const bat *sid)
+{
+	BAT *b, *s = NULL, *bn;
+
+	if ((b = BATdescriptor(*bid)) == NULL) {
+		throw(MAL, "algebra.bloom", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	if (sid && !is_bat_nil(*sid) && (s = BATdescriptor(*sid)) == NULL) {
+		BBPunfix(b->batCacheid);
+		throw(MAL, "algebra.bloom", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	bn = BATbloom(b, s);
+	BBPunfix(b->batCacheid);
+	if (s)
+		BBPunfix(s->batCacheid);
+	if (bn == NULL)
+		throw(MAL, "algebra.bloom", GDK_EXCEPTION);
+	*result = bn->batCacheid;
+	BBPkeepref(*result);
+	return MAL_SUCCEED;
+}
+
+str
+ALGbloom1(bat *result, const bat *bid)
+{
+	return ALGbloom2(result, bid, NULL);
+}
+
 /* algebra.firstn(b:bat[:any],
  *                [ s:bat[:oid],
  *                [ g:bat[:oid], ] ]
@@ -686,6 +715,12 @@ ALGprojection(bat *result, const bat *lid, const bat *rid)
 	return ALGbinary(result, lid, rid, BATproject, "algebra.projection");
 }
 
+str
+ALGbloomprobe(bat *result, const bat *bid, const bat *fid)
+{
+	return ALGbinary(result, bid, fid, BATbloomprobe, "algebra.bloomprobe");
+}
+
 str
 ALGsort33(bat *result, bat *norder, bat *ngroup, const bat *bid, const bat *order, const bat *group, const bit *reverse, const bit *stable)
 {
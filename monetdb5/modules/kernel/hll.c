@@ -0,0 +1,319 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * HyperLogLog sketches
+ * The approximate number of distinct values of a column is estimated
+ * from a HyperLogLog sketch of the column (see BATgrouphll in
+ * gdk_aggr.c).  This module makes the sketches available as sqlblob
+ * values, so that they can be stored and merged later: the merge of
+ * the sketches of some columns is the sketch of their union.  This
+ * way, partial sketches of the pieces of a column (or of the data of
+ * each day) can be combined without looking at the values again.
+ *
+ * A sketch is stored as one byte with the precision p, followed by
+ * the 2^p registers.
+ */
+#include "monetdb_config.h"
+#include "mal.h"
+#include "mal_exception.h"
+#include "blob.h"
+
+#define HLLsize(p)	((size_t) 1 + ((size_t) 1 << (p)))
+
+mal_export str HLLsketch(blob **ret, const bat *bid);
+mal_export str HLLsubsketch(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+mal_export str HLLsubsketchcand(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+mal_export str HLLmerge(blob **ret, const bat *bid);
+mal_export str HLLsubmerge(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+mal_export str HLLsubmergecand(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+mal_export str HLLcount_sketch(lng *ret, blob **h);
+
+/* return whether h is a (non-nil) sketch of the precision we create */
+static bool
+HLLvalid(const blob *h)
+{
+	return h->nitems == HLLsize(HLL_PRECISION) &&
+		(unsigned char) h->data[0] == HLL_PRECISION;
+}
+
+static blob *
+HLLnew(void)
+{
+	blob *h = GDKzalloc(blobsize(HLLsize(HLL_PRECISION)));
+
+	if (h == NULL)
+		return NULL;
+	h->nitems = HLLsize(HLL_PRECISION);
+	h->data[0] = HLL_PRECISION;
+	return h;
+}
+
+/* register-wise maximum */
+static void
+HLLunion(uint8_t *restrict dst, const uint8_t *restrict src)
+{
+	int j;
+
+	for (j = 0; j < HLL_REGISTERS; j++)
+		if (dst[j] < src[j])
+			dst[j] = src[j];
+}
+
+str
+HLLsketch(blob **ret, const bat *bid)
+{
+	BAT *b;
+	BUN ngrp;
+	oid min;
+	uint8_t *regs;
+	blob *h;
+
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, "hll.sketch", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	regs = BATgrouphll(b, NULL, NULL, NULL, &ngrp, &min);
+	BBPunfix(b->batCacheid);
+	if (regs == NULL)
+		throw(MAL, "hll.sketch", GDK_EXCEPTION);
+	if ((h = HLLnew()) == NULL) {
+		GDKfree(regs);
+		throw(MAL, "hll.sketch", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	memcpy(h->data + 1, regs, HLL_REGISTERS);
+	GDKfree(regs);
+	*ret = h;
+	return MAL_SUCCEED;
+}
+
+static str
+HLLgroupsketch(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid)
+{
+	BAT *b, *g, *e, *s = NULL, *bn;
+	BUN ngrp, i;
+	oid min;
+	uint8_t *regs;
+	blob *h;
+
+	b = BATdescriptor(*bid);
+	g = BATdescriptor(*gid);
+	e = BATdescriptor(*eid);
+	if (sid)
+		s = BATdescriptor(*sid);
+	if (b == NULL || g == NULL || e == NULL || (sid && s == NULL)) {
+		if (b)
+			BBPunfix(b->batCacheid);
+		if (g)
+			BBPunfix(g->batCacheid);
+		if (e)
+			BBPunfix(e->batCacheid);
+		if (s)
+			BBPunfix(s->batCacheid);
+		throw(MAL, "hll.subsketch", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	regs = BATgrouphll(b, g, e, s, &ngrp, &min);
+	BBPunfix(b->batCacheid);
+	BBPunfix(g->batCacheid);
+	BBPunfix(e->batCacheid);
+	if (s)
+		BBPunfix(s->batCacheid);
+	if (regs == NULL)
+		throw(MAL, "hll.subsketch", GDK_EXCEPTION);
+	bn = COLnew(min, TYPE_sqlblob, ngrp, TRANSIENT);
+	h = HLLnew();
+	if (bn == NULL || h == NULL) {
+		BBPreclaim(bn);
+		GDKfree(h);
+		GDKfree(regs);
+		throw(MAL, "hll.subsketch", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	for (i = 0; i < ngrp; i++) {
+		memcpy(h->data + 1, regs + i * HLL_REGISTERS, HLL_REGISTERS);
+		if (BUNappend(bn, h, false) != GDK_SUCCEED) {
+			BBPreclaim(bn);
+			GDKfree(h);
+			GDKfree(regs);
+			throw(MAL, "hll.subsketch", GDK_EXCEPTION);
+		}
+	}
+	GDKfree(h);
+	GDKfree(regs);
+	*ret = bn->batCacheid;
+	BBPkeepref(*ret);
+	return MAL_SUCCEED;
+}
+
+str
+HLLsubsketch(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	(void) skip_nils;	/* nils are never counted */
+	return HLLgroupsketch(ret, bid, gid, eid, NULL);
+}
+
+str
+HLLsubsketchcand(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	(void) skip_nils;
+	return HLLgroupsketch(ret, bid, gid, eid, sid);
+}
+
+/* Merge the sketches in b per group (or all of them if g is NULL)
+ * into ngrp sketches of HLL_REGISTERS registers in regs; nils are
+ * skipped. */
+static str
+HLLmerge_sketches(uint8_t *regs, BAT *b, BAT *g, oid min, oid max,
+		  BUN start, BUN end, const oid *cand, const oid *candend,
+		  const char *func)
+{
+	BATiter bi = bat_iterator(b);
+	const oid *gids = NULL;
+	oid gbase = 0, gid;
+	const blob *h;
+	BUN i;
+
+	if (g) {
+		if (BATtdense(g))
+			gbase = g->tseqbase;
+		else
+			gids = (const oid *) Tloc(g, 0);
+	}
+	for (;;) {
+		if (cand) {
+			if (cand == candend)
+				break;
+			i = *cand++ - b->hseqbase;
+		} else {
+			if (start == end)
+				break;
+			i = start++;
+		}
+		gid = g ? gids ? gids[i] : gbase + i : min;
+		if (gid < min || gid > max)
+			continue;
+		h = (const blob *) BUNtvar(bi, i);
+		if (h->nitems == ~(size_t) 0)
+			continue;
+		if (!HLLvalid(h))
+			throw(MAL, func, SQLSTATE(42000) "Not a HyperLogLog sketch");
+		HLLunion(regs + (gid - min) * HLL_REGISTERS,
+			 (const uint8_t *) h->data + 1);
+	}
+	return MAL_SUCCEED;
+}
+
+str
+HLLmerge(blob **ret, const bat *bid)
+{
+	BAT *b;
+	blob *h;
+	str msg;
+
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, "hll.merge", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if ((h = HLLnew()) == NULL) {
+		BBPunfix(b->batCacheid);
+		throw(MAL, "hll.merge", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	msg = HLLmerge_sketches((uint8_t *) h->data + 1, b, NULL, 0, 0,
+				0, BATcount(b), NULL, NULL, "hll.merge");
+	BBPunfix(b->batCacheid);
+	if (msg != MAL_SUCCEED) {
+		GDKfree(h);
+		return msg;
+	}
+	*ret = h;
+	return MAL_SUCCEED;
+}
+
+static str
+HLLgroupmerge(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid)
+{
+	BAT *b, *g, *e, *s = NULL, *bn = NULL;
+	oid min, max;
+	BUN ngrp, start, end, i;
+	const oid *cand = NULL, *candend = NULL;
+	const char *err;
+	uint8_t *regs = NULL;
+	blob *h = NULL;
+	str msg = MAL_SUCCEED;
+
+	b = BATdescriptor(*bid);
+	g = BATdescriptor(*gid);
+	e = BATdescriptor(*eid);
+	if (sid)
+		s = BATdescriptor(*sid);
+	if (b == NULL || g == NULL || e == NULL || (sid && s == NULL)) {
+		msg = createException(MAL, "hll.submerge", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+		goto bailout;
+	}
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		msg = createException(MAL, "hll.submerge", "%s", err);
+		goto bailout;
+	}
+	bn = COLnew(min, TYPE_sqlblob, ngrp, TRANSIENT);
+	regs = GDKzalloc((ngrp ? ngrp : 1) * HLL_REGISTERS);
+	h = HLLnew();
+	if (bn == NULL || regs == NULL || h == NULL) {
+		msg = createException(MAL, "hll.submerge", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	if (ngrp > 0 &&
+	    (msg = HLLmerge_sketches(regs, b, g, min, max, start, end,
+				     cand, candend, "hll.submerge")) != MAL_SUCCEED)
+		goto bailout;
+	for (i = 0; i < ngrp; i++) {
+		memcpy(h->data + 1, regs + i * HLL_REGISTERS, HLL_REGISTERS);
+		if (BUNappend(bn, h, false) != GDK_SUCCEED) {
+			msg = createException(MAL, "hll.submerge", GDK_EXCEPTION);
+			goto bailout;
+		}
+	}
+	*ret = bn->batCacheid;
+	BBPkeepref(*ret);
+	bn = NULL;
+  bailout:
+	if (b)
+		BBPunfix(b->batCacheid);
+	if (g)
+		BBPunfix(g->batCacheid);
+	if (e)
+		BBPunfix(e->batCacheid);
+	if (s)
+		BBPunfix(s->batCacheid);
+	BBPreclaim(bn);
+	GDKfree(regs);
+	GDKfree(h);
+	return msg;
+}
+
+str
+HLLsubmerge(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	(void) skip_nils;	/* nil sketches are always skipped */
+	return HLLgroupmerge(ret, bid, gid, eid, NULL);
+}
+
+str
+HLLsubmergecand(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	(void) skip_nils;
+	return HLLgroupmerge(ret, bid, gid, eid, sid);
+}
+
+str
+HLLcount_sketch(lng *ret, blob **h)
+{
+	if ((*h)->nitems == ~(size_t) 0) {
+		*ret = lng_nil;
+		return MAL_SUCCEED;
+	}
+	if (!HLLvalid(*h))
+		throw(MAL, "hll.count", SQLSTATE(42000) "Not a HyperLogLog sketch");
+	*ret = HLLcount((const uint8_t *) (*h)->data + 1, HLL_PRECISION);
+	return MAL_SUCCEED;
+}
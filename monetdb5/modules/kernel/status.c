@@ -23,6 +23,7 @@
 #include "gdk.h"
 #include <time.h>
 #include "mal_exception.h"
+#include "mal_dataflow.h"
 #include "status.h"
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
@@ -218,6 +219,64 @@ SYSmemStatistics(bat *ret, bat *ret2)
 	if (BUNappend(bn, "memincr", false) != GDK_SUCCEED ||
 		BUNappend(b, &i, false) != GDK_SUCCEED)
 		goto bailout;
+	/* NUMA placement of heaps and of dataflow work */
+	i = (lng) MT_nr_nodes();
+	if (BUNappend(bn, "numa_nodes", false) != GDK_SUCCEED ||
+		BUNappend(b, &i, false) != GDK_SUCCEED)
+		goto bailout;
+	i = (lng) GDKnuma_local();
+	if (BUNappend(bn, "numa_alloc_local", false) != GDK_SUCCEED ||
+		BUNappend(b, &i, false) != GDK_SUCCEED)
+		goto bailout;
+	i = (lng) GDKnuma_remote();
+	if (BUNappend(bn, "numa_alloc_remote", false) != GDK_SUCCEED ||
+		BUNappend(b, &i, false) != GDK_SUCCEED)
+		goto bailout;
+	{
+		lng local, remote;
+
+		DFLOWnumastatistics(&local, &remote);
+		if (BUNappend(bn, "numa_exec_local", false) != GDK_SUCCEED ||
+			BUNappend(b, &local, false) != GDK_SUCCEED ||
+			BUNappend(bn, "numa_exec_remote", false) != GDK_SUCCEED ||
+			BUNappend(b, &remote, false) != GDK_SUCCEED)
+			goto bailout;
+	}
+	/* pool of freed heaps */
+	{
+		size_t sz;
+		lng hits, misses;
+
+		HEAPpoolstatistics(&sz, &hits, &misses);
+		i = (lng) sz;
+		if (BUNappend(bn, "heappool_size", false) != GDK_SUCCEED ||
+			BUNappend(b, &i, false) != GDK_SUCCEED ||
+			BUNappend(bn, "heappool_hits", false) != GDK_SUCCEED ||
+			BUNappend(b, &hits, false) != GDK_SUCCEED ||
+			BUNappend(bn, "heappool_misses", false) != GDK_SUCCEED ||
+			BUNappend(b, &misses, false) != GDK_SUCCEED)
+			goto bailout;
+	}
+	/* allocations in query arenas */
+	{
+		lng allocs, mallocs;
+
+		GDKarenastatistics(&allocs, &mallocs);
+		if (BUNappend(bn, "arena_allocs", false) != GDK_SUCCEED ||
+			BUNappend(b, &allocs, false) != GDK_SUCCEED ||
+			BUNappend(bn, "arena_mallocs", false) != GDK_SUCCEED ||
+			BUNappend(b, &mallocs, false) != GDK_SUCCEED)
+			goto bailout;
+	}
+	/* transparent huge pages */
+	i = (lng) MT_hugepagesize();
+	if (BUNappend(bn, "hugepage_size", false) != GDK_SUCCEED ||
+		BUNappend(b, &i, false) != GDK_SUCCEED)
+		goto bailout;
+	i = (lng) MT_hugepage_rss();
+	if (BUNappend(bn, "hugepage_rss", false) != GDK_SUCCEED ||
+		BUNappend(b, &i, false) != GDK_SUCCEED)
+		goto bailout;
 	if (pseudo(ret,ret2,bn,b))
 		goto bailout;
 	return MAL_SUCCEED;
@@ -0,0 +1,380 @@
+/*
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0.  If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright 1997 - July 2008 CWI, August 2008 - 2018 MonetDB B.V.
+ */
+
+/*
+ * t-digest sketches
+ * Approximate quantiles of a column are determined from a t-digest of
+ * the column (see BATgrouptdigest in gdk_aggr.c).  This module makes
+ * the digests available as sqlblob values, so that they can be stored
+ * and merged later: the merge of the digests of some columns
+ * summarizes their union, with about the same accuracy as the digest
+ * of the union itself.
+ *
+ * A sketch is stored as a sequence of dbl values: the smallest and the
+ * largest value, followed by the mean and the weight of each
+ * centroid in ascending order of their means.  A sketch of no values
+ * has no centroids.
+ */
+#include "monetdb_config.h"
+#include "mal.h"
+#include "mal_exception.h"
+#include "blob.h"
+
+#define TDsize(n)	((2 + 2 * (size_t) (n)) * sizeof(dbl))
+
+mal_export str TDIGESTsketch(blob **ret, const bat *bid);
+mal_export str TDIGESTsubsketch(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+mal_export str TDIGESTsubsketchcand(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+mal_export str TDIGESTmerge_sketch(blob **ret, const bat *bid);
+mal_export str TDIGESTsubmerge(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils);
+mal_export str TDIGESTsubmergecand(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils);
+mal_export str TDIGESTquantile_sketch(dbl *ret, blob **h, const dbl *q);
+mal_export str TDIGESTquantile_sketch_bat(dbl *ret, blob **h, const bat *qid);
+
+static const tdigest TDempty = {.min = 0, .max = 0, .n = 0};
+
+/* Store digest td in blob h, which must be large enough. */
+static void
+TDtoblob(blob *h, const tdigest *td)
+{
+	char *p = h->data;
+	BUN i;
+
+	h->nitems = TDsize(td->n);
+	memcpy(p, &td->min, sizeof(dbl));
+	p += sizeof(dbl);
+	memcpy(p, &td->max, sizeof(dbl));
+	p += sizeof(dbl);
+	for (i = 0; i < td->n; i++) {
+		memcpy(p, &td->mean[i], sizeof(dbl));
+		p += sizeof(dbl);
+		memcpy(p, &td->weight[i], sizeof(dbl));
+		p += sizeof(dbl);
+	}
+}
+
+/* Load blob h (non-nil) into digest td; return whether h is a valid
+ * sketch. */
+static bool
+TDfromblob(tdigest *td, const blob *h)
+{
+	const char *p = h->data;
+	BUN i;
+
+	if (h->nitems < TDsize(0) ||
+	    h->nitems % (2 * sizeof(dbl)) != 0 ||
+	    h->nitems > TDsize(TDIGEST_CENTROIDS))
+		return false;
+	td->n = (BUN) (h->nitems / (2 * sizeof(dbl)) - 1);
+	memcpy(&td->min, p, sizeof(dbl));
+	p += sizeof(dbl);
+	memcpy(&td->max, p, sizeof(dbl));
+	p += sizeof(dbl);
+	for (i = 0; i < td->n; i++) {
+		memcpy(&td->mean[i], p, sizeof(dbl));
+		p += sizeof(dbl);
+		memcpy(&td->weight[i], p, sizeof(dbl));
+		p += sizeof(dbl);
+		if (is_dbl_nil(td->mean[i]) || !(td->weight[i] > 0) ||
+		    (i > 0 && td->mean[i] < td->mean[i - 1]))
+			return false;
+	}
+	if (td->n == 0)
+		td->min = td->max = dbl_nil;
+	else if (!(td->min <= td->mean[0]) || !(td->max >= td->mean[td->n - 1]))
+		return false;
+	return true;
+}
+
+static blob *
+TDnew(void)
+{
+	return GDKmalloc(blobsize(TDsize(TDIGEST_CENTROIDS)));
+}
+
+str
+TDIGESTsketch(blob **ret, const bat *bid)
+{
+	BAT *b;
+	BUN ngrp;
+	oid min;
+	tdigest *tds;
+	blob *h;
+
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, "tdigest.sketch", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	tds = BATgrouptdigest(b, NULL, NULL, NULL, &ngrp, &min);
+	BBPunfix(b->batCacheid);
+	if (tds == NULL)
+		throw(MAL, "tdigest.sketch", GDK_EXCEPTION);
+	if ((h = TDnew()) == NULL) {
+		GDKfree(tds);
+		throw(MAL, "tdigest.sketch", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	TDtoblob(h, &tds[0]);
+	GDKfree(tds);
+	*ret = h;
+	return MAL_SUCCEED;
+}
+
+static str
+TDIGESTgroupsketch(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid)
+{
+	BAT *b, *g, *e, *s = NULL, *bn;
+	BUN ngrp, i;
+	oid min;
+	tdigest *tds;
+	blob *h;
+
+	b = BATdescriptor(*bid);
+	g = BATdescriptor(*gid);
+	e = BATdescriptor(*eid);
+	if (sid)
+		s = BATdescriptor(*sid);
+	if (b == NULL || g == NULL || e == NULL || (sid && s == NULL)) {
+		if (b)
+			BBPunfix(b->batCacheid);
+		if (g)
+			BBPunfix(g->batCacheid);
+		if (e)
+			BBPunfix(e->batCacheid);
+		if (s)
+			BBPunfix(s->batCacheid);
+		throw(MAL, "tdigest.subsketch", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	}
+	tds = BATgrouptdigest(b, g, e, s, &ngrp, &min);
+	BBPunfix(b->batCacheid);
+	BBPunfix(g->batCacheid);
+	BBPunfix(e->batCacheid);
+	if (s)
+		BBPunfix(s->batCacheid);
+	if (tds == NULL)
+		throw(MAL, "tdigest.subsketch", GDK_EXCEPTION);
+	bn = COLnew(min, TYPE_sqlblob, ngrp, TRANSIENT);
+	h = TDnew();
+	if (bn == NULL || h == NULL) {
+		BBPreclaim(bn);
+		GDKfree(h);
+		GDKfree(tds);
+		throw(MAL, "tdigest.subsketch", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	for (i = 0; i < ngrp; i++) {
+		TDtoblob(h, &tds[i]);
+		if (BUNappend(bn, h, false) != GDK_SUCCEED) {
+			BBPreclaim(bn);
+			GDKfree(h);
+			GDKfree(tds);
+			throw(MAL, "tdigest.subsketch", GDK_EXCEPTION);
+		}
+	}
+	GDKfree(h);
+	GDKfree(tds);
+	*ret = bn->batCacheid;
+	BBPkeepref(*ret);
+	return MAL_SUCCEED;
+}
+
+str
+TDIGESTsubsketch(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	(void) skip_nils;	/* nils are never included */
+	return TDIGESTgroupsketch(ret, bid, gid, eid, NULL);
+}
+
+str
+TDIGESTsubsketchcand(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	(void) skip_nils;
+	return TDIGESTgroupsketch(ret, bid, gid, eid, sid);
+}
+
+/* Merge the sketches in b per group (or all of them if g is NULL)
+ * into the ngrp digests tds; nils are skipped. */
+static str
+TDIGESTmerge_sketches(tdigest *tds, BAT *b, BAT *g, oid min, oid max,
+		      BUN start, BUN end, const oid *cand, const oid *candend,
+		      const char *func)
+{
+	BATiter bi = bat_iterator(b);
+	const oid *gids = NULL;
+	oid gbase = 0, gid;
+	const blob *h;
+	tdigest td;
+	BUN i;
+
+	if (g) {
+		if (BATtdense(g))
+			gbase = g->tseqbase;
+		else
+			gids = (const oid *) Tloc(g, 0);
+	}
+	for (;;) {
+		if (cand) {
+			if (cand == candend)
+				break;
+			i = *cand++ - b->hseqbase;
+		} else {
+			if (start == end)
+				break;
+			i = start++;
+		}
+		gid = g ? gids ? gids[i] : gbase + i : min;
+		if (gid < min || gid > max)
+			continue;
+		h = (const blob *) BUNtvar(bi, i);
+		if (h->nitems == ~(size_t) 0)
+			continue;
+		if (!TDfromblob(&td, h))
+			throw(MAL, func, SQLSTATE(42000) "Not a t-digest sketch");
+		TDIGESTmerge(&tds[gid - min], &td);
+	}
+	return MAL_SUCCEED;
+}
+
+str
+TDIGESTmerge_sketch(blob **ret, const bat *bid)
+{
+	BAT *b;
+	tdigest td = TDempty;
+	blob *h;
+	str msg;
+
+	if ((b = BATdescriptor(*bid)) == NULL)
+		throw(MAL, "tdigest.merge", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	if ((h = TDnew()) == NULL) {
+		BBPunfix(b->batCacheid);
+		throw(MAL, "tdigest.merge", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	msg = TDIGESTmerge_sketches(&td, b, NULL, 0, 0, 0, BATcount(b),
+				    NULL, NULL, "tdigest.merge");
+	BBPunfix(b->batCacheid);
+	if (msg != MAL_SUCCEED) {
+		GDKfree(h);
+		return msg;
+	}
+	if (td.n == 0)
+		td.min = td.max = dbl_nil;
+	TDtoblob(h, &td);
+	*ret = h;
+	return MAL_SUCCEED;
+}
+
+static str
+TDIGESTgroupmerge(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid)
+{
+	BAT *b, *g, *e, *s = NULL, *bn = NULL;
+	oid min, max;
+	BUN ngrp, start, end, i;
+	const oid *cand = NULL, *candend = NULL;
+	const char *err;
+	tdigest *tds = NULL;
+	blob *h = NULL;
+	str msg = MAL_SUCCEED;
+
+	b = BATdescriptor(*bid);
+	g = BATdescriptor(*gid);
+	e = BATdescriptor(*eid);
+	if (sid)
+		s = BATdescriptor(*sid);
+	if (b == NULL || g == NULL || e == NULL || (sid && s == NULL)) {
+		msg = createException(MAL, "tdigest.submerge", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+		goto bailout;
+	}
+	if ((err = BATgroupaggrinit(b, g, e, s, &min, &max, &ngrp, &start, &end,
+				    &cand, &candend)) != NULL) {
+		msg = createException(MAL, "tdigest.submerge", "%s", err);
+		goto bailout;
+	}
+	bn = COLnew(min, TYPE_sqlblob, ngrp, TRANSIENT);
+	tds = GDKmalloc((ngrp ? ngrp : 1) * sizeof(tdigest));
+	h = TDnew();
+	if (bn == NULL || tds == NULL || h == NULL) {
+		msg = createException(MAL, "tdigest.submerge", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+		goto bailout;
+	}
+	for (i = 0; i < ngrp; i++)
+		tds[i] = TDempty;
+	if (ngrp > 0 &&
+	    (msg = TDIGESTmerge_sketches(tds, b, g, min, max, start, end,
+					 cand, candend, "tdigest.submerge")) != MAL_SUCCEED)
+		goto bailout;
+	for (i = 0; i < ngrp; i++) {
+		if (tds[i].n == 0)
+			tds[i].min = tds[i].max = dbl_nil;
+		TDtoblob(h, &tds[i]);
+		if (BUNappend(bn, h, false) != GDK_SUCCEED) {
+			msg = createException(MAL, "tdigest.submerge", GDK_EXCEPTION);
+			goto bailout;
+		}
+	}
+	*ret = bn->batCacheid;
+	BBPkeepref(*ret);
+	bn = NULL;
+  bailout:
+	if (b)
+		BBPunfix(b->batCacheid);
+	if (g)
+		BBPunfix(g->batCacheid);
+	if (e)
+		BBPunfix(e->batCacheid);
+	if (s)
+		BBPunfix(s->batCacheid);
+	BBPreclaim(bn);
+	GDKfree(tds);
+	GDKfree(h);
+	return msg;
+}
+
+str
+TDIGESTsubmerge(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bit *skip_nils)
+{
+	(void) skip_nils;	/* nil sketches are always skipped */
+	return TDIGESTgroupmerge(ret, bid, gid, eid, NULL);
+}
+
+str
+TDIGESTsubmergecand(bat *ret, const bat *bid, const bat *gid, const bat *eid, const bat *sid, const bit *skip_nils)
+{
+	(void) skip_nils;
+	return TDIGESTgroupmerge(ret, bid, gid, eid, sid);
+}
+
+str
+TDIGESTquantile_sketch(dbl *ret, blob **h, const dbl *q)
+{
+	tdigest td;
+
+	if ((*h)->nitems == ~(size_t) 0 || is_dbl_nil(*q)) {
+		*ret = dbl_nil;
+		return MAL_SUCCEED;
+	}
+	if (*q < 0 || *q > 1)
+		throw(MAL, "tdigest.quantile",
+		      "quantile value of %f is not in range [0,1]", *q);
+	if (!TDfromblob(&td, *h))
+		throw(MAL, "tdigest.quantile", SQLSTATE(42000) "Not a t-digest sketch");
+	*ret = TDIGESTquantile(&td, *q);
+	return MAL_SUCCEED;
+}
+
+/* the quantile is the first value of q (the median if q is empty), as
+ * for aggr.quantile */
+str
+TDIGESTquantile_sketch_bat(dbl *ret, blob **h, const bat *qid)
+{
+	BAT *q;
+	dbl qvalue = 0.5;
+
+	if ((q = BATdescriptor(*qid)) == NULL)
+		throw(MAL, "tdigest.quantile", SQLSTATE(HY002) RUNTIME_OBJECT_MISSING);
+	assert(q->ttype == TYPE_dbl);
+	if (BATcount(q) > 0)
+		qvalue = ((const dbl *) Tloc(q, 0))[0];
+	BBPunfix(q->batCacheid);
+	return TDIGESTquantile_sketch(ret, h, &qvalue);
+}
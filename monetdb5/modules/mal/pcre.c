@@ -438,6 +438,35 @@ pcre_compile_wrap(pcre **res, const char *pattern, bit insensitive)
 		}																\
 	} while (0)
 
+/* arguments of pcre_likepred, the predicate used when matching against
+ * the dictionary of a string column (see BATdictselect) */
+struct pcre_likearg {
+#ifdef HAVE_LIBPCRE
+	pcre *re;
+	pcre_extra *pe;
+#else
+	regex_t *re;
+#endif
+	bool anti;
+};
+
+static bool
+pcre_likepred(const char *v, void *arg)
+{
+	struct pcre_likearg *a = arg;
+#ifdef HAVE_LIBPCRE
+	int ovector[10];
+#endif
+
+	if (*v == '\200')
+		return false;
+#ifdef HAVE_LIBPCRE
+	return (pcre_exec(a->re, a->pe, v, (int) strlen(v), 0, 0, ovector, 10) >= 0) != a->anti;
+#else
+	return (regexec(a->re, v, (size_t) 0, NULL, 0) != REG_NOMATCH) != a->anti;
+#endif
+}
+
 static str
 pcre_likeselect(BAT **bnp, BAT *b, BAT *s, const char *pat, bool caseignore, bool anti)
 {
@@ -484,6 +513,30 @@ pcre_likeselect(BAT **bnp, BAT *b, BAT *s, const char *pat, bool caseignore, boo
 			  OPERATION_FAILED ": compilation of pattern \"%s\" failed\n", pat);
 	}
 #endif
+	if (BATdictusable(b, s ? BATcount(s) : BATcount(b))) {
+		/* match each distinct string only once */
+		struct pcre_likearg arg = {
+#ifdef HAVE_LIBPCRE
+			.re = re,
+			.pe = pe,
+#else
+			.re = &re,
+#endif
+			.anti = anti,
+		};
+
+		bn = BATdictselect(b, s, pcre_likepred, &arg);
+#ifdef HAVE_LIBPCRE
+		pcre_free_study(pe);
+		pcre_free(re);
+#else
+		regfree(&re);
+#endif
+		if (bn == NULL)
+			throw(MAL, "pcre.likeselect", GDK_EXCEPTION);
+		*bnp = bn;
+		return MAL_SUCCEED;
+	}
 	bn = COLnew(0, TYPE_oid, s ? BATcount(s) : BATcount(b), TRANSIENT);
 	if (bn == NULL) {
 #ifdef HAVE_LIBPCRE
@@ -563,11 +616,33 @@ pcre_likeselect(BAT **bnp, BAT *b, BAT *s, const char *pat, bool caseignore, boo
 	throw(MAL, "pcre.likeselect", OPERATION_FAILED);
 }
 
+/* arguments of re_likepred (see pcre_likearg) */
+struct re_likearg {
+	const char *pat;
+	RE *re;
+	bool caseignore, anti, use_strcmp;
+};
+
+static bool
+re_likepred(const char *v, void *arg)
+{
+	struct re_likearg *a = arg;
+	bool m;
+
+	if (*v == '\200')
+		return false;
+	if (a->use_strcmp)
+		m = (a->caseignore ? mystrcasecmp(v, a->pat) : strcmp(v, a->pat)) == 0;
+	else
+		m = a->caseignore ? re_match_ignore(v, a->re) : re_match_no_ignore(v, a->re);
+	return m != a->anti;
+}
+
 static str
 re_likeselect(BAT **bnp, BAT *b, BAT *s, const char *pat, bool caseignore, bool anti, bool use_strcmp)
 {
 	BATiter bi = bat_iterator(b);
-	BAT *bn;
+	BAT *bn, *c = NULL;
 	BUN p, q;
 	oid o, off;
 	const char *v;
@@ -576,17 +651,51 @@ re_likeselect(BAT **bnp, BAT *b, BAT *s, const char *pat, bool caseignore, bool
 
 	assert(ATOMstorage(b->ttype) == TYPE_str);
 
-	bn = COLnew(0, TYPE_oid, s ? BATcount(s) : BATcount(b), TRANSIENT);
-	if (bn == NULL)
-		throw(MAL, "pcre.likeselect", SQLSTATE(HY001) MAL_MALLOC_FAIL);
-	off = b->hseqbase;
-
 	if (!use_strcmp) {
 		nr = re_simple(pat);
 		re = re_create(pat, nr);
 		if (!re)
 			throw(MAL, "pcre.likeselect", SQLSTATE(HY001) MAL_MALLOC_FAIL);
 	}
+	if (BATdictusable(b, s ? BATcount(s) : BATcount(b))) {
+		/* match each distinct string only once */
+		struct re_likearg arg = {
+			.pat = pat,
+			.re = re,
+			.caseignore = caseignore,
+			.anti = anti,
+			.use_strcmp = use_strcmp,
+		};
+
+		bn = BATdictselect(b, s, re_likepred, &arg);
+		re_destroy(re);
+		if (bn == NULL)
+			throw(MAL, "pcre.likeselect", GDK_EXCEPTION);
+		*bnp = bn;
+		return MAL_SUCCEED;
+	}
+	if (!anti && (use_strcmp || !re->search)) {
+		/* the pattern is a fixed string or starts with a
+		 * fixed prefix: only look at the candidates that are
+		 * in blocks that may contain a match according to
+		 * the zone map */
+		c = BATzonemapcands(b, s, use_strcmp ? pat : re->k,
+							!use_strcmp, caseignore);
+		if (c == NULL) {
+			re_destroy(re);
+			throw(MAL, "pcre.likeselect", GDK_EXCEPTION);
+		}
+		s = c;
+	}
+	bn = COLnew(0, TYPE_oid, s ? BATcount(s) : BATcount(b), TRANSIENT);
+	if (bn == NULL) {
+		re_destroy(re);
+		if (c)
+			BBPunfix(c->batCacheid);
+		throw(MAL, "pcre.likeselect", SQLSTATE(HY001) MAL_MALLOC_FAIL);
+	}
+	off = b->hseqbase;
+
 	if (s && !BATtdense(s)) {
 		const oid *candlist;
 		BUN r;
@@ -687,10 +796,14 @@ re_likeselect(BAT **bnp, BAT *b, BAT *s, const char *pat, bool caseignore, bool
 	bn->tseqbase = bn->batCount == 0 ? 0 : bn->batCount == 1 ? * (oid *) Tloc(bn, 0) : oid_nil;
 	*bnp = bn;
 	re_destroy(re);
+	if (c)
+		BBPunfix(c->batCacheid);
 	return MAL_SUCCEED;
 
   bunins_failed:
 	re_destroy(re);
+	if (c)
+		BBPunfix(c->batCacheid);
 	BBPreclaim(bn);
 	*bnp = NULL;
 	throw(MAL, "pcre.likeselect", OPERATION_FAILED);
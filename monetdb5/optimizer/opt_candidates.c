@@ -46,6 +46,8 @@ OPTcandidatesImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 				setVarCList(mb,getArg(p,0));
 			else if(getFunctionId(p) == intersectRef || getFunctionId(p) == differenceRef )
 				setVarCList(mb,getArg(p,0));
+			else if(getFunctionId(p) == bloomprobeRef )
+				setVarCList(mb,getArg(p,0));
 			else if(getFunctionId(p) == uniqueRef )
 				setVarCList(mb,getArg(p,0));
 			else if(getFunctionId(p) == firstnRef )
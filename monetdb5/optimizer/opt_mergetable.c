@@ -1092,6 +1092,36 @@ mat_aggr(MalBlkPtr mb, InstrPtr p, mat_t *mat, int m)
 	pushInstruction(mb, s);
 }
 
+/* approx_count_distinct(b) is the number of distinct values of the
+ * merge of the HyperLogLog sketches of the pieces of b */
+static void
+mat_approx_count_distinct(MalBlkPtr mb, InstrPtr p, mat_t *mat, int m, int tp)
+{
+	int k;
+	InstrPtr r, q, s;
+
+	r = newInstruction(mb, matRef, packRef);
+	getArg(r,0) = newTmpVariable(mb, newBatType(tp));
+	for(k=1; k< mat[m].mi->argc; k++) {
+		q = newInstruction(mb, hllRef, sketchRef);
+		getArg(q,0) = newTmpVariable(mb, tp);
+		q = pushArgument(mb,q,getArg(mat[m].mi,k));
+		pushInstruction(mb,q);
+		r = pushArgument(mb,r,getArg(q,0));
+	}
+	pushInstruction(mb,r);
+
+	q = newInstruction(mb, hllRef, mergeRef);
+	getArg(q,0) = newTmpVariable(mb, tp);
+	q = pushArgument(mb, q, getArg(r,0));
+	pushInstruction(mb, q);
+
+	s = newInstruction(mb, hllRef, countRef);
+	getArg(s,0) = getArg(p,0);
+	s = pushArgument(mb, s, getArg(q,0));
+	pushInstruction(mb, s);
+}
+
 static int
 chain_by_length(mat_t *mat, int g)
 {
@@ -1952,6 +1982,16 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 			continue;
 		} 
 
+		if (match == 1 && p->argc == 2 &&
+		    getModuleId(p) == aggrRef &&
+		    getFunctionId(p) == approx_count_distinctRef &&
+		    (m=is_a_mat(getArg(p,1), &ml)) >= 0 &&
+		    (n = ATOMindex("sqlblob")) > 0) {
+			mat_approx_count_distinct(mb, p, ml.v, m, n);
+			actions++;
+			continue;
+		}
+
 		if (match == 1 && bats == 1 && p->argc == 4 && isSlice(p) && ((m=is_a_mat(getArg(p,p->retc), &ml)) >= 0)) {
 			if(mat_topn(mb, p, &ml, m, -1, -1)) {
 				msg = createException(MAL,"optimizer.mergetable",SQLSTATE(HY001) MAL_MALLOC_FAIL);
@@ -2080,10 +2120,12 @@ OPTmergetableImplementation(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr
 			actions++;
 			continue;
 		}
-		/* Handle setops */
+		/* Handle setops (a Bloom filter probe is like an
+		 * intersect with a non-mat right hand side) */
 		if (match > 0 && getModuleId(p) == algebraRef &&
 		    (getFunctionId(p) == differenceRef ||
-		     getFunctionId(p) == intersectRef) &&
+		     getFunctionId(p) == intersectRef ||
+		     getFunctionId(p) == bloomprobeRef) &&
 		   (m=is_a_mat(getArg(p,1), &ml)) >= 0) { 
 		   	n=is_a_mat(getArg(p,2), &ml);
 			if(mat_setop(mb, p, &ml, m, n)) {
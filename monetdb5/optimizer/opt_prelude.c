@@ -41,6 +41,7 @@ str andRef;
 str antijoinRef;
 str appendidxRef;
 str appendRef;
+str approx_count_distinctRef;
 str arrayRef;
 str assertRef;
 str attachRef;
@@ -66,6 +67,8 @@ str binddbatRef;
 str bindidxRef;
 str bindRef;
 str blockRef;
+str bloomRef;
+str bloomprobeRef;
 str bpmRef;
 str bstreamRef;
 str calcRef;
@@ -139,6 +142,7 @@ str groupRef;
 str group_concatRef;
 str hashRef;
 str hgeRef;
+str hllRef;
 str identityRef;
 str ifthenelseRef;
 str ilikeRef;
@@ -169,6 +173,7 @@ str matRef;
 str max_no_nilRef;
 str maxRef;
 str mdbRef;
+str mergeRef;
 str mergecandRef;
 str mergepackRef;
 str min_no_nilRef;
@@ -258,6 +263,7 @@ str setVariableRef;
 str setWriteModeRef;
 str singleRef;
 str sinkRef;
+str sketchRef;
 str sliceRef;
 str sortRef;
 str sortReverseRef;
@@ -318,6 +324,7 @@ void optimizerInit(void)
 	andRef = putName("and");
 	appendidxRef = putName("append_idxbat");
 	appendRef = putName("append");
+	approx_count_distinctRef = putName("approx_count_distinct");
 	assertRef = putName("assert");
 	attachRef = putName("attach");
 	alter_seqRef = putName("alter_seq");
@@ -351,6 +358,8 @@ void optimizerInit(void)
 	betweenRef = putName("between");
 	betweensymmetricRef = putName("betweensymmetric");
 	blockRef = putName("block");
+	bloomRef = putName("bloom");
+	bloomprobeRef = putName("bloomprobe");
 	bbpRef = putName("bbp");
 	tidRef = putName("tid");
 	deltaRef = putName("delta");
@@ -411,6 +420,7 @@ void optimizerInit(void)
 	drop_indexRef = putName("drop_index");
 	drop_functionRef = putName("drop_function");
 	drop_triggerRef = putName("drop_trigger");
+	mergeRef = putName("merge");
 	mergecandRef= putName("mergecand");
 	mergepackRef= putName("mergepack");
 	intersectcandRef= putName("intersectcand");
@@ -437,6 +447,7 @@ void optimizerInit(void)
 	groupbyRef = putName("groupby");
 	hgeRef = putName("hge");
 	hashRef = putName("hash");
+	hllRef = putName("hll");
 	identityRef = putName("identity");
 	ifthenelseRef = putName("ifthenelse");
 	inplaceRef = putName("inplace");
@@ -558,6 +569,7 @@ void optimizerInit(void)
 	setVariableRef = putName("setVariable");
 	setWriteModeRef= putName("setWriteMode");
 	sinkRef = putName("sink");
+	sketchRef = putName("sketch");
 	sliceRef = putName("slice");
 	subsliceRef = putName("subslice");
 	singleRef = putName("single");
@@ -39,6 +39,7 @@ mal_export	str andRef;
 mal_export  str antijoinRef;
 mal_export  str appendidxRef;
 mal_export  str appendRef;
+mal_export  str approx_count_distinctRef;
 mal_export  str arrayRef;
 mal_export  str assertRef;
 mal_export  str attachRef;
@@ -64,6 +65,8 @@ mal_export  str binddbatRef;
 mal_export  str bindidxRef;
 mal_export  str bindRef;
 mal_export  str blockRef;
+mal_export  str bloomRef;
+mal_export  str bloomprobeRef;
 mal_export  str bpmRef;
 mal_export  str bstreamRef;
 mal_export  str calcRef;
@@ -137,6 +140,7 @@ mal_export  str groupRef;
 mal_export  str group_concatRef;
 mal_export  str hashRef;
 mal_export  str hgeRef;
+mal_export  str hllRef;
 mal_export  str identityRef;
 mal_export  str ifthenelseRef;
 mal_export  str ilikeRef;
@@ -169,6 +173,7 @@ mal_export  str matRef;
 mal_export  str max_no_nilRef;
 mal_export  str maxRef;
 mal_export  str mdbRef;
+mal_export  str mergeRef;
 mal_export  str mergecandRef;
 mal_export  str mergepackRef;
 mal_export  str min_no_nilRef;
@@ -266,6 +271,7 @@ mal_export  str setVariableRef;
 mal_export  str setWriteModeRef;
 mal_export  str singleRef;
 mal_export  str sinkRef;
+mal_export  str sketchRef;
 mal_export  str sliceRef;
 mal_export  str sortRef;
 mal_export  str sortReverseRef;
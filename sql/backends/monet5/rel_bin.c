@@ -1741,6 +1741,124 @@ releqjoin( backend *be, list *l1, list *l2, int used_hash, comp_type cmp_op, int
 	return res;
 }
 
+/* Sideways information passing: when a large table is joined with a
+ * relation that has been reduced by a selection, we create a Bloom
+ * filter of the join keys of the reduced relation and filter the scan
+ * of the table with it before its columns are projected and joined. */
+#define BLOOM_MINCOUNT 65536
+
+/* the table of a (selection on a) table scan */
+static sql_table *
+rel_scan_table(sql_rel *rel)
+{
+	while (rel && (rel->op == op_select || rel->op == op_project))
+		rel = rel->l;
+	if (rel && rel->op == op_basetable) {
+		sql_table *t = rel->l;
+		sql_column *c = rel->r;
+
+		if (!t && c)
+			t = c->t;
+		if (t && isTable(t))
+			return t;
+	}
+	return NULL;
+}
+
+/* is the number of tuples of the relation reduced by a selection */
+static int
+rel_is_reduced(sql_rel *rel)
+{
+	while (rel) {
+		switch (rel->op) {
+		case op_select:
+			if (!list_empty(rel->exps))
+				return 1;
+			rel = rel->l;
+			break;
+		case op_semi:
+		case op_anti:
+		case op_topn:
+		case op_sample:
+			return 1;
+		case op_project:
+		case op_groupby:
+			rel = rel->l;
+			break;
+		case op_join:
+			return rel_is_reduced(rel->l) || rel_is_reduced(rel->r);
+		default:
+			return 0;
+		}
+	}
+	return 0;
+}
+
+static int
+rel_bloom_probe_side(mvc *sql, sql_rel *p, sql_rel *b)
+{
+	sql_table *pt = rel_scan_table(p), *bt;
+	size_t pcnt;
+
+	if (!pt || !rel_is_reduced(b))
+		return 0;
+	pcnt = store_funcs.count_col(sql->session->tr, pt->columns.set->h->data, 1);
+	if (pcnt < BLOOM_MINCOUNT)
+		return 0;
+	/* build the filter on the smaller side */
+	if ((bt = rel_scan_table(b)) != NULL &&
+	    store_funcs.count_col(sql->session->tr, bt->columns.set->h->data, 1) >= pcnt)
+		return 0;
+	return 1;
+}
+
+static int
+bloom_type(sql_subtype *t)
+{
+	switch (ATOMstorage(t->type->localtype)) {
+	case TYPE_bte:
+	case TYPE_sht:
+	case TYPE_int:
+	case TYPE_lng:
+#ifdef HAVE_HGE
+	case TYPE_hge:
+#endif
+	case TYPE_oid:
+	case TYPE_flt:
+	case TYPE_dbl:
+	case TYPE_str:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* filter the columns of relation rel and the join key *key with a
+ * Bloom filter of the join key of the other side */
+static stmt *
+rel2bin_bloomfilter(backend *be, stmt *rel, stmt **key, stmt *build)
+{
+	mvc *sql = be->mvc;
+	list *l;
+	node *n;
+	stmt *c = stmt_bloomprobe(be, *key, build);
+
+	if (!c)
+		return rel;
+	l = sa_list(sql->sa);
+	for (n = rel->op4.lval->h; n; n = n->next) {
+		stmt *col = n->data;
+		const char *rnme = table_name(sql->sa, col);
+		const char *nme = column_name(sql->sa, col);
+		stmt *s = stmt_project(be, c, column(be, col));
+
+		s = stmt_alias(be, s, rnme, nme);
+		list_append(l, s);
+	}
+	*key = stmt_project(be, c, *key);
+	return stmt_list(be, l);
+}
+
 static stmt *
 rel2bin_join(backend *be, sql_rel *rel, list *refs)
 {
@@ -1860,6 +1978,19 @@ rel2bin_join(backend *be, sql_rel *rel, list *refs)
 			join = stmt_join(be, lje->h->data, rje->h->data, 0, cmp_equal);
 			if (need_left)
 				join->flag = cmp_left;
+		} else if (rel->op == op_join && !need_left && !used_hash && !idx &&
+			   join->type == st_join && join->flag == cmp_equal &&
+			   bloom_type(tail_type(lje->h->data))) {
+			stmt *l = lje->h->data;
+			stmt *r = rje->h->data;
+
+			if (rel_bloom_probe_side(sql, rel->l, rel->r)) {
+				left = rel2bin_bloomfilter(be, left, &l, r);
+				join = stmt_join(be, l, r, 0, cmp_equal);
+			} else if (rel_bloom_probe_side(sql, rel->r, rel->l)) {
+				right = rel2bin_bloomfilter(be, right, &r, l);
+				join = stmt_join(be, l, r, 0, cmp_equal);
+			}
 		}
 	} else {
 		stmt *l = bin_first_column(be, left);
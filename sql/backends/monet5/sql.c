@@ -992,6 +992,8 @@ mvc_bind_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 				if(bn == NULL)
 					throw(SQL, "sql.bind", SQLSTATE(HY001) MAL_MALLOC_FAIL);
 				BAThseqbase(bn, part_nr * psz);
+				/* spread the slices over the NUMA nodes */
+				BATsetnode(bn, part_nr * MT_nr_nodes() / nr_parts);
 			} else {
 				/* BAT b holds the UPD_ID bat */
 				oid l, h;
@@ -1108,6 +1110,8 @@ mvc_bind_idxbat_wrap(Client cntxt, MalBlkPtr mb, MalStkPtr stk, InstrPtr pci)
 				if(bn == NULL)
 					throw(SQL, "sql.bindidx", SQLSTATE(HY001) MAL_MALLOC_FAIL);
 				BAThseqbase(bn, part_nr * psz);
+				/* spread the slices over the NUMA nodes */
+				BATsetnode(bn, part_nr * MT_nr_nodes() / nr_parts);
 			} else {
 				/* BAT b holds the UPD_ID bat */
 				oid l, h;
@@ -1813,6 +1813,41 @@ stmt_tinter(backend *be, stmt *op1, stmt *op2)
 	return NULL;
 }
 
+stmt *
+stmt_bloomprobe(backend *be, stmt *op1, stmt *op2)
+{
+	InstrPtr q = NULL, r = NULL;
+	MalBlkPtr mb = be->mb;
+
+	if (op1->nr < 0 || op2->nr < 0)
+		return NULL;
+	r = newStmt(mb, algebraRef, bloomRef);
+	r = pushArgument(mb, r, op2->nr);
+	if (r == NULL)
+		return NULL;
+	q = newStmt(mb, algebraRef, bloomprobeRef);
+	q = pushArgument(mb, q, op1->nr);
+	q = pushArgument(mb, q, getDestVar(r));
+
+	if (q) {
+		stmt *s = stmt_create(be->mvc->sa, st_bloomprobe);
+		if (s == NULL) {
+			freeInstruction(q);
+			return NULL;
+		}
+
+		s->op1 = op1;
+		s->op2 = op2;
+		s->nrcols = op1->nrcols;
+		s->key = op1->key;
+		s->aggr = op1->aggr;
+		s->nr = getDestVar(q);
+		s->q = q;
+		return s;
+	}
+	return NULL;
+}
+
 stmt *
 stmt_join(backend *be, stmt *op1, stmt *op2, int anti, comp_type cmptype)
 {
@@ -3162,6 +3197,7 @@ tail_type(stmt *st)
 		case st_tunion:
 		case st_tdiff:
 		case st_tinter:
+		case st_bloomprobe:
 		case st_append:
 		case st_alias:
 		case st_gen_group:
@@ -3318,6 +3354,7 @@ _column_name(sql_allocator *sa, stmt *st)
 	case st_tunion:
 	case st_tdiff:
 	case st_tinter:
+	case st_bloomprobe:
 	case st_convert:
 		return column_name(sa, st->op1);
 	case st_Nop:
@@ -3388,6 +3425,7 @@ _table_name(sql_allocator *sa, stmt *st)
 	case st_tunion:
 	case st_tdiff:
 	case st_tinter:
+	case st_bloomprobe:
 	case st_aggr:
 		return table_name(sa, st->op1);
 
@@ -3443,6 +3481,7 @@ schema_name(sql_allocator *sa, stmt *st)
 	case st_tunion:
 	case st_tdiff:
 	case st_tinter:
+	case st_bloomprobe:
 	case st_convert:
 	case st_Nop:
 	case st_aggr:
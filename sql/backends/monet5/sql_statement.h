@@ -62,6 +62,7 @@ typedef enum stmt_type {
 	st_tunion,
 	st_tdiff,
 	st_tinter,
+	st_bloomprobe,
 
 	st_join,
 	st_join2,
@@ -179,6 +180,8 @@ extern stmt *stmt_genselect(backend *be, stmt *lops, stmt *rops, sql_subfunc *f,
 extern stmt *stmt_tunion(backend *be, stmt *op1, stmt *op2);
 extern stmt *stmt_tdiff(backend *be, stmt *op1, stmt *op2);
 extern stmt *stmt_tinter(backend *be, stmt *op1, stmt *op2);
+/* candidates of op1 whose values may occur in op2 (Bloom filter) */
+extern stmt *stmt_bloomprobe(backend *be, stmt *op1, stmt *op2);
 
 extern stmt *stmt_join(backend *be, stmt *op1, stmt *op2, int anti, comp_type cmptype);
 extern stmt *stmt_join2(backend *be, stmt *l, stmt *ra, stmt *rb, int cmp, int anti, int swapped);
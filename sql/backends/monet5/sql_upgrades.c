@@ -1837,6 +1837,26 @@ sql_drop_functions_dependencies_Xs_on_Ys(Client c, mvc *sql)
 	return err;		/* usually MAL_SUCCEED */
 }
 
+static str
+sql_update_approx_count_distinct(Client c, mvc *sql)
+{
+	sql_schema *sys;
+	sql_table *tab;
+	sql_column *col;
+	oid rid;
+
+	/* if there is no value "approx_count_distinct" in
+	 * sys.functions.name, the internal functions need to be
+	 * added to the catalog */
+	sys = find_sql_schema(sql->session->tr, "sys");
+	tab = find_sql_table(sys, "functions");
+	col = find_sql_column(tab, "name");
+	rid = table_funcs.column_find_row(sql->session->tr, col, "approx_count_distinct", NULL);
+	if (is_oid_nil(rid))
+		return sql_fix_system_tables(c, sql);
+	return MAL_SUCCEED;
+}
+
 void
 SQLupgrades(Client c, mvc *m)
 {
@@ -2044,4 +2064,9 @@ SQLupgrades(Client c, mvc *m)
 			freeException(err);
 		}
 	}
+
+	if ((err = sql_update_approx_count_distinct(c, m)) != NULL) {
+		fprintf(stderr, "!%s\n", err);
+		freeException(err);
+	}
 }
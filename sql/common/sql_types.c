@@ -1325,7 +1325,7 @@ sqltypeinit( sql_allocator *sa)
 	sql_type *SECINT, *MONINT, *DTE; 
 	sql_type *TME, *TMETZ, *TMESTAMP, *TMESTAMPTZ;
 	sql_type *ANY, *TABLE;
-	sql_type *GEOM, *MBR;
+	sql_type *GEOM, *MBR, *BLOB;
 	sql_func *f;
 	sql_arg *sres;
 	sql_type *LargestINT, *LargestDEC;
@@ -1399,7 +1399,7 @@ sqltypeinit( sql_allocator *sa)
 	TMESTAMP = *t++ = sql_create_type(sa, "TIMESTAMP", 7, 0, 0, EC_TIMESTAMP, "timestamp");
 	TMESTAMPTZ = *t++ = sql_create_type(sa, "TIMESTAMPTZ", 7, SCALE_FIX, 0, EC_TIMESTAMP, "timestamp");
 
-	*t++ = sql_create_type(sa, "BLOB", 0, 0, 0, EC_BLOB, "sqlblob");
+	BLOB = *t++ = sql_create_type(sa, "BLOB", 0, 0, 0, EC_BLOB, "sqlblob");
 
 	if (geomcatalogfix_get() != NULL) {
 		// the geom module is loaded 
@@ -1872,6 +1872,13 @@ sqltypeinit( sql_allocator *sa)
 	/* sys_update_schemas, sys_update_tables */
 	f = sql_create_func_(sa, "sys_update_schemas", "sql", "update_schemas", NULL, NULL, FALSE, F_PROC, SCALE_NONE);
 	f = sql_create_func_(sa, "sys_update_tables", "sql", "update_tables", NULL, NULL, FALSE, F_PROC, SCALE_NONE);
+
+	/* approximate count distinct, and the HyperLogLog sketches it
+	 * is computed with, which can be stored and merged */
+	sql_create_aggr(sa, "approx_count_distinct", "aggr", "approx_count_distinct", ANY, LNG);
+	sql_create_aggr(sa, "hll_sketch", "hll", "sketch", ANY, BLOB);
+	sql_create_aggr(sa, "hll_merge", "hll", "merge", BLOB, BLOB);
+	sql_create_func(sa, "hll_count", "hll", "count", BLOB, NULL, LNG, SCALE_FIX);
 }
 
 void
@@ -185,6 +185,28 @@ create aggregate quantile(val TIMESTAMP, q DOUBLE) returns TIMESTAMP
 	external name "aggr"."quantile";
 GRANT EXECUTE ON AGGREGATE quantile(TIMESTAMP, DOUBLE) TO PUBLIC;
 
+create aggregate approx_quantile(val TINYINT, q DOUBLE) returns TINYINT
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(TINYINT, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val SMALLINT, q DOUBLE) returns SMALLINT
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(SMALLINT, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val INTEGER, q DOUBLE) returns INTEGER
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(INTEGER, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val BIGINT, q DOUBLE) returns BIGINT
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(BIGINT, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val DECIMAL, q DOUBLE) returns DECIMAL
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(DECIMAL, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val REAL, q DOUBLE) returns REAL
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(REAL, DOUBLE) TO PUBLIC;
+create aggregate approx_quantile(val DOUBLE, q DOUBLE) returns DOUBLE
+	external name "aggr"."approx_quantile";
+GRANT EXECUTE ON AGGREGATE approx_quantile(DOUBLE, DOUBLE) TO PUBLIC;
+
 create aggregate corr(e1 TINYINT, e2 TINYINT) returns DOUBLE
 	external name "aggr"."corr";
 GRANT EXECUTE ON AGGREGATE corr(TINYINT, TINYINT) TO PUBLIC;
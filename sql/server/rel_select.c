@@ -3106,7 +3106,9 @@ rel_unop(mvc *sql, sql_rel **rel, symbol *se, int fs, exp_kind ek)
 	if (!s)
 		return NULL;
 	f = find_func(sql, s, fname, 1, F_AGGR, NULL);
-	if (f) { 
+	/* builtin aggregates without a keyword of their own (such as
+	 * approx_count_distinct) are only found in the list of aggregates */
+	if (f || sql_find_aggr(sql->sa, s, fname)) { 
 		e = rel_aggr(sql, rel, se, fs);
 		if (e)
 			return e;